@@ -0,0 +1,49 @@
+#include "./alloc_count.h"
+
+#include <stdatomic.h>
+
+static atomic_size_t calls;
+static atomic_size_t bytes;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void* __real_reallocarray(void* ptr, size_t n, size_t size);
+void* __real_aligned_alloc(size_t align, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    atomic_fetch_add_explicit(&calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytes, size, memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    atomic_fetch_add_explicit(&calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytes, n * size, memory_order_relaxed);
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    atomic_fetch_add_explicit(&calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytes, size, memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+
+void* __wrap_reallocarray(void* ptr, size_t n, size_t size) {
+    atomic_fetch_add_explicit(&calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytes, n * size, memory_order_relaxed);
+    return __real_reallocarray(ptr, n, size);
+}
+
+void* __wrap_aligned_alloc(size_t align, size_t size) {
+    atomic_fetch_add_explicit(&calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytes, size, memory_order_relaxed);
+    return __real_aligned_alloc(align, size);
+}
+
+alloc_stats alloc_stats_get() {
+    return (alloc_stats){
+        .calls = atomic_load_explicit(&calls, memory_order_relaxed),
+        .bytes = atomic_load_explicit(&bytes, memory_order_relaxed)
+    };
+}
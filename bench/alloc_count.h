@@ -0,0 +1,21 @@
+/** Allocation counting for the benchmarks. alloc_count.c defines wrappers for the allocation functions, which are
+ * only used when the benchmark is linked with
+ *     -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=reallocarray,--wrap=aligned_alloc
+ * Without those flags the counters stay at zero. */
+#ifndef _ALLOC_COUNT_H_INCLUDED_
+#define _ALLOC_COUNT_H_INCLUDED_
+
+#include <stddef.h>
+
+typedef struct alloc_stats alloc_stats;
+
+struct alloc_stats {
+    // calls to the allocation functions
+    size_t calls;
+    // bytes requested from them
+    size_t bytes;
+};
+
+alloc_stats alloc_stats_get();
+
+#endif
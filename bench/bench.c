@@ -0,0 +1,302 @@
+/** Benchmarks for the polynomial, heap and mp_int kernels. Every benchmark prints one JSON object per line, so that
+ * runs can be saved and compared with bench/compare.py:
+ *
+ *     bench/bench --seed 1 --size 2000 > before.jsonl
+ *     ... change something and rebuild ...
+ *     bench/bench --seed 1 --size 2000 > after.jsonl
+ *     python3 bench/compare.py before.jsonl after.jsonl
+ *
+ * Options: --seed S, --size N (terms per polynomial), --density D (of the sparse inputs), --limbs L (of the
+ * integers), --min-time MS (per benchmark) and --filter NAME (runs only benchmarks whose name contains NAME).
+ * Allocation counts are only reported when linked with the flags in bench/alloc_count.h. */
+#include "./gen.h"
+#include "./alloc_count.h"
+#include "../polynomial/sum.h"
+#include "../numeric/euclid.h"
+#include "../util/heap.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+
+/* Number of timed batches; the fastest one is reported. */
+#define BENCH_BATCHES 5
+
+typedef struct bench_opts bench_opts;
+
+struct bench_opts {
+    unsigned long seed;
+    size_t size;
+    double density;
+    size_t limbs;
+    double min_time_ms;
+    const char* filter;
+};
+
+/* Inputs shared by the benchmarks of one shape. */
+typedef struct bench_inputs bench_inputs;
+
+struct bench_inputs {
+    const char* shape;
+    sum p;
+    sum q;
+    // monic divisor and a dividend that it leaves a remainder of
+    sum divisor;
+    sum dividend;
+    sum gcd_p;
+    sum gcd_q;
+    term* unsorted;
+    size_t n_unsorted;
+    mp_int a;
+    mp_int b;
+    long* words;
+    size_t n_words;
+};
+
+typedef struct bench_case bench_case;
+
+struct bench_case {
+    const char* name;
+    void (*run)(bench_inputs* in);
+    // units of work per run, for ns_per_term and terms_per_sec
+    size_t (*terms)(const bench_inputs* in);
+    // polynomial benchmarks run once per shape, the others only once
+    int per_shape;
+};
+
+
+static void run_prod(bench_inputs* in) {
+    sum r = prod(&in->p, &in->q);
+    free_polynomial(&r);
+}
+
+static void run_add(bench_inputs* in) {
+    sum r = add(&in->p, &in->q);
+    free_polynomial(&r);
+}
+
+static void run_quo(bench_inputs* in) {
+    sum r = quo(&in->dividend, &in->divisor);
+    free_polynomial(&r);
+}
+
+static void run_prem(bench_inputs* in) {
+    sum r = prem(&in->dividend, &in->divisor);
+    free_polynomial(&r);
+}
+
+static void run_prim_gcd(bench_inputs* in) {
+    sum r = prim_gcd(&in->gcd_p, &in->gcd_q);
+    free_polynomial(&r);
+}
+
+/* The copy is part of the timing; it is linear, while the sort is not. */
+static void run_heap_sort(bench_inputs* in) {
+    term* t = malloc(in->n_unsorted * sizeof(term));
+    memcpy(t, in->unsorted, in->n_unsorted * sizeof(term));
+    heap_sort(in->n_unsorted, t);
+    free(t);
+}
+
+static void run_mpint_add(bench_inputs* in) {
+    mp_int r = mpint_add(&in->a, &in->b);
+    mpint_free(&r);
+}
+
+static void run_mpint_prod(bench_inputs* in) {
+    mp_int r = mpint_prod(&in->a, &in->b);
+    mpint_free(&r);
+}
+
+static void run_mpint_gcd(bench_inputs* in) {
+    mp_int r = mpint_gcd(&in->a, &in->b);
+    mpint_free(&r);
+}
+
+static volatile long sink;
+
+static void run_gcd(bench_inputs* in) {
+    long acc = 0;
+    for (size_t i = 0; i + 1 < in->n_words; i += 2) {
+        acc += gcd(in->words[i], in->words[i + 1]);
+    }
+    sink = acc;
+}
+
+static void run_list_gcd(bench_inputs* in) {
+    sink = list_gcd(in->n_words, in->words);
+}
+
+static size_t terms_pq_prod(const bench_inputs* in) {
+    return in->p.n * in->q.n;
+}
+
+static size_t terms_pq(const bench_inputs* in) {
+    return in->p.n + in->q.n;
+}
+
+static size_t terms_div(const bench_inputs* in) {
+    return in->dividend.n;
+}
+
+static size_t terms_gcd(const bench_inputs* in) {
+    return in->gcd_p.n + in->gcd_q.n;
+}
+
+static size_t terms_sorted(const bench_inputs* in) {
+    return in->n_unsorted;
+}
+
+static size_t terms_limbs(const bench_inputs* in) {
+    return mpint_size(&in->a) + mpint_size(&in->b);
+}
+
+static size_t terms_words(const bench_inputs* in) {
+    return in->n_words;
+}
+
+static const bench_case cases[] = {
+    {"prod", run_prod, terms_pq_prod, 1},
+    {"add", run_add, terms_pq, 1},
+    {"quo", run_quo, terms_div, 1},
+    {"prem", run_prem, terms_div, 1},
+    {"prim_gcd", run_prim_gcd, terms_gcd, 0},
+    {"heap_sort", run_heap_sort, terms_sorted, 0},
+    {"mpint_add", run_mpint_add, terms_limbs, 0},
+    {"mpint_prod", run_mpint_prod, terms_limbs, 0},
+    {"mpint_gcd", run_mpint_gcd, terms_limbs, 0},
+    {"gcd", run_gcd, terms_words, 0},
+    {"list_gcd", run_list_gcd, terms_words, 0},
+};
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void run_case(const bench_case* c, bench_inputs* in, const bench_opts* o) {
+    // one untimed run, then double the repetitions until a batch takes a fifth of the time budget
+    c->run(in);
+    size_t reps = 1;
+    for (;;) {
+        double t0 = now_ns();
+        for (size_t i = 0; i < reps; i++) c->run(in);
+        double t = now_ns() - t0;
+        if (t * BENCH_BATCHES >= o->min_time_ms * 1e6 || reps >= ((size_t) 1 << 30)) break;
+        reps *= 2;
+    }
+
+    double best = 0;
+    alloc_stats a0 = alloc_stats_get();
+    for (int b = 0; b < BENCH_BATCHES; b++) {
+        double t0 = now_ns();
+        for (size_t i = 0; i < reps; i++) c->run(in);
+        double t = (now_ns() - t0) / reps;
+        if (!b || t < best) best = t;
+    }
+    alloc_stats a1 = alloc_stats_get();
+    double runs = (double) reps * BENCH_BATCHES;
+    size_t terms = c->terms(in);
+
+    printf("{\"bench\":\"%s\",\"shape\":\"%s\",\"seed\":%lu,\"size\":%zu,\"terms\":%zu,\"reps\":%zu,"
+           "\"ns_per_op\":%.1f,\"ns_per_term\":%.3f,\"terms_per_sec\":%.0f,"
+           "\"allocs_per_op\":%.2f,\"alloc_bytes_per_op\":%.0f}\n",
+           c->name, c->per_shape ? in->shape : "-", o->seed, o->size, terms, reps,
+           best, terms ? best / terms : 0.0, best > 0 ? terms * 1e9 / best : 0.0,
+           (a1.calls - a0.calls) / runs, (a1.bytes - a0.bytes) / runs);
+    fflush(stdout);
+}
+
+static bench_inputs make_inputs(const char* shape, double density, const bench_opts* o) {
+    gen_state g = gen_seed(o->seed);
+    size_t n = o->size;
+    bench_inputs in = {.shape = shape};
+    in.p = gen_sum(&g, n, density, 1000, 0);
+    in.q = gen_sum(&g, n, density, 1000, 0);
+    in.divisor = gen_sum(&g, n / 2 ? n / 2 : 1, density, 1000, 1);
+    sum factor = gen_sum(&g, n / 2 ? n / 2 : 1, density, 1000, 0);
+    sum r = gen_sum(&g, n / 4 ? n / 4 : 1, density, 1000, 0);
+    sum pq = prod(&factor, &in.divisor);
+    in.dividend = add(&pq, &r);
+    free_polynomial(&factor);
+    free_polynomial(&r);
+    free_polynomial(&pq);
+    // the pseudo-remainder sequence works on long coefficients, which overflow unless the inputs are small and of
+    // low degree, so the gcd inputs are dense whatever the shape
+    sum h = gen_sum(&g, 3, 1.0, 4, 0);
+    sum u = gen_sum(&g, 4, 1.0, 4, 0);
+    sum v = gen_sum(&g, 4, 1.0, 4, 0);
+    in.gcd_p = prod(&h, &u);
+    in.gcd_q = prod(&h, &v);
+    free_polynomial(&h);
+    free_polynomial(&u);
+    free_polynomial(&v);
+
+    in.n_unsorted = n;
+    in.unsorted = gen_terms(&g, n);
+    in.a = gen_mpint(&g, o->limbs);
+    in.b = gen_mpint(&g, o->limbs);
+    in.n_words = n;
+    in.words = malloc((n ? n : 1) * sizeof(long));
+    for (size_t i = 0; i < n; i++) in.words[i] = gen_range(&g, 1, 1L << 62);
+    return in;
+}
+
+static void free_inputs(bench_inputs* in) {
+    free_polynomial(&in->p);
+    free_polynomial(&in->q);
+    free_polynomial(&in->divisor);
+    free_polynomial(&in->dividend);
+    free_polynomial(&in->gcd_p);
+    free_polynomial(&in->gcd_q);
+    free(in->unsorted);
+    mpint_free(&in->a);
+    mpint_free(&in->b);
+    free(in->words);
+}
+
+static int usage(const char* prog) {
+    fprintf(stderr, "usage: %s [--seed S] [--size N] [--density D] [--limbs L] [--min-time MS] [--filter NAME]\n",
+            prog);
+    return EXIT_FAILURE;
+}
+
+int main(int argc, char* argv[argc]) {
+    bench_opts o = {
+        .seed = 1,
+        .size = 1000,
+        .density = 0.01,
+        .limbs = 32,
+        .min_time_ms = 200,
+        .filter = NULL
+    };
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) return usage(argv[0]);
+        const char* opt = argv[i];
+        const char* val = argv[++i];
+        if (!strcmp(opt, "--seed")) o.seed = strtoul(val, NULL, 10);
+        else if (!strcmp(opt, "--size")) o.size = strtoul(val, NULL, 10);
+        else if (!strcmp(opt, "--density")) o.density = strtod(val, NULL);
+        else if (!strcmp(opt, "--limbs")) o.limbs = strtoul(val, NULL, 10);
+        else if (!strcmp(opt, "--min-time")) o.min_time_ms = strtod(val, NULL);
+        else if (!strcmp(opt, "--filter")) o.filter = val;
+        else return usage(argv[0]);
+    }
+    if (!o.size || !o.limbs) return usage(argv[0]);
+
+    bench_inputs shapes[] = {
+        make_inputs("dense", 1.0, &o),
+        make_inputs("sparse", o.density, &o)
+    };
+    size_t nshapes = sizeof(shapes) / sizeof(shapes[0]);
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        if (o.filter && !strstr(cases[c].name, o.filter)) continue;
+        for (size_t s = 0; s < (cases[c].per_shape ? nshapes : 1); s++) {
+            run_case(&cases[c], &shapes[s], &o);
+        }
+    }
+    for (size_t s = 0; s < nshapes; s++) free_inputs(&shapes[s]);
+    return 0;
+}
@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""Compares two runs of bench/bench and flags benchmarks that got slower or allocate more.
+
+usage: compare.py BEFORE.jsonl AFTER.jsonl [--threshold 0.10]
+
+Benchmarks are matched on (bench, shape, seed, size). Exits with status 1 if any benchmark regressed by more than
+the threshold, so that the comparison can gate a change.
+"""
+import json
+import sys
+
+
+def load(path):
+    runs = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line:
+                r = json.loads(line)
+                runs[(r["bench"], r["shape"], r["seed"], r["size"])] = r
+    return runs
+
+
+def main(argv):
+    threshold = 0.10
+    paths = []
+    i = 1
+    while i < len(argv):
+        if argv[i] == "--threshold" and i + 1 < len(argv):
+            threshold = float(argv[i + 1])
+            i += 2
+        else:
+            paths.append(argv[i])
+            i += 1
+    if len(paths) != 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    before, after = load(paths[0]), load(paths[1])
+    regressed = False
+    print(f"{'bench':<12} {'shape':<7} {'ns/op before':>14} {'ns/op after':>14} {'ratio':>7} "
+          f"{'allocs before':>14} {'allocs after':>13}")
+    for key in sorted(before.keys() & after.keys()):
+        b, a = before[key], after[key]
+        ratio = a["ns_per_op"] / b["ns_per_op"] if b["ns_per_op"] else 1.0
+        flags = []
+        if ratio > 1 + threshold:
+            flags.append("SLOWER")
+        elif ratio < 1 - threshold:
+            flags.append("faster")
+        if a["allocs_per_op"] > b["allocs_per_op"] * (1 + threshold):
+            flags.append("MORE ALLOCS")
+        regressed |= "SLOWER" in flags or "MORE ALLOCS" in flags
+        print(f"{key[0]:<12} {key[1]:<7} {b['ns_per_op']:>14.1f} {a['ns_per_op']:>14.1f} {ratio:>7.3f} "
+              f"{b['allocs_per_op']:>14.2f} {a['allocs_per_op']:>13.2f}  {' '.join(flags)}")
+    for key in sorted(before.keys() ^ after.keys()):
+        print(f"{key[0]:<12} {key[1]:<7} only in {'before' if key in before else 'after'}")
+    return 1 if regressed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
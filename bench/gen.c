@@ -0,0 +1,93 @@
+#include "./gen.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+
+gen_state gen_seed(uint64_t seed) {
+    return (gen_state){.s = seed};
+}
+
+/* splitmix64 */
+uint64_t gen_next(gen_state* g) {
+    uint64_t z = (g->s += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+long gen_range(gen_state* g, long lo, long hi) {
+    uint64_t span = (uint64_t) hi - (uint64_t) lo + 1;
+    return span ? lo + (long) (gen_next(g) % span) : (long) gen_next(g);
+}
+
+static void* gen_alloc(size_t n, size_t size) {
+    void* ptr = calloc(n ? n : 1, size);
+    if (!ptr) {
+        perror("Could not allocate memory in gen");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+sum gen_sum(gen_state* g, size_t n, double density, long max_coeff, int monic) {
+    if (!n) return zero_polynomial();
+    if (density <= 0 || density > 1) density = 1;
+    size_t span = (size_t) (n / density);
+    if (span < n) span = n;
+    // choose n of the span exponents by selection sampling, which yields them in order
+    sum p = {
+        .n = n,
+        .capacity = 0,
+        .terms = gen_alloc(n, sizeof(term))
+    };
+    size_t k = 0;
+    for (size_t e = span; e-- > 0 && k < n;) {
+        if (gen_next(g) % (e + 1) < n - k) {
+            long c = gen_range(g, 1, max_coeff);
+            p.terms[k].exp = (int) e;
+            p.terms[k].coeff = gen_next(g) & 1 ? -c : c;
+            k++;
+        }
+    }
+    if (monic) p.terms[0].coeff = 1;
+    return p;
+}
+
+term* gen_terms(gen_state* g, size_t n) {
+    term* t = gen_alloc(n, sizeof(term));
+    for (size_t i = 0; i < n; i++) {
+        t[i] = (term){.exp = (int) i, .coeff = gen_range(g, 1, 1000)};
+    }
+    for (size_t i = n; i > 1; i--) {
+        size_t j = gen_next(g) % i;
+        term tmp = t[i - 1];
+        t[i - 1] = t[j];
+        t[j] = tmp;
+    }
+    return t;
+}
+
+mp_int gen_mpint(gen_state* g, size_t limbs) {
+    // built from 32-bit pieces, since mp_int only converts from signed words
+    mp_int x = mpint_from_long(0);
+    mp_int base = mpint_from_long(1L << 32);
+    for (size_t i = 0; i < 2 * limbs; i++) {
+        long piece = (long) (gen_next(g) & 0xffffffff);
+        if (i == 0) piece |= 1L << 31;
+        mp_int shifted = mpint_prod(&x, &base);
+        mp_int c = mpint_from_long(piece);
+        mpint_free(&x);
+        x = mpint_add(&shifted, &c);
+        mpint_free(&shifted);
+        mpint_free(&c);
+    }
+    mpint_free(&base);
+    if (gen_next(g) & 1) {
+        mp_int zero = mpint_from_long(0);
+        mp_int neg = mpint_sub(&zero, &x);
+        mpint_free(&zero);
+        mpint_free(&x);
+        x = neg;
+    }
+    return x;
+}
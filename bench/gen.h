@@ -0,0 +1,35 @@
+/** Reproducible random inputs for the benchmarks. Every generator draws from an explicit state seeded by the
+ * caller, so that the same seed gives the same inputs on every run and every machine. */
+#ifndef _GEN_H_INCLUDED_
+#define _GEN_H_INCLUDED_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../polynomial/sum.h"
+#include "../numeric/mp_int.h"
+
+typedef struct gen_state gen_state;
+
+struct gen_state {
+    uint64_t s;
+};
+
+gen_state gen_seed(uint64_t seed);
+
+uint64_t gen_next(gen_state* g);
+
+/* Uniform in [lo, hi]. */
+long gen_range(gen_state* g, long lo, long hi);
+
+/* A polynomial with n nonzero terms whose exponents are spread over [0, n / density), so that density 1 gives a
+ * dense polynomial and smaller densities sparser ones. Coefficients are nonzero with |c| <= max_coeff. With monic
+ * set, the leading coefficient is 1. */
+sum gen_sum(gen_state* g, size_t n, double density, long max_coeff, int monic);
+
+/* n terms with distinct exponents in random order, for sorting. */
+term* gen_terms(gen_state* g, size_t n);
+
+/* A random integer of the given number of 64-bit limbs and random sign. */
+mp_int gen_mpint(gen_state* g, size_t limbs);
+
+#endif
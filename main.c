@@ -1,23 +1,53 @@
-#include "polynomial/polynomial.h"
+/** Runs a batch of polynomial problems, one spec per line, read from a file or from stdin (see polynomial/job.h
+ * for the specs and util/batch.h for the output):
+ *
+ *     ./hypergeom --threads 8 --time-limit 500 problems.txt > results.tsv
+ *
+ * Options: --threads N (0 for one per processor), --window N (specs read at a time), --time-limit MS and
+ * --memory-limit BYTES (per job, 0 for none). A summary goes to stderr. */
+#include "polynomial/job.h"
+#include "util/batch.h"
+#include "string.h"
 #include "stdio.h"
+#include "stdlib.h"
 
-int main(int argc, char* argv[argc]) {
-
-    // testing polynomials
-    int c1[] = {[0] = 1, [1] = 2};
-    int e1[] = {[0] = 0, [1] = 2};
-
-    int c2[] = {[0] = 1, [1] = 1};
-    int e2[] = {[0] = 0, [1] = 3};
+static int usage(const char* prog) {
+    fprintf(stderr, "usage: %s [--threads N] [--window N] [--time-limit MS] [--memory-limit BYTES] [FILE]\n", prog);
+    return EXIT_FAILURE;
+}
 
-    polynomial p = init_polynomial(2, c1, e1);
-    polynomial g = init_polynomial(2, c2, e2);
-
-    display(&p);
-    display(&g);
-
-    polynomial h = add(&p, &g);
-    display(&h);
+int main(int argc, char* argv[argc]) {
+    batch_opts o = {0};
+    const char* path = NULL;
+    for (int i = 1; i < argc; i++) {
+        const char* opt = argv[i];
+        if (strncmp(opt, "--", 2)) {
+            if (path) return usage(argv[0]);
+            path = opt;
+            continue;
+        }
+        if (i + 1 >= argc) return usage(argv[0]);
+        const char* val = argv[++i];
+        if (!strcmp(opt, "--threads")) o.threads = strtoul(val, NULL, 10);
+        else if (!strcmp(opt, "--window")) o.window = strtoul(val, NULL, 10);
+        else if (!strcmp(opt, "--time-limit")) o.time_limit_ms = strtod(val, NULL);
+        else if (!strcmp(opt, "--memory-limit")) o.memory_limit = strtoul(val, NULL, 10);
+        else return usage(argv[0]);
+    }
 
+    FILE* in = path ? fopen(path, "r") : stdin;
+    if (!in) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    batch_stats st;
+    int ret = batch_run(in, stdout, &sum_job, &o, &st);
+    if (path) fclose(in);
+    if (ret) {
+        perror("batch");
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "%zu jobs in %.1f ms: %zu ok, %zu errors, %zu timeouts, %zu over memory\n", st.jobs, st.wall_ms,
+            st.status[BATCH_OK], st.status[BATCH_ERROR], st.status[BATCH_TIMEOUT], st.status[BATCH_MEMORY]);
     return 0;
-}
\ No newline at end of file
+}
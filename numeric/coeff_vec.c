@@ -0,0 +1,288 @@
+#include "./coeff_vec.h"
+#include "./euclid.h"
+#include <stdint.h>
+#include <limits.h>
+#include <assert.h>
+#include <immintrin.h>
+
+typedef struct cvec_kernels cvec_kernels;
+
+struct cvec_kernels {
+    void (*scale)(size_t, long*, long);
+    void (*negate)(size_t, long*);
+    void (*divexact_odd)(size_t, long*, uint64_t, unsigned);
+    void (*addmul)(size_t, long*, long, const long*);
+    size_t (*find_indivisible)(size_t, const long*, uint64_t, unsigned, uint64_t);
+};
+
+/* ---------------- scalar ---------------- */
+
+static void scale_scalar(size_t n, long* x, long s) {
+    for (size_t i = 0; i < n; i++) {
+        x[i] = (long) ((uint64_t) x[i] * (uint64_t) s);
+    }
+}
+
+static void negate_scalar(size_t n, long* x) {
+    for (size_t i = 0; i < n; i++) {
+        x[i] = (long) (0 - (uint64_t) x[i]);
+    }
+}
+
+/* x[i] = (x[i] * inv) >> shift, with an arithmetic shift. */
+static void divexact_odd_scalar(size_t n, long* x, uint64_t inv, unsigned shift) {
+    for (size_t i = 0; i < n; i++) {
+        x[i] = ((long) ((uint64_t) x[i] * inv)) >> shift;
+    }
+}
+
+static void addmul_scalar(size_t n, long* y, long a, const long* x) {
+    for (size_t i = 0; i < n; i++) {
+        y[i] = (long) ((uint64_t) y[i] + (uint64_t) a * (uint64_t) x[i]);
+    }
+}
+
+/* The index of the first x[i] that d = odd 2^shift does not divide, or n. With inv the inverse of odd mod 2^64,
+ * d divides u exactly when u inv, rotated right by shift, is at most (2^64 - 1) / d = limit: multiplying by inv
+ * maps the multiples of odd onto 0, ..., limit and everything else above, and the rotation moves any of the low
+ * shift bits of u that are set to the top. */
+static size_t find_indivisible_scalar(size_t n, const long* x, uint64_t inv, unsigned shift, uint64_t limit) {
+    for (size_t i = 0; i < n; i++) {
+        uint64_t u = x[i] < 0 ? 0 - (uint64_t) x[i] : (uint64_t) x[i];
+        uint64_t r = u * inv;
+        r = r >> shift | r << ((64 - shift) & 63);
+        if (r > limit) return i;
+    }
+    return n;
+}
+
+/* ---------------- AVX2 ---------------- */
+
+/* AVX2 has no 64-bit low multiply, so build it from three 32x32->64 products. */
+__attribute__((target("avx2")))
+static inline __m256i mullo64_avx2(__m256i a, __m256i b) {
+    __m256i lo = _mm256_mul_epu32(a, b);
+    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)),
+                                     _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b));
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+__attribute__((target("avx2")))
+static void scale_avx2(size_t n, long* x, long s) {
+    __m256i vs = _mm256_set1_epi64x(s);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*) (x + i));
+        _mm256_storeu_si256((__m256i*) (x + i), mullo64_avx2(v, vs));
+    }
+    scale_scalar(n - i, x + i, s);
+}
+
+__attribute__((target("avx2")))
+static void negate_avx2(size_t n, long* x) {
+    __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*) (x + i));
+        _mm256_storeu_si256((__m256i*) (x + i), _mm256_sub_epi64(zero, v));
+    }
+    negate_scalar(n - i, x + i);
+}
+
+__attribute__((target("avx2")))
+static void divexact_odd_avx2(size_t n, long* x, uint64_t inv, unsigned shift) {
+    __m256i vinv = _mm256_set1_epi64x((long long) inv);
+    __m128i count = _mm_cvtsi32_si128((int) shift);
+    __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = mullo64_avx2(_mm256_loadu_si256((const __m256i*) (x + i)), vinv);
+        // arithmetic shift from a logical one: flip negative lanes, shift, flip back
+        __m256i m = _mm256_cmpgt_epi64(zero, v);
+        v = _mm256_xor_si256(_mm256_srl_epi64(_mm256_xor_si256(v, m), count), m);
+        _mm256_storeu_si256((__m256i*) (x + i), v);
+    }
+    divexact_odd_scalar(n - i, x + i, inv, shift);
+}
+
+__attribute__((target("avx2")))
+static void addmul_avx2(size_t n, long* y, long a, const long* x) {
+    __m256i va = _mm256_set1_epi64x(a);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i vx = _mm256_loadu_si256((const __m256i*) (x + i));
+        __m256i vy = _mm256_loadu_si256((const __m256i*) (y + i));
+        _mm256_storeu_si256((__m256i*) (y + i), _mm256_add_epi64(vy, mullo64_avx2(vx, va)));
+    }
+    addmul_scalar(n - i, y + i, a, x + i);
+}
+
+__attribute__((target("avx2")))
+static size_t find_indivisible_avx2(size_t n, const long* x, uint64_t inv, unsigned shift, uint64_t limit) {
+    __m256i vinv = _mm256_set1_epi64x((long long) inv);
+    __m128i right = _mm_cvtsi32_si128((int) shift);
+    // a left shift by 64 clears the lane, which is the rotation by 0 we need
+    __m128i left = _mm_cvtsi32_si128((int) (64 - shift));
+    __m256i zero = _mm256_setzero_si256();
+    // AVX2 compares signed lanes only, so compare with the sign bits flipped
+    __m256i sign = _mm256_set1_epi64x(LLONG_MIN);
+    __m256i vlimit = _mm256_xor_si256(_mm256_set1_epi64x((long long) limit), sign);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*) (x + i));
+        __m256i m = _mm256_cmpgt_epi64(zero, v);
+        v = mullo64_avx2(_mm256_sub_epi64(_mm256_xor_si256(v, m), m), vinv);
+        v = _mm256_or_si256(_mm256_srl_epi64(v, right), _mm256_sll_epi64(v, left));
+        int bad = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_xor_si256(v, sign), vlimit)));
+        if (bad) return i + __builtin_ctz(bad);
+    }
+    return i + find_indivisible_scalar(n - i, x + i, inv, shift, limit);
+}
+
+/* ---------------- AVX-512 ---------------- */
+
+__attribute__((target("avx512f,avx512dq")))
+static void scale_avx512(size_t n, long* x, long s) {
+    __m512i vs = _mm512_set1_epi64(s);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i v = _mm512_loadu_si512((const void*) (x + i));
+        _mm512_storeu_si512((void*) (x + i), _mm512_mullo_epi64(v, vs));
+    }
+    scale_scalar(n - i, x + i, s);
+}
+
+__attribute__((target("avx512f")))
+static void negate_avx512(size_t n, long* x) {
+    __m512i zero = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i v = _mm512_loadu_si512((const void*) (x + i));
+        _mm512_storeu_si512((void*) (x + i), _mm512_sub_epi64(zero, v));
+    }
+    negate_scalar(n - i, x + i);
+}
+
+__attribute__((target("avx512f,avx512dq")))
+static void divexact_odd_avx512(size_t n, long* x, uint64_t inv, unsigned shift) {
+    __m512i vinv = _mm512_set1_epi64((long long) inv);
+    __m128i count = _mm_cvtsi32_si128((int) shift);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i v = _mm512_mullo_epi64(_mm512_loadu_si512((const void*) (x + i)), vinv);
+        _mm512_storeu_si512((void*) (x + i), _mm512_sra_epi64(v, count));
+    }
+    divexact_odd_scalar(n - i, x + i, inv, shift);
+}
+
+__attribute__((target("avx512f,avx512dq")))
+static void addmul_avx512(size_t n, long* y, long a, const long* x) {
+    __m512i va = _mm512_set1_epi64(a);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i vx = _mm512_loadu_si512((const void*) (x + i));
+        __m512i vy = _mm512_loadu_si512((const void*) (y + i));
+        _mm512_storeu_si512((void*) (y + i), _mm512_add_epi64(vy, _mm512_mullo_epi64(vx, va)));
+    }
+    addmul_scalar(n - i, y + i, a, x + i);
+}
+
+__attribute__((target("avx512f,avx512dq")))
+static size_t find_indivisible_avx512(size_t n, const long* x, uint64_t inv, unsigned shift, uint64_t limit) {
+    __m512i vinv = _mm512_set1_epi64((long long) inv);
+    __m512i vshift = _mm512_set1_epi64(shift);
+    __m512i vlimit = _mm512_set1_epi64((long long) limit);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i v = _mm512_abs_epi64(_mm512_loadu_si512((const void*) (x + i)));
+        v = _mm512_rorv_epi64(_mm512_mullo_epi64(v, vinv), vshift);
+        __mmask8 bad = _mm512_cmpgt_epu64_mask(v, vlimit);
+        if (bad) return i + __builtin_ctz(bad);
+    }
+    return i + find_indivisible_scalar(n - i, x + i, inv, shift, limit);
+}
+
+/* ---------------- dispatch ---------------- */
+
+static const cvec_kernels kernels[] = {
+    [CVEC_SCALAR] = {scale_scalar, negate_scalar, divexact_odd_scalar, addmul_scalar, find_indivisible_scalar},
+    [CVEC_AVX2] = {scale_avx2, negate_avx2, divexact_odd_avx2, addmul_avx2, find_indivisible_avx2},
+    [CVEC_AVX512] = {scale_avx512, negate_avx512, divexact_odd_avx512, addmul_avx512, find_indivisible_avx512},
+};
+
+static cvec_isa active = CVEC_SCALAR;
+
+static cvec_isa best_supported(cvec_isa isa) {
+    __builtin_cpu_init();
+    if (isa >= CVEC_AVX512 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+        return CVEC_AVX512;
+    }
+    if (isa >= CVEC_AVX2 && __builtin_cpu_supports("avx2")) {
+        return CVEC_AVX2;
+    }
+    return CVEC_SCALAR;
+}
+
+__attribute__((constructor))
+static void cvec_init() {
+    active = best_supported(CVEC_AVX512);
+}
+
+cvec_isa cvec_get_isa() {
+    return active;
+}
+
+cvec_isa cvec_set_isa(cvec_isa isa) {
+    active = best_supported(isa);
+    return active;
+}
+
+void cvec_scale(size_t n, long* x, long s) {
+    kernels[active].scale(n, x, s);
+}
+
+void cvec_negate(size_t n, long* x) {
+    kernels[active].negate(n, x);
+}
+
+/* The inverse of an odd word mod 2^64, by Newton iteration; each step doubles the number of correct bits, and odd
+ * is its own inverse mod 8. */
+static uint64_t odd_inverse(uint64_t odd) {
+    uint64_t inv = odd;
+    for (int k = 0; k < 5; k++) {
+        inv *= 2 - odd * inv;
+    }
+    return inv;
+}
+
+static uint64_t magnitude(long a) {
+    return a < 0 ? 0 - (uint64_t) a : (uint64_t) a;
+}
+
+void cvec_divexact(size_t n, long* x, long d) {
+    uint64_t ud = magnitude(d);
+    unsigned shift = __builtin_ctzl(ud);
+    kernels[active].divexact_odd(n, x, odd_inverse(ud >> shift), shift);
+    if (d < 0) {
+        kernels[active].negate(n, x);
+    }
+}
+
+void cvec_addmul(size_t n, long* y, long a, const long* x) {
+    kernels[active].addmul(n, y, a, x);
+}
+
+long cvec_content(size_t n, const long* x) {
+    size_t i = 0;
+    while (i < n && !x[i]) i++;
+    uint64_t g = i < n ? magnitude(x[i++]) : 0;
+    while (i < n && g != 1) {
+        // the running gcd usually divides most of what follows, so the kernel scans for the next entry that
+        // lowers it, and only that entry costs a gcd
+        unsigned shift = __builtin_ctzl(g);
+        i += kernels[active].find_indivisible(n - i, x + i, odd_inverse(g >> shift), shift, UINT64_MAX / g);
+        if (i < n) g = ugcd(g, magnitude(x[i++]));
+    }
+    assert(g <= LONG_MAX);
+    return (long) g;
+}
@@ -0,0 +1,42 @@
+/** Kernels for whole-array operations on coefficient vectors. Each kernel has a scalar version and, where the
+ * instruction set allows, AVX2 and AVX-512 versions. The fastest version supported by the running CPU is selected
+ * once at load time. Arithmetic wraps modulo 2^64 exactly like the scalar code. */
+#ifndef _COEFF_VEC_H_INCLUDED_
+#define _COEFF_VEC_H_INCLUDED_
+
+#include <stddef.h>
+
+typedef enum cvec_isa cvec_isa;
+
+enum cvec_isa {
+    CVEC_SCALAR,
+    CVEC_AVX2,
+    CVEC_AVX512,
+};
+
+/* The instruction set the kernels currently dispatch to. */
+cvec_isa cvec_get_isa();
+
+/* Forces the kernels onto the given instruction set, or the best supported one below it. Returns the set chosen.
+ * Meant for testing and benchmarking the fallbacks. */
+cvec_isa cvec_set_isa(cvec_isa isa);
+
+/* x[i] *= s */
+void cvec_scale(size_t n, long* x, long s);
+
+/* x[i] = -x[i] */
+void cvec_negate(size_t n, long* x);
+
+/* x[i] /= d, where d is nonzero and divides every x[i]. Uses multiplication by the inverse of the odd part of d,
+ * so no division instructions are issued. The result is unspecified if d does not divide some x[i]. */
+void cvec_divexact(size_t n, long* x, long d);
+
+/* y[i] += a * x[i] */
+void cvec_addmul(size_t n, long* y, long a, const long* x);
+
+/* The nonnegative gcd of x[0], ..., x[n-1]. Stops early once the gcd reaches 1. Returns 0 if all x[i] are 0. The
+ * gcd must fit in a long, so the x[i] may not all be 0 or LONG_MIN. Entries the running gcd divides are skipped
+ * by a vector divisibility test, so a gcd is taken only where the content drops. */
+long cvec_content(size_t n, const long* x);
+
+#endif
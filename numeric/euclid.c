@@ -1,32 +1,58 @@
 #include "./euclid.h"
 #include <assert.h>
+#include <stdint.h>
+#include <limits.h>
 #include "stdio.h"
 
+/* Binary (Stein) gcd. Shifts out common factors of two with ctz and replaces the division of Euclid's algorithm
+ * by a subtraction, with the min/max written so that the compiler emits conditional moves. */
+uint64_t ugcd(uint64_t u, uint64_t v) {
+    if (!u) return v;
+    if (!v) return u;
+    int shift = __builtin_ctzl(u | v);
+    u >>= __builtin_ctzl(u);
+    do {
+        v >>= __builtin_ctzl(v);
+        uint64_t m = u < v ? u : v;
+        v = (u < v ? v : u) - m;
+        u = m;
+    } while (v);
+    return u << shift;
+}
+
+static uint64_t magnitude(long a) {
+    return a < 0 ? 0 - (uint64_t) a : (uint64_t) a;
+}
+
 long gcd(long a, long b) {
-    if (a < b) {
-        return gcd(b, a);
-    }
-    long temp = 0;
-    while (b != 0) {
-        temp = b;
-        b = a % b;
-        a = temp;
-    }
-    return a;
+    uint64_t g = ugcd(magnitude(a), magnitude(b));
+    assert(g <= LONG_MAX);
+    return (long) g;
 }
 
 long list_gcd(size_t num, long nums[]) {
-    assert(num > 1);
-    long curr_gcd = nums[0];
-    for (int i = 1; i < num; i++) {
-        curr_gcd = gcd(curr_gcd, nums[i]);
+    assert(num > 0);
+    uint64_t curr_gcd = 0;
+    for (size_t i = 0; i < num && curr_gcd != 1; i++) {
+        uint64_t x = magnitude(nums[i]);
+        // once the running gcd is small, one division brings a large entry down to its size
+        // and saves the binary gcd most of its iterations
+        if (curr_gcd && x > curr_gcd) {
+            x %= curr_gcd;
+        }
+        curr_gcd = ugcd(curr_gcd, x);
     }
-    return curr_gcd;
+    assert(curr_gcd <= LONG_MAX);
+    return (long) curr_gcd;
 }
 
 extended_euclid_ret extended_euclid(long a, long b) {
     if (a < b) {
-        return extended_euclid(b, a);
+        extended_euclid_ret r = extended_euclid(b, a);
+        long t = r.a;
+        r.a = r.b;
+        r.b = t;
+        return r;
     }
     long c = 0, d = 1;
     long s = 1, t = 0;
@@ -58,4 +84,4 @@ extended_euclid_ret extended_euclid(long a, long b) {
         .b = t
     };
     return ret;
-}
\ No newline at end of file
+}
@@ -2,9 +2,16 @@
 #define _EUCLID_H_INCLUDED_
 
 #include <stddef.h>
+#include <stdint.h>
 
+/* The gcd of two words, with ugcd(0, 0) = 0. */
+uint64_t ugcd(uint64_t a, uint64_t b);
+
+/* The nonnegative gcd of a and b, with gcd(0, 0) = 0. The magnitudes are taken in unsigned arithmetic, so
+ * LONG_MIN is a valid argument, but the gcd must fit in a long: a and b may not both be 0 or LONG_MIN. */
 long gcd(long a, long b);
 
+/* The nonnegative gcd of nums[0], ..., nums[num-1], under the same condition as gcd. */
 long list_gcd(size_t num, long nums[]);
 
 typedef struct extended_euclid_ret extended_euclid_ret;
@@ -0,0 +1,293 @@
+#include "./factorial.h"
+#include "./modular.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "../util/instrument.h"
+
+/* Below this, n! is a product tree over 2..n rather than a prime swing. */
+#define FACT_SWING_MIN 128
+
+/* Binomials with k up to this are a rising factorial divided by k!, which needs no sieve up to n. */
+#define FACT_BINOM_DIRECT 32
+
+typedef unsigned __int128 uint128_t;
+
+static mp_int table[FACT_TABLE_MAX];
+// entries below filled are set and never change until fact_table_clear
+static atomic_size_t filled;
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void* fact_alloc(size_t n, size_t size) {
+    void* ptr = malloc((n ? n : 1) * size);
+    if (!ptr) {
+        perror("Could not allocate memory in factorial");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static mp_int from_word(uint64_t w) {
+    mp_int v = mpint_view(false, &w, w ? 1 : 0);
+    mp_int out = mpint_copy(&v);
+    mpint_free(&v);
+    return out;
+}
+
+const mp_int* fact_table_get(size_t n) {
+    // the entries are handed out by address, so there is nothing to fall back to past the end
+    assert(n < FACT_TABLE_MAX);
+    if (n < atomic_load_explicit(&filled, memory_order_acquire)) {
+        return &table[n];
+    }
+    pthread_mutex_lock(&table_lock);
+    size_t f = atomic_load_explicit(&filled, memory_order_relaxed);
+    if (!f) {
+        table[0] = mpint_from_long(1);
+        f = 1;
+    }
+    for (; f <= n; f++) {
+        mp_int m = from_word(f);
+        table[f] = mpint_prod(&table[f - 1], &m);
+        mpint_free(&m);
+    }
+    // the entries are complete before the count that makes them visible
+    atomic_store_explicit(&filled, f, memory_order_release);
+    pthread_mutex_unlock(&table_lock);
+    return &table[n];
+}
+
+void fact_table_clear(void) {
+    size_t f = atomic_load(&filled);
+    for (size_t i = 0; i < f; i++) mpint_free(&table[i]);
+    atomic_store(&filled, 0);
+}
+
+mp_int mpint_prod_words(const uint64_t* x, size_t n) {
+    // pack runs of words whose product fits in a word, then multiply the packed words pairwise in rounds
+    uint64_t* packed = fact_alloc(n, sizeof(uint64_t));
+    size_t np = 0;
+    uint64_t acc = 1;
+    for (size_t i = 0; i < n; i++) {
+        if (!x[i]) {
+            free(packed);
+            return mpint_from_long(0);
+        }
+        uint128_t t = (uint128_t) acc * x[i];
+        if (t >> 64) {
+            packed[np++] = acc;
+            acc = x[i];
+        } else {
+            acc = (uint64_t) t;
+        }
+    }
+    packed[np++] = acc;
+    mp_int* v = fact_alloc(np, sizeof(mp_int));
+    for (size_t i = 0; i < np; i++) v[i] = from_word(packed[i]);
+    free(packed);
+    while (np > 1) {
+        size_t half = 0;
+        for (size_t i = 0; i + 1 < np; i += 2) {
+            mp_int t = mpint_prod(&v[i], &v[i + 1]);
+            mpint_free(&v[i]);
+            mpint_free(&v[i + 1]);
+            v[half++] = t;
+        }
+        if (np % 2) v[half++] = v[np - 1];
+        np = half;
+    }
+    mp_int out = v[0];
+    free(v);
+    return out;
+}
+
+/* composite[i] is set for the composite i <= n. */
+static bool* sieve(size_t n) {
+    bool* composite = fact_alloc(n + 1, sizeof(bool));
+    memset(composite, 0, n + 1);
+    for (size_t i = 2; i * i <= n; i++) {
+        if (composite[i]) continue;
+        for (size_t j = i * i; j <= n; j += i) composite[j] = true;
+    }
+    return composite;
+}
+
+/* 2 3 ... n. */
+static mp_int range_fact(size_t n) {
+    uint64_t* x = fact_alloc(n, sizeof(uint64_t));
+    size_t m = 0;
+    for (size_t i = 2; i <= n; i++) x[m++] = i;
+    mp_int out = mpint_prod_words(x, m);
+    free(x);
+    return out;
+}
+
+/* n! / (n/2)!^2: the exponent of a prime p is the number of odd floor(n / p^i), so p^e <= n fits in a word. */
+static mp_int swing(size_t n, const bool* composite, uint64_t* factors) {
+    size_t m = 0;
+    for (size_t p = 2; p <= n; p++) {
+        if (composite[p]) continue;
+        uint64_t pe = 1;
+        for (size_t q = n / p; q; q /= p) {
+            if (q & 1) pe *= p;
+        }
+        if (pe > 1) factors[m++] = pe;
+    }
+    return mpint_prod_words(factors, m);
+}
+
+static mp_int swing_fact(size_t n, const bool* composite, uint64_t* factors) {
+    if (n < atomic_load_explicit(&filled, memory_order_acquire)) {
+        return mpint_copy(&table[n]);
+    }
+    if (n < FACT_SWING_MIN) {
+        return range_fact(n);
+    }
+    mp_int h = swing_fact(n / 2, composite, factors);
+    mp_int sq = mpint_prod(&h, &h);
+    mp_int s = swing(n, composite, factors);
+    mp_int out = mpint_prod(&sq, &s);
+    mpint_free(&h);
+    mpint_free(&sq);
+    mpint_free(&s);
+    return out;
+}
+
+mp_int mpint_fact(size_t n) {
+    if (n < FACT_TABLE_MAX) {
+        return mpint_copy(fact_table_get(n));
+    }
+    bool* composite = sieve(n);
+    uint64_t* factors = fact_alloc(n, sizeof(uint64_t));
+    mp_int out = swing_fact(n, composite, factors);
+    free(composite);
+    free(factors);
+    return out;
+}
+
+mp_int mpint_binom(size_t n, size_t k) {
+    if (k > n) {
+        return mpint_from_long(0);
+    }
+    if (k > n - k) {
+        k = n - k;
+    }
+    if (k <= FACT_BINOM_DIRECT) {
+        mp_int num = mpint_rising((long) (n - k + 1), k);
+        mp_int out = mpint_div(&num, fact_table_get(k));
+        mpint_free(&num);
+        return out;
+    }
+    // Legendre: the exponent of p is the sum over i of floor(n / p^i) - floor(k / p^i) - floor((n - k) / p^i),
+    // which is the number of carries when adding k and n - k in base p, so again p^e <= n
+    bool* composite = sieve(n);
+    uint64_t* factors = fact_alloc(n, sizeof(uint64_t));
+    size_t m = 0;
+    for (size_t p = 2; p <= n; p++) {
+        if (composite[p]) continue;
+        uint64_t pe = 1;
+        for (size_t q = p; q <= n; q *= p) {
+            if (n / q - k / q - (n - k) / q) pe *= p;
+            if (q > n / p) break;
+        }
+        if (pe > 1) factors[m++] = pe;
+    }
+    mp_int out = mpint_prod_words(factors, m);
+    free(composite);
+    free(factors);
+    return out;
+}
+
+mp_int mpint_rising(long a, size_t k) {
+    if (!k) {
+        return mpint_from_long(1);
+    }
+    long last = a + (long) (k - 1);
+    if (a <= 0 && last >= 0) {
+        return mpint_from_long(0);
+    }
+    uint64_t* x = fact_alloc(k, sizeof(uint64_t));
+    for (size_t i = 0; i < k; i++) {
+        long v = a + (long) i;
+        x[i] = v < 0 ? 0 - (uint64_t) v : (uint64_t) v;
+    }
+    mp_int out = mpint_prod_words(x, k);
+    free(x);
+    // a product of k negative numbers
+    if (last < 0 && k % 2) {
+        mp_int zero = mpint_from_long(0);
+        mp_int neg = mpint_sub(&zero, &out);
+        mpint_free(&zero);
+        mpint_free(&out);
+        out = neg;
+    }
+    return out;
+}
+
+uint64_t fact_mod(uint64_t n, uint64_t p) {
+    if (n >= p) return 0;
+    mod_barrett b = mod_barrett_init(p);
+    uint64_t r = 1 % p;
+    for (uint64_t i = 2; i <= n; i++) r = mod_barrett_mul(&b, r, i);
+    return r;
+}
+
+uint64_t rising_mod(long a, uint64_t k, uint64_t p) {
+    // k consecutive numbers with k >= p include a multiple of p
+    if (k >= p) return 0;
+    mod_barrett b = mod_barrett_init(p);
+    uint64_t x = mod_reduce(a, p);
+    uint64_t r = 1 % p;
+    for (uint64_t i = 0; i < k; i++) {
+        r = mod_barrett_mul(&b, r, x);
+        x = x + 1 == p ? 0 : x + 1;
+    }
+    return r;
+}
+
+uint64_t binom_mod(uint64_t n, uint64_t k, uint64_t p) {
+    if (k > n) return 0;
+    mod_barrett b = mod_barrett_init(p);
+    uint64_t r = 1 % p;
+    // Lucas: the product of the binomials of the base p digits
+    while (k) {
+        uint64_t ni = n % p, ki = k % p;
+        if (ki > ni) return 0;
+        if (ki > ni - ki) ki = ni - ki;
+        uint64_t num = 1, den = 1;
+        for (uint64_t i = 1; i <= ki; i++) {
+            num = mod_barrett_mul(&b, num, ni - ki + i);
+            den = mod_barrett_mul(&b, den, i);
+        }
+        r = mod_barrett_mul(&b, r, mod_barrett_mul(&b, num, mod_inv(den, p)));
+        n /= p;
+        k /= p;
+    }
+    return r;
+}
+
+mod_fact_table mod_fact_table_init(size_t n, uint64_t p) {
+    mod_fact_table t = {
+        .p = p,
+        .n = n,
+        .fact = fact_alloc(n + 1, sizeof(uint64_t)),
+        .inv_fact = fact_alloc(n + 1, sizeof(uint64_t))
+    };
+    mod_barrett b = mod_barrett_init(p);
+    t.fact[0] = 1 % p;
+    for (size_t i = 1; i <= n; i++) t.fact[i] = mod_barrett_mul(&b, t.fact[i - 1], i % p);
+    // one inversion, then 1/(i-1)! = i / i!
+    t.inv_fact[n] = mod_inv(t.fact[n], p);
+    for (size_t i = n; i > 0; i--) t.inv_fact[i - 1] = mod_barrett_mul(&b, t.inv_fact[i], i % p);
+    return t;
+}
+
+void mod_fact_table_free(mod_fact_table* t) {
+    free(t->fact);
+    free(t->inv_fact);
+    t->fact = t->inv_fact = NULL;
+}
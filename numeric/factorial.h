@@ -0,0 +1,68 @@
+/** Factorials, binomial coefficients and rising factorials, exactly and modulo word-sized primes.
+ *
+ * Small factorials come from a table shared by every thread, extended one entry at a time as larger ones are asked
+ * for, so a run of lookups costs one multiplication by a word per new entry. Readers never take a lock: entries are
+ * written before the count that covers them is published, and are never moved or changed afterwards.
+ *
+ * Beyond the table, n! is computed by the prime swing method, n! = (n/2)!^2 swing(n), where swing(n) is a product
+ * of powers of the primes up to n, and binomials from their factorization by Legendre's formula. Every product of
+ * many numbers is taken by a product tree, whose multiplications have balanced operands. */
+#ifndef _FACTORIAL_H_INCLUDED_
+#define _FACTORIAL_H_INCLUDED_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "./mp_int.h"
+
+/* Entries in the shared table; 4095! has about 13000 digits, and the whole table takes some 12 MB. */
+#define FACT_TABLE_MAX 4096
+
+/* n! from the shared table, extending it if needed. Requires n < FACT_TABLE_MAX. The result is owned by the table
+ * and must not be freed. Safe to call from several threads at once. */
+const mp_int* fact_table_get(size_t n);
+
+/* Frees the shared table, which is rebuilt on the next lookup. No other thread may be using it. */
+void fact_table_clear(void);
+
+/* n!, from the table when it is small enough and by the prime swing method otherwise. */
+mp_int mpint_fact(size_t n);
+
+/* The binomial coefficient n choose k; 0 if k > n. Unless k or n - k is small, this sieves the primes up to n. */
+mp_int mpint_binom(size_t n, size_t k);
+
+/* The rising factorial (Pochhammer symbol) a (a + 1) ... (a + k - 1), 1 if k = 0. a may be negative, but
+ * a + k - 1 must fit in a long. */
+mp_int mpint_rising(long a, size_t k);
+
+/* The product of the n words x, by a product tree. */
+mp_int mpint_prod_words(const uint64_t* x, size_t n);
+
+/* The same modulo a prime p < 2^63. fact_mod and rising_mod take O(n) and O(k) multiplications; binom_mod takes
+ * O(p) at most, by Lucas' theorem when n >= p. */
+uint64_t fact_mod(uint64_t n, uint64_t p);
+uint64_t binom_mod(uint64_t n, uint64_t k, uint64_t p);
+uint64_t rising_mod(long a, uint64_t k, uint64_t p);
+
+/* Factorials and their inverses up to n modulo a prime p > n, for O(1) binomials in modular pipelines. A table is
+ * never changed after it is built, so any number of threads may read it. */
+typedef struct mod_fact_table mod_fact_table;
+
+struct mod_fact_table {
+    uint64_t p;
+    size_t n;
+    uint64_t* fact;
+    uint64_t* inv_fact;
+};
+
+mod_fact_table mod_fact_table_init(size_t n, uint64_t p);
+
+void mod_fact_table_free(mod_fact_table* t);
+
+/* n choose k mod p for n <= t->n; 0 if k > n. */
+static inline uint64_t mod_fact_table_binom(const mod_fact_table* t, size_t n, size_t k) {
+    if (k > n) return 0;
+    unsigned __int128 x = (unsigned __int128) t->fact[n] * t->inv_fact[k] % t->p;
+    return (uint64_t) (x * t->inv_fact[n - k] % t->p);
+}
+
+#endif
@@ -0,0 +1,275 @@
+#include "./limb.h"
+#include <string.h>
+#include <immintrin.h>
+
+typedef unsigned __int128 uint128_t;
+
+typedef struct limb_kernels limb_kernels;
+
+struct limb_kernels {
+    uint64_t (*add_n)(uint64_t*, const uint64_t*, const uint64_t*, size_t);
+    uint64_t (*sub_n)(uint64_t*, const uint64_t*, const uint64_t*, size_t);
+    uint64_t (*mul_1)(uint64_t*, const uint64_t*, size_t, uint64_t);
+    uint64_t (*addmul_1)(uint64_t*, const uint64_t*, size_t, uint64_t);
+    uint64_t (*submul_1)(uint64_t*, const uint64_t*, size_t, uint64_t);
+};
+
+/* ---------------- scalar ---------------- */
+
+static uint64_t add_n_scalar(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint128_t s = (uint128_t) a[i] + b[i] + carry;
+        r[i] = (uint64_t) s;
+        carry = (uint64_t) (s >> 64);
+    }
+    return carry;
+}
+
+static uint64_t sub_n_scalar(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint128_t d = (uint128_t) a[i] - b[i] - borrow;
+        r[i] = (uint64_t) d;
+        borrow = (uint64_t) (d >> 64) & 1;
+    }
+    return borrow;
+}
+
+static uint64_t mul_1_scalar(uint64_t* r, const uint64_t* a, size_t n, uint64_t m) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint128_t p = (uint128_t) a[i] * m + carry;
+        r[i] = (uint64_t) p;
+        carry = (uint64_t) (p >> 64);
+    }
+    return carry;
+}
+
+static uint64_t addmul_1_scalar(uint64_t* r, const uint64_t* a, size_t n, uint64_t m) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        // a[i] m + r[i] + carry < 2^128
+        uint128_t p = (uint128_t) a[i] * m + r[i] + carry;
+        r[i] = (uint64_t) p;
+        carry = (uint64_t) (p >> 64);
+    }
+    return carry;
+}
+
+static uint64_t submul_1_scalar(uint64_t* r, const uint64_t* a, size_t n, uint64_t m) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint128_t p = (uint128_t) a[i] * m + borrow;
+        uint64_t lo = (uint64_t) p;
+        borrow = (uint64_t) (p >> 64) + (r[i] < lo);
+        r[i] -= lo;
+    }
+    return borrow;
+}
+
+/* ---------------- ADX ---------------- */
+
+__attribute__((target("adx,bmi2")))
+static uint64_t add_n_adx(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    unsigned char c = 0;
+    size_t i = 0;
+    unsigned long long s0, s1, s2, s3;
+    for (; i + 4 <= n; i += 4) {
+        c = _addcarryx_u64(c, a[i], b[i], &s0);
+        c = _addcarryx_u64(c, a[i + 1], b[i + 1], &s1);
+        c = _addcarryx_u64(c, a[i + 2], b[i + 2], &s2);
+        c = _addcarryx_u64(c, a[i + 3], b[i + 3], &s3);
+        r[i] = s0;
+        r[i + 1] = s1;
+        r[i + 2] = s2;
+        r[i + 3] = s3;
+    }
+    for (; i < n; i++) {
+        c = _addcarryx_u64(c, a[i], b[i], &s0);
+        r[i] = s0;
+    }
+    return c;
+}
+
+__attribute__((target("adx,bmi2")))
+static uint64_t sub_n_adx(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    unsigned char c = 0;
+    size_t i = 0;
+    unsigned long long d0, d1, d2, d3;
+    for (; i + 4 <= n; i += 4) {
+        c = _subborrow_u64(c, a[i], b[i], &d0);
+        c = _subborrow_u64(c, a[i + 1], b[i + 1], &d1);
+        c = _subborrow_u64(c, a[i + 2], b[i + 2], &d2);
+        c = _subborrow_u64(c, a[i + 3], b[i + 3], &d3);
+        r[i] = d0;
+        r[i + 1] = d1;
+        r[i + 2] = d2;
+        r[i + 3] = d3;
+    }
+    for (; i < n; i++) {
+        c = _subborrow_u64(c, a[i], b[i], &d0);
+        r[i] = d0;
+    }
+    return c;
+}
+
+/* The multiplications are written in assembly because compilers keep only one carry flag live across a loop and
+ * spill the other. The index runs from -n up to 0 so that the loop test, jrcxz, leaves both flags alone. */
+
+__attribute__((target("adx,bmi2")))
+static uint64_t mul_1_adx(uint64_t* r, const uint64_t* a, size_t n, uint64_t m) {
+    if (!n) return 0;
+    uint64_t hi_prev = 0, lo, hi;
+    long i = -(long) n;
+    __asm__(
+        "xor %k[lo], %k[lo]\n\t"
+        "1:\n\t"
+        "mulx (%[a],%[i],8), %[lo], %[hi]\n\t"
+        "adcx %[hp], %[lo]\n\t"
+        "mov %[lo], (%[r],%[i],8)\n\t"
+        "mov %[hi], %[hp]\n\t"
+        "lea 1(%[i]), %[i]\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n"
+        "2:\n\t"
+        "mov $0, %k[lo]\n\t"
+        "adcx %[lo], %[hp]\n\t"
+        : [i] "+c" (i), [hp] "+r" (hi_prev), [lo] "=&r" (lo), [hi] "=&r" (hi)
+        : [a] "r" (a + n), [r] "r" (r + n), "d" (m)
+        : "cc", "memory");
+    return hi_prev;
+}
+
+/* The high limb of each product goes into the next position on the CF chain (adcx) while the sum with r runs on
+ * the OF chain (adox), so neither waits on the other's flag. */
+__attribute__((target("adx,bmi2")))
+static uint64_t addmul_1_adx(uint64_t* r, const uint64_t* a, size_t n, uint64_t m) {
+    if (!n) return 0;
+    uint64_t hi_prev = 0, lo, hi;
+    long i = -(long) n;
+    __asm__(
+        "xor %k[lo], %k[lo]\n\t"
+        "1:\n\t"
+        "mulx (%[a],%[i],8), %[lo], %[hi]\n\t"
+        "adcx %[hp], %[lo]\n\t"
+        "adox (%[r],%[i],8), %[lo]\n\t"
+        "mov %[lo], (%[r],%[i],8)\n\t"
+        "mov %[hi], %[hp]\n\t"
+        "lea 1(%[i]), %[i]\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n"
+        "2:\n\t"
+        "mov $0, %k[lo]\n\t"
+        "adcx %[lo], %[hp]\n\t"
+        "adox %[lo], %[hp]\n\t"
+        : [i] "+c" (i), [hp] "+r" (hi_prev), [lo] "=&r" (lo), [hi] "=&r" (hi)
+        : [a] "r" (a + n), [r] "r" (r + n), "d" (m)
+        : "cc", "memory");
+    // r + a m fits in n + 1 limbs, so the last additions do not overflow
+    return hi_prev;
+}
+
+/* The products are summed on the OF chain, and r - x is formed as r + ~x + 1 on the CF chain, which starts set;
+ * a clear CF at the end is a borrow. */
+__attribute__((target("adx,bmi2")))
+static uint64_t submul_1_adx(uint64_t* r, const uint64_t* a, size_t n, uint64_t m) {
+    if (!n) return 0;
+    uint64_t hi_prev = 0, lo, hi;
+    long i = -(long) n;
+    __asm__(
+        "xor %k[lo], %k[lo]\n\t"
+        "stc\n"
+        "1:\n\t"
+        "mulx (%[a],%[i],8), %[lo], %[hi]\n\t"
+        "adox %[hp], %[lo]\n\t"
+        "not %[lo]\n\t"
+        "adcx (%[r],%[i],8), %[lo]\n\t"
+        "mov %[lo], (%[r],%[i],8)\n\t"
+        "mov %[hi], %[hp]\n\t"
+        "lea 1(%[i]), %[i]\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n"
+        "2:\n\t"
+        "mov $0, %k[lo]\n\t"
+        "adox %[lo], %[hp]\n\t"
+        "cmc\n\t"
+        "adc $0, %[hp]\n\t"
+        : [i] "+c" (i), [hp] "+r" (hi_prev), [lo] "=&r" (lo), [hi] "=&r" (hi)
+        : [a] "r" (a + n), [r] "r" (r + n), "d" (m)
+        : "cc", "memory");
+    return hi_prev;
+}
+
+/* ---------------- dispatch ---------------- */
+
+static const limb_kernels kernels[] = {
+    [LIMB_SCALAR] = {add_n_scalar, sub_n_scalar, mul_1_scalar, addmul_1_scalar, submul_1_scalar},
+    [LIMB_ADX] = {add_n_adx, sub_n_adx, mul_1_adx, addmul_1_adx, submul_1_adx},
+};
+
+static limb_isa active = LIMB_SCALAR;
+
+static limb_isa best_supported(limb_isa isa) {
+    __builtin_cpu_init();
+    if (isa >= LIMB_ADX && __builtin_cpu_supports("adx") && __builtin_cpu_supports("bmi2")) {
+        return LIMB_ADX;
+    }
+    return LIMB_SCALAR;
+}
+
+__attribute__((constructor))
+static void limb_init() {
+    active = best_supported(LIMB_ADX);
+}
+
+limb_isa limb_get_isa() {
+    return active;
+}
+
+limb_isa limb_set_isa(limb_isa isa) {
+    active = best_supported(isa);
+    return active;
+}
+
+uint64_t limb_add_n(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    return kernels[active].add_n(r, a, b, n);
+}
+
+uint64_t limb_sub_n(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    return kernels[active].sub_n(r, a, b, n);
+}
+
+uint64_t limb_add_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t c) {
+    size_t i = 0;
+    // the carry usually dies within a limb or two; the rest is a copy
+    for (; i < n && c; i++) {
+        r[i] = a[i] + c;
+        c = r[i] < c;
+    }
+    if (r != a && i < n) memmove(r + i, a + i, (n - i) * sizeof(uint64_t));
+    return c;
+}
+
+uint64_t limb_sub_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t c) {
+    size_t i = 0;
+    for (; i < n && c; i++) {
+        uint64_t ai = a[i];
+        r[i] = ai - c;
+        c = ai < c;
+    }
+    if (r != a && i < n) memmove(r + i, a + i, (n - i) * sizeof(uint64_t));
+    return c;
+}
+
+uint64_t limb_mul_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t m) {
+    return kernels[active].mul_1(r, a, n, m);
+}
+
+uint64_t limb_addmul_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t m) {
+    return kernels[active].addmul_1(r, a, n, m);
+}
+
+uint64_t limb_submul_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t m) {
+    return kernels[active].submul_1(r, a, n, m);
+}
@@ -0,0 +1,45 @@
+/** Kernels on vectors of 64-bit limbs, least significant first, in the style of GMP's mpn layer. Every mp_int
+ * operation runs its inner loops through them. Each kernel has a portable version on unsigned __int128 and a
+ * version on the ADX and BMI2 instructions (adc with explicit carry flags and the flagless mulx), which keeps the
+ * carry chains in flags instead of recomputing them. The version is chosen once at load time from the running CPU.
+ * Outputs may alias inputs when they start at the same limb. */
+#ifndef _LIMB_H_INCLUDED_
+#define _LIMB_H_INCLUDED_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum limb_isa limb_isa;
+
+enum limb_isa {
+    LIMB_SCALAR,
+    LIMB_ADX,
+};
+
+/* The instruction set the kernels currently dispatch to. */
+limb_isa limb_get_isa();
+
+/* Forces the kernels onto the given instruction set, or the best supported one below it. Returns the set chosen.
+ * Meant for testing and benchmarking the fallback. */
+limb_isa limb_set_isa(limb_isa isa);
+
+/* r = a + b over n limbs; returns the carry out. */
+uint64_t limb_add_n(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n);
+
+/* r = a - b over n limbs; returns the borrow out. */
+uint64_t limb_sub_n(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n);
+
+/* r = a + c, r = a - c for a single limb c; return the carry and the borrow out. */
+uint64_t limb_add_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t c);
+uint64_t limb_sub_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t c);
+
+/* r = a * m over n limbs; returns the high limb. */
+uint64_t limb_mul_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t m);
+
+/* r += a * m over n limbs; returns the limb carried out. */
+uint64_t limb_addmul_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t m);
+
+/* r -= a * m over n limbs; returns the limb borrowed out. */
+uint64_t limb_submul_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t m);
+
+#endif
@@ -0,0 +1,119 @@
+#include "./modular.h"
+#include "./euclid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "../util/instrument.h"
+
+typedef unsigned __int128 uint128_t;
+
+uint64_t mod_add(uint64_t a, uint64_t b, uint64_t p) {
+    uint64_t s = a + b;
+    return s >= p ? s - p : s;
+}
+
+uint64_t mod_sub(uint64_t a, uint64_t b, uint64_t p) {
+    return a >= b ? a - b : a + p - b;
+}
+
+uint64_t mod_mul(uint64_t a, uint64_t b, uint64_t p) {
+    return (uint64_t) ((uint128_t) a * b % p);
+}
+
+uint64_t mod_pow(uint64_t a, uint64_t e, uint64_t p) {
+    uint64_t c = 1 % p;
+    while (e) {
+        if (e & 1) c = mod_mul(c, a, p);
+        a = mod_mul(a, a, p);
+        e >>= 1;
+    }
+    return c;
+}
+
+uint64_t mod_inv(uint64_t a, uint64_t p) {
+    extended_euclid_ret r = extended_euclid((long) (a % p), (long) p);
+    if (r.gcd != 1) return 0;
+    return mod_reduce(r.a, p);
+}
+
+uint64_t mod_reduce(long a, uint64_t p) {
+    if (a >= 0) return (uint64_t) a % p;
+    uint64_t r = (0 - (uint64_t) a) % p;
+    return r ? p - r : 0;
+}
+
+bool is_prime_u64(uint64_t n) {
+    if (n < 2) return false;
+    static const uint64_t small[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    for (size_t i = 0; i < sizeof(small) / sizeof(small[0]); i++) {
+        if (n % small[i] == 0) return n == small[i];
+    }
+    uint64_t d = n - 1;
+    int s = __builtin_ctzl(d);
+    d >>= s;
+    // these bases are enough for every n < 2^64
+    for (size_t i = 0; i < sizeof(small) / sizeof(small[0]); i++) {
+        uint64_t x = mod_pow(small[i], d, n);
+        if (x == 1 || x == n - 1) continue;
+        int r = 1;
+        for (; r < s; r++) {
+            x = mod_mul(x, x, n);
+            if (x == n - 1) break;
+        }
+        if (r == s) return false;
+    }
+    return true;
+}
+
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t* table;
+static size_t table_n;
+static size_t table_capacity;
+
+uint64_t mod_prime(size_t i) {
+    pthread_mutex_lock(&table_lock);
+    while (table_n <= i) {
+        if (table_n == table_capacity) {
+            table_capacity = table_capacity ? 2 * table_capacity : 64;
+            uint64_t* t = realloc(table, table_capacity * sizeof(uint64_t));
+            if (!t) {
+                perror("Could not allocate memory in mod_prime");
+                exit(EXIT_FAILURE);
+            }
+            table = t;
+        }
+        uint64_t c = table_n ? table[table_n - 1] - 2 : ((uint64_t) 1 << MOD_PRIME_BITS) - 1;
+        while (!is_prime_u64(c)) c -= 2;
+        table[table_n++] = c;
+    }
+    uint64_t p = table[i];
+    pthread_mutex_unlock(&table_lock);
+    return p;
+}
+
+mod_mont mod_mont_init(uint64_t p) {
+    // Newton iteration for p^-1 mod 2^64; p is its own inverse mod 8 and each step doubles the correct bits
+    uint64_t inv = p;
+    for (int k = 0; k < 5; k++) {
+        inv *= 2 - p * inv;
+    }
+    uint64_t r = (uint64_t) (((uint128_t) 1 << 64) % p);
+    return (mod_mont){.p = p, .pinv = 0 - inv, .r2 = mod_mul(r, r, p)};
+}
+
+uint64_t mod_mont_pow(const mod_mont* m, uint64_t a, uint64_t e) {
+    uint64_t c = mod_mont_to(m, 1);
+    a = mod_mont_to(m, a % m->p);
+    while (e) {
+        if (e & 1) c = mod_mont_mul(m, c, a);
+        a = mod_mont_mul(m, a, a);
+        e >>= 1;
+    }
+    return mod_mont_from(m, c);
+}
+
+mod_barrett mod_barrett_init(uint64_t p) {
+    int bits = 64 - __builtin_clzl(p);
+    uint128_t top = ((uint128_t) 1 << (2 * bits)) - 1;
+    return (mod_barrett){.p = p, .m = (uint64_t) (top / p), .bits = bits};
+}
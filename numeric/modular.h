@@ -0,0 +1,102 @@
+#ifndef _MODULAR_H_INCLUDED_
+#define _MODULAR_H_INCLUDED_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Primes in the prime table are the largest primes below 2^MOD_PRIME_BITS, in decreasing order. Products of two
+ * residues fit comfortably in 128 bits, and sums of two residues do not overflow a word. */
+#define MOD_PRIME_BITS 62
+
+/* Arithmetic modulo p for 0 <= a, b < p < 2^63. */
+uint64_t mod_add(uint64_t a, uint64_t b, uint64_t p);
+uint64_t mod_sub(uint64_t a, uint64_t b, uint64_t p);
+uint64_t mod_mul(uint64_t a, uint64_t b, uint64_t p);
+uint64_t mod_pow(uint64_t a, uint64_t e, uint64_t p);
+/* Inverse of a modulo p through extended_euclid. Returns 0 if a is not invertible. */
+uint64_t mod_inv(uint64_t a, uint64_t p);
+/* The residue of a signed word modulo p. */
+uint64_t mod_reduce(long a, uint64_t p);
+
+/* Deterministic Miller-Rabin for 64-bit n. */
+bool is_prime_u64(uint64_t n);
+
+/* The i-th prime of the prime table. The table is extended on demand and may be read from several threads. */
+uint64_t mod_prime(size_t i);
+
+/* Montgomery arithmetic modulo an odd p < 2^63, with R = 2^64. Residues are kept in Montgomery form a R mod p, in
+ * which a product costs two multiplications and no division. */
+typedef struct mod_mont mod_mont;
+
+struct mod_mont {
+    uint64_t p;
+    // -p^-1 mod 2^64
+    uint64_t pinv;
+    // R^2 mod p, for conversion into Montgomery form
+    uint64_t r2;
+};
+
+mod_mont mod_mont_init(uint64_t p);
+
+/* t R^-1 mod p for t < p 2^64. */
+static inline uint64_t mod_mont_redc(const mod_mont* m, unsigned __int128 t) {
+    uint64_t q = (uint64_t) t * m->pinv;
+    uint64_t r = (uint64_t) ((t + (unsigned __int128) q * m->p) >> 64);
+    return r >= m->p ? r - m->p : r;
+}
+
+static inline uint64_t mod_mont_mul(const mod_mont* m, uint64_t a, uint64_t b) {
+    return mod_mont_redc(m, (unsigned __int128) a * b);
+}
+
+static inline uint64_t mod_mont_to(const mod_mont* m, uint64_t a) {
+    return mod_mont_mul(m, a, m->r2);
+}
+
+static inline uint64_t mod_mont_from(const mod_mont* m, uint64_t a) {
+    return mod_mont_redc(m, a);
+}
+
+/* a^e mod p, taking and returning ordinary residues. */
+uint64_t mod_mont_pow(const mod_mont* m, uint64_t a, uint64_t e);
+
+/* Barrett reduction modulo 1 < p < 2^63: the quotient is estimated with a precomputed reciprocal and corrected by
+ * at most a few subtractions. */
+typedef struct mod_barrett mod_barrett;
+
+struct mod_barrett {
+    uint64_t p;
+    // floor((2^(2 bits) - 1) / p)
+    uint64_t m;
+    // bit length of p
+    int bits;
+};
+
+mod_barrett mod_barrett_init(uint64_t p);
+
+/* x mod p for x < p^2. */
+static inline uint64_t mod_barrett_reduce(const mod_barrett* b, unsigned __int128 x) {
+    uint64_t q = (uint64_t) (((unsigned __int128) (uint64_t) (x >> (b->bits - 1)) * b->m) >> (b->bits + 1));
+    unsigned __int128 r = x - (unsigned __int128) q * b->p;
+    while (r >= b->p) r -= b->p;
+    return (uint64_t) r;
+}
+
+static inline uint64_t mod_barrett_mul(const mod_barrett* b, uint64_t x, uint64_t y) {
+    return mod_barrett_reduce(b, (unsigned __int128) x * y);
+}
+
+/* Shoup multiplication by a fixed w < p < 2^63: with w' = mod_shoup_precomp(w, p), a w mod p costs two
+ * multiplications and one conditional subtraction, for any a < 2^64. Pays off when w multiplies many values. */
+static inline uint64_t mod_shoup_precomp(uint64_t w, uint64_t p) {
+    return (uint64_t) (((unsigned __int128) w << 64) / p);
+}
+
+static inline uint64_t mod_shoup_mul(uint64_t a, uint64_t w, uint64_t wp, uint64_t p) {
+    uint64_t q = (uint64_t) (((unsigned __int128) a * wp) >> 64);
+    uint64_t r = a * w - q * p;
+    return r >= p ? r - p : r;
+}
+
+#endif
@@ -1,331 +1,569 @@
 #include "./mp_int.h"
+#include "./limb.h"
+#include "./euclid.h"
 #include <stdlib.h>
 #include <stdint.h>
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "../util/instrument.h"
 
-#define LARGEST_BITS 0xffffffff00000000
-#define SMALLEST_BITS 0x00000000ffffffff
+/* Largest power of ten that fits in a limb, and its number of digits. */
+#define LIMB_DEC_BASE 10000000000000000000UL
+#define LIMB_DEC_DIGITS 19
+
+typedef unsigned __int128 uint128_t;
+typedef __int128 int128_t;
 
-typedef struct darr darr;
 struct darr {
     size_t n;
     size_t capacity;
     uint64_t* arr;
 };
 
-darr* init_darr(size_t s) {
-    darr d;
-    d.n = 0;
-    d.capacity = s;
-    d.arr = malloc(s * sizeof(uint64_t));
-    if (!d.arr) perror("Could not allocate memory in init_darr");
-    return &d;
+static darr* init_darr(size_t s) {
+    darr* d = malloc(sizeof(darr));
+    if (!d) {
+        perror("Could not allocate memory in init_darr");
+        exit(EXIT_FAILURE);
+    }
+    d->n = 0;
+    d->capacity = s ? s : 1;
+    d->arr = malloc(d->capacity * sizeof(uint64_t));
+    if (!d->arr) {
+        perror("Could not allocate memory in init_darr");
+        exit(EXIT_FAILURE);
+    }
+    return d;
 }
 
-void darr_insert(darr* const d, uint64_t item) {
-    if (d->n < d->capacity) {
-        d->n++;
-        d->arr[d->n] = item;
-    } else {
-        uint64_t* temp = realloc(d->arr, 2 * d->capacity * sizeof(uint64_t));
-        if (!temp) {
-            perror("Issue rellocating memory on insert to darr");
-            exit(EXIT_FAILURE);
-        }
-        d->arr = temp;
-        d->n++;
-        d->capacity *= 2;
-        d->arr[d->n] = item;
+/* Views (see mpint_view) have capacity 0 and do not own their limbs. */
+static void free_darr(darr* d) {
+    if (!d) return;
+    if (d->capacity) free(d->arr);
+    free(d);
+}
+
+static void darr_set_capacity(darr* const d, size_t c) {
+    if (!c) c = 1;
+    uint64_t* temp = realloc(d->arr, c * sizeof(uint64_t));
+    if (!temp) {
+        perror("Issue reallocating in darr_set_capacity");
+        exit(EXIT_FAILURE);
     }
+    d->arr = temp;
+    d->capacity = c;
+    if (d->n > c) d->n = c;
 }
 
-uint64_t darr_pop(darr* const d) {
-    uint64_t out = d->arr[--d->n];
-    if (d->n < 2 && d->n < d->capacity / 4) {
-        uint64_t* temp = realloc(d->arr, d->capacity / 2 * sizeof(uint64_t));
-        if (!temp) {
-            perror("Error reallocating memory in darr_pop");
-            exit(EXIT_FAILURE);
-        }
-        d->arr = temp;
+static void darr_insert(darr* const d, uint64_t item) {
+    if (d->n == d->capacity) {
+        darr_set_capacity(d, 2 * d->capacity);
     }
+    d->arr[d->n++] = item;
+}
+
+/* An mp_int with room for s limbs and the value zero. */
+static mp_int mp_alloc(size_t s) {
+    mp_int out = {
+        .sgn = 0,
+        .arr = init_darr(s)
+    };
+    return out;
 }
 
-void darr_reverse(darr* const d) {
-    size_t i = 0, j = d->n - 1;
-    int64_t temp;
-    while (i < j) {
-        temp = d->arr[i];
-        d->arr[i] = d->arr[j];
-        d->arr[j] = temp;
-        i++; j--;
+/* Removes leading zero limbs, and the sign of zero. */
+static void mp_trim(mp_int* const m) {
+    while (m->arr->n && !m->arr->arr[m->arr->n - 1]) {
+        m->arr->n--;
     }
+    if (!m->arr->n) m->sgn = 0;
 }
 
-void darr_set_capacity(darr* const d, size_t c) {
-    d->capacity = c;
-    uint64_t* temp = (d->arr, d->capacity * sizeof(uint64_t));
-    if (!temp) {
-        perror("Issue reallocating in darr_set_capacity");
-        exit(EXIT_FAILURE);
+/* A read-only mp_int over a single limb on the stack, for comparisons against machine integers. */
+#define MP_VIEW_LONG(name, value)                                                   \
+    uint64_t name##_limb = (value) < 0 ? 0 - (uint64_t) (value) : (uint64_t) (value);  \
+    darr name##_darr = {.n = (value) != 0, .capacity = 1, .arr = &name##_limb};        \
+    mp_int name = {.sgn = (value) < 0, .arr = &name##_darr}
+
+/* ---------------- magnitudes ---------------- */
+
+static int cmp_mag(const uint64_t* a, size_t na, const uint64_t* b, size_t nb) {
+    if (na != nb) return na > nb ? 1 : -1;
+    while (na-- > 0) {
+        if (a[na] != b[na]) return a[na] > b[na] ? 1 : -1;
     }
-    d->arr = temp;
+    return 0;
+}
+
+/* out = a + b for na >= nb. out has room for na + 1 limbs and may alias a. Returns the number of limbs. */
+static size_t add_mag(uint64_t* out, const uint64_t* a, size_t na, const uint64_t* b, size_t nb) {
+    uint64_t carry = limb_add_n(out, a, b, nb);
+    carry = limb_add_1(out + nb, a + nb, na - nb, carry);
+    out[na] = carry;
+    return na + carry;
 }
 
-inline uint64_t pow_of_10(uint16_t n) {
-    uint64_t accum = 1;
+/* out = a - b for a >= b. out has room for na limbs and may alias a. */
+static void sub_mag(uint64_t* out, const uint64_t* a, size_t na, const uint64_t* b, size_t nb) {
+    uint64_t borrow = limb_sub_n(out, a, b, nb);
+    limb_sub_1(out + nb, a + nb, na - nb, borrow);
+}
+
+/* q = a / d for a single limb d, written to q (which may alias a). Returns a % d. */
+static uint64_t divmod_1(uint64_t* q, const uint64_t* a, size_t n, uint64_t d) {
+    uint64_t r = 0;
     while (n-- > 0) {
-        accum *= 10;
+        uint128_t num = ((uint128_t) r << 64) | a[n];
+        q[n] = (uint64_t) (num / d);
+        r = (uint64_t) (num % d);
     }
-    return accum;
+    return r;
 }
 
-struct mp_int {
-    // true for negative, false for positive
-    bool sgn;
-    darr* arr;
-};
-struct padic_int {
-    bool sgn;
-    uint64_t modulus;
-    darr* arr;
-};
+/* Knuth's algorithm D. q receives na - nb + 1 limbs and r receives nb limbs, for na >= nb >= 2. */
+static void divmod_mag(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* q, uint64_t* r) {
+    int s = __builtin_clzl(b[nb - 1]);
+    uint64_t* vn = malloc(nb * sizeof(uint64_t));
+    uint64_t* un = malloc((na + 1) * sizeof(uint64_t));
+    if (!vn || !un) {
+        perror("Could not allocate memory in divmod_mag");
+        exit(EXIT_FAILURE);
+    }
+    // normalize so that the top bit of the divisor is set
+    for (size_t i = nb - 1; i > 0; i--) {
+        vn[i] = (b[i] << s) | (s ? b[i - 1] >> (64 - s) : 0);
+    }
+    vn[0] = b[0] << s;
+    un[na] = s ? a[na - 1] >> (64 - s) : 0;
+    for (size_t i = na - 1; i > 0; i--) {
+        un[i] = (a[i] << s) | (s ? a[i - 1] >> (64 - s) : 0);
+    }
+    un[0] = a[0] << s;
+
+    for (size_t j = na - nb + 1; j-- > 0;) {
+        uint128_t num = ((uint128_t) un[j + nb] << 64) | un[j + nb - 1];
+        uint128_t qhat = num / vn[nb - 1];
+        uint128_t rhat = num % vn[nb - 1];
+        while ((qhat >> 64) || qhat * vn[nb - 2] > ((rhat << 64) | un[j + nb - 2])) {
+            qhat--;
+            rhat += vn[nb - 1];
+            if (rhat >> 64) break;
+        }
+        // multiply and subtract; qhat < 2^64 after the correction above
+        uint64_t borrow = limb_submul_1(un + j, vn, nb, (uint64_t) qhat);
+        uint64_t top = un[j + nb];
+        un[j + nb] = top - borrow;
+
+        q[j] = (uint64_t) qhat;
+        if (top < borrow) {
+            // qhat was one too large: add the divisor back
+            q[j]--;
+            un[j + nb] += limb_add_n(un + j, un + j, vn, nb);
+        }
+    }
+    // unnormalize the remainder
+    for (size_t i = 0; i < nb; i++) {
+        r[i] = (un[i] >> s) | (s ? un[i + 1] << (64 - s) : 0);
+    }
+    free(vn);
+    free(un);
+}
+
+/* ---------------- construction ---------------- */
 
 mp_int mpint_init(const char* num) {
-    size_t len_num = 0;
-    while (num[len_num] != "\0") len_num++;
+    size_t len_num = strlen(num);
     assert(len_num > 0);
 
-    mp_int out = {
-        .arr = init_darr(2),
-        .sgn = 0
-    };
-
-    size_t i = 0;
-    if (num[0] == "-" || num[0] == "+") {
-        out.sgn = (num[0] == "-");
-        i++;
+    bool sgn = 0;
+    if (num[0] == '-' || num[0] == '+') {
+        sgn = (num[0] == '-');
+        num++;
+        len_num--;
     }
+    return mpint_from_digits(num, len_num, sgn);
+}
+
+mp_int mpint_from_digits(const char* digits, size_t len, bool negative) {
+    mp_int out = mp_alloc(len / LIMB_DEC_DIGITS + 1);
 
-    while (i < len_num) {
-        int j = 0;
-        uint64_t accum = 0;
-        while (j < 18 && (i + j) < len_num) {
-            accum += (num[i + j] * pow_of_10(18-j-1));
+    // consume the digits in chunks that fit in a limb: out = out * 10^j + chunk
+    size_t i = 0;
+    while (i < len) {
+        size_t j = 0;
+        uint64_t accum = 0, scale = 1;
+        while (j < LIMB_DEC_DIGITS && (i + j) < len) {
+            assert(digits[i + j] >= '0' && digits[i + j] <= '9');
+            accum = 10 * accum + (uint64_t) (digits[i + j] - '0');
+            scale *= 10;
             j++;
         }
-        darr_insert(out.arr, accum);
+        // out * scale + accum fits in one more limb, so the carries cannot overflow
+        uint64_t carry = limb_mul_1(out.arr->arr, out.arr->arr, out.arr->n, scale);
+        carry += limb_add_1(out.arr->arr, out.arr->arr, out.arr->n, accum);
+        if (!out.arr->n || carry) {
+            darr_insert(out.arr, out.arr->n ? carry : accum);
+        }
         i += j;
     }
-    darr_reverse(out.arr);  
-    // remove leading zeroes
-    while (out.arr->arr[out.arr->n] == 0) {
-            darr_pop(out.arr);
+    out.sgn = negative;
+    mp_trim(&out);
+    return out;
+}
+
+mp_int mpint_from_long(long a) {
+    mp_int out = mp_alloc(1);
+    if (a) {
+        darr_insert(out.arr, a < 0 ? 0 - (uint64_t) a : (uint64_t) a);
+        out.sgn = a < 0;
     }
     return out;
 }
 
+mp_int mpint_copy(const mp_int* const m) {
+    mp_int out = mp_alloc(m->arr->n);
+    memcpy(out.arr->arr, m->arr->arr, m->arr->n * sizeof(uint64_t));
+    out.arr->n = m->arr->n;
+    out.sgn = m->sgn;
+    return out;
+}
+
+mp_int mpint_view(bool negative, const uint64_t* limbs, size_t n) {
+    darr* d = malloc(sizeof(darr));
+    if (!d) {
+        perror("Could not allocate memory in mpint_view");
+        exit(EXIT_FAILURE);
+    }
+    *d = (darr){.n = n, .capacity = 0, .arr = (uint64_t*) limbs};
+    return (mp_int){.sgn = negative && n, .arr = d};
+}
+
+void mpint_free(mp_int* m) {
+    if (!m) return;
+    free_darr(m->arr);
+    m->arr = 0;
+}
+
+/* ---------------- arithmetic ---------------- */
+
 mp_int mpint_add(const mp_int* const m1, const mp_int* const m2) {
-    if (m1->sgn && !m2->sgn) {
-        mp_int temp;
-        temp.arr = m1->arr;
-        temp.sgn = 0;
-        return mpint_sub(m2, &temp);
-    } else if (!m1->sgn && m2->sgn) {
-        mp_int temp;
-        temp.arr = m2->arr;
-        temp.sgn = 0;
-        return mpint_sub(m1, &temp);    
-    }
-    // can assume now that both m1 and m2 have the same sign.
-    mp_int out = {
-        .arr = init_darr(m1->arr->n > m2->arr->n ? m1->arr->n + 1 : m2->arr->n + 1),
-        .sgn = 0
+    const darr* a = m1->arr;
+    const darr* b = m2->arr;
+    if (a->n < b->n) {
+        return mpint_add(m2, m1);
+    }
+    mp_int out = mp_alloc(a->n + 1);
+    if (m1->sgn == m2->sgn) {
+        out.arr->n = add_mag(out.arr->arr, a->arr, a->n, b->arr, b->n);
+        out.sgn = m1->sgn;
+        return out;
+    }
+    // different signs: subtract the smaller magnitude from the larger
+    int c = cmp_mag(a->arr, a->n, b->arr, b->n);
+    if (c >= 0) {
+        sub_mag(out.arr->arr, a->arr, a->n, b->arr, b->n);
+        out.sgn = m1->sgn;
+    } else {
+        sub_mag(out.arr->arr, b->arr, b->n, a->arr, a->n);
+        out.sgn = m2->sgn;
+    }
+    out.arr->n = a->n;
+    mp_trim(&out);
+    return out;
+}
+
+mp_int mpint_sub(const mp_int* const m1, const mp_int* const m2) {
+    // m1 + (-m2), with -m2 sharing the limbs of m2
+    mp_int neg = {
+        .sgn = !m2->sgn,
+        .arr = m2->arr
     };
-    size_t i = 0, k = 0;
-
-    // s for sum, r for remainder
-    uint64_t s = 0;
-    uint8_t r = 0;
-    while (i < m1->arr->n && i < m2->arr->n) {
-        s = r + m1->arr->arr[i] + m2->arr->arr[i];
-        r = m1->arr->arr[i] > UINT64_MAX - m2->arr->arr[i];
-        darr_insert(out.arr, s);
-        i++;
-    }
-    while (i < m1->arr->n) {
-        s = m1->arr->arr[i] + r;
-        r = (s == 0);
-        darr_insert(out.arr, s);
-        i++;
-    }
-    while (i < m2->arr->n) {
-        s = m2->arr->arr[i] + r;
-        r = (s == 0);
-        darr_insert(out.arr, s);
-        i++;
-    }
-    if (r) {
-        darr_insert(out.arr, r);
-    }
-    out.sgn = m1->sgn;
+    return mpint_add(m1, &neg);
+}
+
+/* Schoolbook multiplication, one limb_addmul_1 row per limb of the first operand. */
+mp_int mpint_prod(const mp_int* const m1, const mp_int* const m2) {
+    const darr* a = m1->arr;
+    const darr* b = m2->arr;
+    if (!a->n || !b->n) {
+        return mp_alloc(1);
+    }
+    mp_int out = mp_alloc(a->n + b->n);
+    // one row per limb of a; the first row sets the limbs that the others add into
+    uint64_t* r = out.arr->arr;
+    r[b->n] = limb_mul_1(r, b->arr, b->n, a->arr[0]);
+    for (size_t i = 1; i < a->n; i++) {
+        r[i + b->n] = limb_addmul_1(r + i, b->arr, b->n, a->arr[i]);
+    }
+    out.arr->n = a->n + b->n;
+    out.sgn = m1->sgn != m2->sgn;
+    mp_trim(&out);
     return out;
 }
 
-/* Returns 1 if |m1| > |m2|, 0 if |m1| = |m2|, and -1 if |m1| < |m2|*/
-int8_t mpint_cmp_magnitude(const mp_int* const m1, const mp_int* const m2) {
-    size_t i = m1->arr->n - 1;
-    size_t j = m2->arr->n - 1;
+void mpint_divmod(const mp_int* const m1, const mp_int* const m2, mp_int* quo, mp_int* rem) {
+    const darr* a = m1->arr;
+    const darr* b = m2->arr;
+    assert(b->n > 0);
 
-    while (m1->arr->arr[i] == 0) {
-        i--;
-    } 
-    while (m2->arr->arr[j] == 0) {
-        j--;
+    mp_int q = mp_alloc(a->n >= b->n ? a->n - b->n + 1 : 1);
+    mp_int r = mp_alloc(b->n);
+    if (cmp_mag(a->arr, a->n, b->arr, b->n) < 0) {
+        memcpy(r.arr->arr, a->arr, a->n * sizeof(uint64_t));
+        r.arr->n = a->n;
+    } else if (b->n == 1) {
+        r.arr->arr[0] = divmod_1(q.arr->arr, a->arr, a->n, b->arr[0]);
+        q.arr->n = a->n;
+        r.arr->n = 1;
+    } else {
+        divmod_mag(a->arr, a->n, b->arr, b->n, q.arr->arr, r.arr->arr);
+        q.arr->n = a->n - b->n + 1;
+        r.arr->n = b->n;
     }
-    if (i > j) return 1;
-    if (i < j) return -1;
+    q.sgn = m1->sgn != m2->sgn;
+    r.sgn = m1->sgn;
+    mp_trim(&q);
+    mp_trim(&r);
 
-    while (i >= 0) {
-        if (m1->arr->arr[i] == m2->arr->arr[j]) {
-            i--;
-        } else if (m1->arr->arr[i] > m2->arr->arr[i]) {
-            return 1;
-        } else {
-            return -1;
+    if (quo) *quo = q; else mpint_free(&q);
+    if (rem) *rem = r; else mpint_free(&r);
+}
+
+mp_int mpint_div(const mp_int* const m1, const mp_int* const m2) {
+    mp_int q;
+    mpint_divmod(m1, m2, &q, 0);
+    return q;
+}
+
+mp_int mpint_mod(const mp_int* const m1, const mp_int* const m2) {
+    mp_int r;
+    mpint_divmod(m1, m2, 0, &r);
+    return r;
+}
+
+mp_int mpint_pow(const mp_int* const m1, const mp_int* const m2) {
+    assert(!m2->sgn && mpint_fits_long(m2));
+    long e = mpint_to_long(m2);
+    mp_int accum = mpint_from_long(1);
+    mp_int base = mpint_copy(m1);
+    while (e) {
+        if (e & 1) {
+            mp_int t = mpint_prod(&accum, &base);
+            mpint_free(&accum);
+            accum = t;
+        }
+        e >>= 1;
+        if (e) {
+            mp_int t = mpint_prod(&base, &base);
+            mpint_free(&base);
+            base = t;
         }
     }
-    return 0;
+    mpint_free(&base);
+    return accum;
 }
 
-mp_int mpint_sub(const mp_int* const m1, const mp_int* const m2) {
-    // if m2 is negative, then do m1 + |m2|
-    // this might send back to mpint_sub if m1 is negative, but the recursion 
-    // only happens one time.
-    if (m2->sgn) {
-        mp_int temp;
-        temp.arr = m2->arr;
-        temp.sgn = 0;
-        return mpint_add(m1, &temp);
-    }
-    // if m1 is negative (and we know m2 is positive), do -(|m1| + |m2|)
-    else if (m1->sgn) {
-        mp_int temp;
-        temp.arr = m2->arr;
-        temp.sgn = 1;
-        return mpint_add(m1, &temp);
-    }
-
-    // know that m1, m2 > 0;
-    // ensure that |m1| >= |m2|. If not, then return -(m2 - m1).
-    if (mpint_cmp_magnitude(m1, m2) == -1) {
-        mp_int t1, t2;
-        t1.arr = m1->arr;
-        t1.sgn = 0;
-
-        t2.arr = m2->arr;
-        t2.sgn = 0;
-
-        mp_int out = mpint_sub(&t2, &t1);
-        out.sgn = !out.sgn;
-        return out;
-    }
+/* ---------------- gcd ---------------- */
 
-    // can now assume that both m1 and m2 are positive, |m1| >= |m2|.
-    mp_int out = {
-        .arr = init_darr(m1->arr->n > m2->arr->n ? m1->arr->n + 1 : m2->arr->n + 1),
-        .sgn = 0
-    };
-    size_t i = 0, k = 0;
+/* The 62 bits of a starting at its leading bit, and the bits of b in the same positions. */
+static void leading_bits(const darr* a, const darr* b, int64_t* x, int64_t* y) {
+    size_t n = a->n;
+    int lz = __builtin_clzl(a->arr[n - 1]);
+    uint64_t ahi = a->arr[n - 1], alo = n > 1 ? a->arr[n - 2] : 0;
+    uint64_t bhi = b->n >= n ? b->arr[n - 1] : 0;
+    uint64_t blo = (n > 1 && b->n >= n - 1) ? b->arr[n - 2] : 0;
+    uint64_t xa = (ahi << lz) | (lz ? alo >> (64 - lz) : 0);
+    uint64_t yb = (bhi << lz) | (lz ? blo >> (64 - lz) : 0);
+    *x = (int64_t) (xa >> 2);
+    *y = (int64_t) (yb >> 2);
+}
 
-    // s for sum, r for remainder
-    uint64_t s = 0;
-    uint8_t r = 0;
-    while (i < m1->arr->n && i < m2->arr->n) {
-        s = m1->arr->arr[i] - m2->arr->arr[i] - r;
-        r = (m1->arr->arr[i] < m2->arr->arr[i]) || (m1->arr->arr[i] == m2->arr->arr[i] && r > 0);
-        darr_insert(out.arr, s);
-        i++; k++;
+/* out = s * a + t * b over n limbs, for cofactors below 2^62 in absolute value and a nonnegative result. Lehmer's
+ * cofactors never have the same nonzero sign, so this is a multiplication by one and an addmul or submul by the
+ * other. */
+static void lin_comb(uint64_t* out, int64_t s, const darr* a, int64_t t, const darr* b, size_t n) {
+    if (s < 0) {
+        int64_t ts = s;
+        s = t;
+        t = ts;
+        const darr* tb = a;
+        a = b;
+        b = tb;
     }
-    while (i < m1->arr->n) {
-        s = m1->arr->arr[i] - r;
-        r = (s + r == 0 && r > 0);
-        darr_insert(out.arr, s);
-        i++; k++;
+    uint64_t hi = limb_mul_1(out, a->arr, a->n, (uint64_t) s);
+    if (a->n < n) {
+        out[a->n] = hi;
+        memset(out + a->n + 1, 0, (n - a->n - 1) * sizeof(uint64_t));
+        hi = 0;
     }
-    // remove leading zeroes
-    while (out.arr->arr[k] == 0) {
-        darr_pop(out.arr);
-        k--;
+    uint64_t c;
+    if (t >= 0) {
+        c = limb_addmul_1(out, b->arr, b->n, (uint64_t) t);
+        c = limb_add_1(out + b->n, out + b->n, n - b->n, c);
+        assert(hi + c == 0);
+    } else {
+        c = limb_submul_1(out, b->arr, b->n, 0 - (uint64_t) t);
+        c = limb_sub_1(out + b->n, out + b->n, n - b->n, c);
+        assert(hi == c);
     }
-    return out;   
+    (void) hi;
 }
 
-/* Multiplication using the shift and add algorithm. */
-mp_int mpint_prod(const mp_int* const m1, const mp_int* const m2) {
-    mp_int accum = mpint_init("0\0");
-    darr_set_capacity(accum.arr, m1->arr->n + m2->arr->n + 1);
-    size_t offset = 0;
-    uint64_t remainder, carry = 0;
-    
-    while (offset < m1->arr->n) {
-        for (size_t index = 0; index < m2->arr->n; index++) {
-            // we have to do a Karatsbua-like multiplication here in order to handle 
-            // overflowing integers. Using words of length b, the product can be of 
-            // size (b-1)^2 = b^2 - 2b + 1 = b(b - 2) + 1 >> b. In order to get the 
-            // carry and the remainder, we split each word into the top and bottom half, 
-            // then combine them. See example with (binary) words of length 4.
-            // 10 11
-            // 11 01
-            // --------------
-            // (0011 * 0001) + 4(0010 * 0001) + 4(0011 * 0011) + 16(0010 * 0011)
-            // 0011 + 4(0010) + 4(1001) + 16(0110)
-            // 0011 + 0000 1000 + 0010 0100 + 0110 0000
-            uint64_t a = m1->arr->arr[offset] & SMALLEST_BITS;
-            uint64_t b = (m1->arr->arr[offset] & LARGEST_BITS) >> 32;
-            uint64_t c = m2->arr->arr[index] & SMALLEST_BITS;
-            uint64_t d = (m2->arr->arr[index] & LARGEST_BITS) >> 32;
-
-            remainder = a * c + (a * d) << 32 + (b * c) << 32;
-            // automatically overflows to the corrrect value.
-            accum.arr->arr[offset + index] += (remainder + carry);
-            carry = (a * d) >> 32 + (b * c) >> 32 + c * d;
-            // Check to see if adding to accum caused overflow and update
-            // the carry accordingly. If there is no overflow, then addition is 
-            // monotone increasing, so the second condition should not be true.
-            if ((carry > UINT64_MAX - remainder) || 
-                (accum.arr->arr[offset + index] - remainder - carry < accum.arr->arr[offset + index])) {
-                carry += 1; 
-            }
+mp_int mpint_gcd(const mp_int* const m1, const mp_int* const m2) {
+    mp_int u = mpint_copy(m1);
+    mp_int v = mpint_copy(m2);
+    u.sgn = v.sgn = 0;
+    if (cmp_mag(u.arr->arr, u.arr->n, v.arr->arr, v.arr->n) < 0) {
+        mp_int t = u;
+        u = v;
+        v = t;
+    }
+    mp_int w = mp_alloc(u.arr->n);
+    mp_int z = mp_alloc(u.arr->n);
+
+    // Lehmer's algorithm, as in Knuth 4.5.2 algorithm L, while v has more than one limb
+    while (v.arr->n > 1) {
+        int64_t x, y;
+        leading_bits(u.arr, v.arr, &x, &y);
+        int64_t A = 1, B = 0, C = 0, D = 1;
+        while (y + C > 0 && y + D > 0) {
+            int64_t q = (x + A) / (y + C);
+            if (q != (x + B) / (y + D)) break;
+            int64_t T = A - q * C; A = C; C = T;
+            T = B - q * D; B = D; D = T;
+            T = x - q * y; x = y; y = T;
         }
-        // If there is still carry, add it to accum.
-        if (carry) {
-            accum.arr->arr[offset + m1->arr->n] += carry;
+
+        size_t n = u.arr->n;
+        if (!B) {
+            // the leading bits did not determine a single quotient: take a full division step
+            mp_int r = mpint_mod(&u, &v);
+            mpint_free(&u);
+            u = v;
+            v = r;
+            continue;
         }
+        // (u, v) <- (A u + B v, C u + D v), computed into the scratch pair (w, z), which then trades places with (u, v)
+        if (w.arr->capacity < n) darr_set_capacity(w.arr, n);
+        if (z.arr->capacity < n) darr_set_capacity(z.arr, n);
+        lin_comb(w.arr->arr, A, u.arr, B, v.arr, n);
+        lin_comb(z.arr->arr, C, u.arr, D, v.arr, n);
+        w.arr->n = z.arr->n = n;
+
+        mp_int t = u;
+        u = w;
+        w = t;
+        t = v;
+        v = z;
+        z = t;
+        mp_trim(&u);
+        mp_trim(&v);
     }
-    // If there is still carry, add it to accum.
-    if (carry) {
-        accum.arr->arr[offset + m1->arr->n] += carry;
+    mpint_free(&w);
+    mpint_free(&z);
+
+    if (v.arr->n == 1) {
+        // finish with word arithmetic
+        uint64_t r = divmod_1(u.arr->arr, u.arr->arr, u.arr->n, v.arr->arr[0]);
+        u.arr->arr[0] = ugcd(v.arr->arr[0], r);
+        u.arr->n = 1;
     }
-    return accum;
+    mpint_free(&v);
+    return u;
 }
 
-mp_int mpint_div(const mp_int* const, const mp_int* const);
-mp_int mpint_pow(const mp_int* const, const mp_int* const);
+/* ---------------- conversion and comparison ---------------- */
 
-bool mpint_lt(const mp_int* const, const mp_int* const);
-bool mpint_eq(const mp_int* const, const mp_int* const);
-bool mpint_lt_i(const mp_int* const, const int);
-bool mpint_eq_i(const mp_int* const, const int);
-bool mpint_nz(const mp_int* const);
+size_t mpint_size(const mp_int* const m) {
+    return m->arr->n;
+}
 
+const uint64_t* mpint_limbs(const mp_int* const m) {
+    return m->arr->arr;
+}
 
-bool padic_lt(const padic_int* const, const padic_int* const);
-bool padic_eq(const padic_int* const, const padic_int* const);
-bool mpint_lt_i(const mp_int* const, const int);
-bool mpint_eq_i(const mp_int* const, const int);
-bool mpint_nz(const mp_int* const);
+size_t mpint_bits(const mp_int* const m) {
+    size_t n = m->arr->n;
+    if (!n) return 0;
+    return 64 * n - __builtin_clzl(m->arr->arr[n - 1]);
+}
 
-padic_int mpint_to_padic(const mp_int* const);
-mp_int padic_to_mpint(const padic_int* const);
+bool mpint_fits_long(const mp_int* const m) {
+    if (m->arr->n > 1) return false;
+    if (!m->arr->n) return true;
+    uint64_t limb = m->arr->arr[0];
+    return limb <= (uint64_t) LONG_MAX || (m->sgn && limb == (uint64_t) LONG_MAX + 1);
+}
+
+long mpint_to_long(const mp_int* const m) {
+    assert(mpint_fits_long(m));
+    if (!m->arr->n) return 0;
+    uint64_t limb = m->arr->arr[0];
+    return m->sgn ? (long) (0 - limb) : (long) limb;
+}
+
+char* mpint_to_string(const mp_int* const m, size_t* len) {
+    size_t n = m->arr->n;
+    // peel off base 10^19 digits from a scratch copy, least significant first
+    uint64_t* t = malloc((n ? n : 1) * sizeof(uint64_t));
+    uint64_t* digits = malloc((2 * n + 1) * sizeof(uint64_t));
+    char* s = malloc(LIMB_DEC_DIGITS * (2 * n + 1) + 2);
+    if (!t || !digits || !s) {
+        perror("Could not allocate memory in mpint_to_string");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(t, m->arr->arr, n * sizeof(uint64_t));
+    size_t k = 0;
+    while (n) {
+        digits[k++] = divmod_1(t, t, n, LIMB_DEC_BASE);
+        while (n && !t[n - 1]) n--;
+    }
+    size_t pos = 0;
+    if (m->sgn) s[pos++] = '-';
+    pos += sprintf(s + pos, "%lu", k ? digits[--k] : 0UL);
+    while (k-- > 0) {
+        pos += sprintf(s + pos, "%019lu", digits[k]);
+    }
+    free(t);
+    free(digits);
+    if (len) *len = pos;
+    return s;
+}
+
+void mpint_display(const mp_int* const m) {
+    char* s = mpint_to_string(m, NULL);
+    printf("%s\n", s);
+    free(s);
+}
+
+int mpint_cmp(const mp_int* const m1, const mp_int* const m2) {
+    if (m1->sgn != m2->sgn) {
+        return m1->sgn ? -1 : 1;
+    }
+    int c = cmp_mag(m1->arr->arr, m1->arr->n, m2->arr->arr, m2->arr->n);
+    return m1->sgn ? -c : c;
+}
+
+bool mpint_lt(const mp_int* const m1, const mp_int* const m2) {
+    return mpint_cmp(m1, m2) < 0;
+}
+
+bool mpint_eq(const mp_int* const m1, const mp_int* const m2) {
+    return mpint_cmp(m1, m2) == 0;
+}
+
+bool mpint_lt_i(const mp_int* const m, const int i) {
+    MP_VIEW_LONG(t, (long) i);
+    return mpint_cmp(m, &t) < 0;
+}
+
+bool mpint_eq_i(const mp_int* const m, const int i) {
+    MP_VIEW_LONG(t, (long) i);
+    return mpint_cmp(m, &t) == 0;
+}
+
+bool mpint_nz(const mp_int* const m) {
+    return m->arr->n != 0;
+}
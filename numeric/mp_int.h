@@ -2,26 +2,71 @@
 #define _MP_INT_H_INCLUDED_
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
-/*multiprecision integer in base 10. */
+/*multiprecision integer, stored as a sign and a dynamic array of base 2^64 limbs, least significant first, with no
+ * leading zero limbs. Zero has no limbs and a positive sign. */
 struct mp_int;
 /*p-adic representation of an arbitrarily large integer. The modulus must be positive and less than 2^64. */
 struct padic_int;
 
 typedef struct mp_int mp_int;
 typedef struct padic_int padic_int;
+typedef struct darr darr;
+
+struct mp_int {
+    // true for negative, false for positive
+    bool sgn;
+    darr* arr;
+};
 
 /*Uses the provided string (\0 terminated) to initialize a mp_int. The string must have length at most 2^64-1 digits. */
 mp_int mpint_init(const char*);
+mp_int mpint_from_long(long);
+/*From len decimal digits, without a sign or a terminating \0. */
+mp_int mpint_from_digits(const char* digits, size_t len, bool negative);
+mp_int mpint_copy(const mp_int* const);
+/*Releases the limbs of the mp_int. Every mp_int returned by the functions below must be freed. */
+void mpint_free(mp_int*);
+/*A read-only mp_int over n existing limbs, least significant first with no leading zero limbs, for instance in a
+ * memory-mapped file. The limbs are not copied and must outlive the view; mpint_free releases only the header. */
+mp_int mpint_view(bool negative, const uint64_t* limbs, size_t n);
 
 mp_int mpint_add(const mp_int* const, const mp_int* const);
 mp_int mpint_sub(const mp_int* const, const mp_int* const);
 mp_int mpint_prod(const mp_int* const, const mp_int* const);
+/*Quotient of truncated division, rounding towards zero as in C. */
 mp_int mpint_div(const mp_int* const, const mp_int* const);
+/*Remainder of truncated division, with the sign of the dividend as in C. */
+mp_int mpint_mod(const mp_int* const, const mp_int* const);
+/*Both results of truncated division. Either output may be null. */
+void mpint_divmod(const mp_int* const, const mp_int* const, mp_int* quo, mp_int* rem);
+/*Raises the first argument to the second, which must be nonnegative and fit in a long. */
 mp_int mpint_pow(const mp_int* const, const mp_int* const);
 
+/*Nonnegative gcd, by Lehmer's algorithm: runs of Euclid steps are simulated on the leading bits of the operands and
+ * applied to the full numbers in one pass. */
+mp_int mpint_gcd(const mp_int* const, const mp_int* const);
+
+/*Number of limbs in the magnitude; 0 for zero. */
+size_t mpint_size(const mp_int* const);
+/*The limbs of the magnitude, least significant first. */
+const uint64_t* mpint_limbs(const mp_int* const);
+/*Number of bits in the magnitude; 0 for zero. */
+size_t mpint_bits(const mp_int* const);
+bool mpint_fits_long(const mp_int* const);
+/*Requires mpint_fits_long. */
+long mpint_to_long(const mp_int* const);
+
+/*The decimal digits, with a leading '-' if negative, in a \0 terminated string that the caller frees. If len is
+ * not null, it receives the length of the string. */
+char* mpint_to_string(const mp_int* const, size_t* len);
 void mpint_display(const mp_int* const);
 
+/* Returns a negative number, zero or a positive number as the first argument is less than, equal to or greater
+ * than the second. */
+int mpint_cmp(const mp_int* const, const mp_int* const);
 bool mpint_lt(const mp_int* const, const mp_int* const);
 bool mpint_eq(const mp_int* const, const mp_int* const);
 bool mpint_lt_i(const mp_int* const, const int);
@@ -40,4 +85,4 @@ void padic_display(const padic_int* const);
 padic_int mpint_to_padic(const mp_int* const);
 mp_int padic_to_mpint(const padic_int* const);
 
-#endif
\ No newline at end of file
+#endif
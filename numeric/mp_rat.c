@@ -0,0 +1,386 @@
+#include "./mp_rat.h"
+#include "./euclid.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include "../util/instrument.h"
+
+typedef __int128 int128_t;
+
+/* x = x * y. */
+static void mul_to(mp_int* x, const mp_int* const y) {
+    mp_int t = mpint_prod(x, y);
+    mpint_free(x);
+    *x = t;
+}
+
+/* x = x / y, exactly. */
+static void div_to(mp_int* x, const mp_int* const y) {
+    mp_int t = mpint_div(x, y);
+    mpint_free(x);
+    *x = t;
+}
+
+static bool is_one(const mp_int* const m) {
+    return mpint_eq_i(m, 1);
+}
+
+static size_t rat_size(const mp_rat* const r) {
+    return mpint_size(&r->num) + mpint_size(&r->den);
+}
+
+/* Reads a fraction whose parts both fit in a long. LONG_MIN is left to the general path, so that negating and
+ * taking magnitudes cannot overflow. */
+static bool small(const mp_rat* const r, long* num, long* den) {
+    if (!mpint_fits_long(&r->num) || !mpint_fits_long(&r->den)) return false;
+    *num = mpint_to_long(&r->num);
+    *den = mpint_to_long(&r->den);
+    return *num != LONG_MIN;
+}
+
+static bool fits(int128_t x) {
+    return x > LONG_MIN && x <= LONG_MAX;
+}
+
+/* num / den with den > 0, brought to lowest terms: the operands of the word-sized paths need not be reduced. */
+static mp_rat make_small(long num, long den) {
+    long g = gcd(num, den);
+    num /= g;
+    den /= g;
+    mp_rat r = {
+        .num = mpint_from_long(num),
+        .den = mpint_from_long(num ? den : 1),
+        .reduced = true
+    };
+    r.reduced_size = rat_size(&r);
+    return r;
+}
+
+/* Takes ownership of num and den and fixes the sign of den. */
+static mp_rat make(mp_int num, mp_int den, bool reduced) {
+    assert(mpint_nz(&den));
+    if (!mpint_nz(&num)) {
+        mpint_free(&den);
+        den = mpint_from_long(1);
+        reduced = true;
+    } else if (mpint_lt_i(&den, 0)) {
+        mp_int zero = mpint_from_long(0);
+        mp_int n = mpint_sub(&zero, &num);
+        mp_int d = mpint_sub(&zero, &den);
+        mpint_free(&zero);
+        mpint_free(&num);
+        mpint_free(&den);
+        num = n;
+        den = d;
+    }
+    mp_rat r = {.num = num, .den = den, .reduced = reduced};
+    r.reduced_size = reduced ? rat_size(&r) : 0;
+    return r;
+}
+
+void mprat_canonicalize(mp_rat* r) {
+    if (r->reduced) return;
+    mp_int g = mpint_gcd(&r->num, &r->den);
+    if (!is_one(&g)) {
+        div_to(&r->num, &g);
+        div_to(&r->den, &g);
+    }
+    mpint_free(&g);
+    r->reduced = true;
+    r->reduced_size = rat_size(r);
+}
+
+/* The lazy part of the reduction: only fractions that have grown enough pay for a gcd. */
+static void maybe_reduce(mp_rat* r) {
+    size_t size = rat_size(r);
+    if (!r->reduced && size > MPRAT_REDUCE_LIMBS && size > 2 * r->reduced_size) mprat_canonicalize(r);
+}
+
+mp_rat mprat_from_long(long num, long den) {
+    assert(den);
+    if (num != LONG_MIN && den != LONG_MIN) {
+        long g = gcd(num, den);
+        if (den < 0) g = -g;
+        return make_small(num / g, den / g);
+    }
+    return make(mpint_from_long(num), mpint_from_long(den), false);
+}
+
+mp_rat mprat_from_mpint(const mp_int* const num, const mp_int* const den) {
+    mp_rat r = make(mpint_copy(num), mpint_copy(den), false);
+    maybe_reduce(&r);
+    return r;
+}
+
+mp_rat mprat_copy(const mp_rat* const r) {
+    mp_rat out = *r;
+    out.num = mpint_copy(&r->num);
+    out.den = mpint_copy(&r->den);
+    return out;
+}
+
+void mprat_free(mp_rat* r) {
+    mpint_free(&r->num);
+    mpint_free(&r->den);
+}
+
+/* a + sign b. */
+static mp_rat add_signed(const mp_rat* const a, const mp_rat* const b, int sign) {
+    long n1, d1, n2, d2;
+    if (small(a, &n1, &d1) && small(b, &n2, &d2)) {
+        // Knuth's addition: only the gcd of the denominators and its gcd with the numerator are needed
+        long g = gcd(d1, d2);
+        int128_t t = (int128_t) n1 * (d2 / g) + (int128_t) sign * n2 * (d1 / g);
+        long g2 = gcd((long) (t % g), g);
+        int128_t num = t / g2;
+        int128_t den = (int128_t) (d1 / g) * (d2 / g2);
+        if (fits(num) && fits(den)) return make_small((long) num, (long) den);
+    }
+    mp_int num;
+    mp_int den;
+    if (mpint_eq(&a->den, &b->den)) {
+        num = sign > 0 ? mpint_add(&a->num, &b->num) : mpint_sub(&a->num, &b->num);
+        den = mpint_copy(&a->den);
+    } else {
+        mp_int x = mpint_prod(&a->num, &b->den);
+        mp_int y = mpint_prod(&b->num, &a->den);
+        num = sign > 0 ? mpint_add(&x, &y) : mpint_sub(&x, &y);
+        den = mpint_prod(&a->den, &b->den);
+        mpint_free(&x);
+        mpint_free(&y);
+    }
+    mp_rat r = make(num, den, false);
+    r.reduced_size = a->reduced_size > b->reduced_size ? a->reduced_size : b->reduced_size;
+    maybe_reduce(&r);
+    return r;
+}
+
+mp_rat mprat_add(const mp_rat* const a, const mp_rat* const b) {
+    return add_signed(a, b, 1);
+}
+
+mp_rat mprat_sub(const mp_rat* const a, const mp_rat* const b) {
+    return add_signed(a, b, -1);
+}
+
+mp_rat mprat_mul(const mp_rat* const a, const mp_rat* const b) {
+    long n1, d1, n2, d2;
+    if (small(a, &n1, &d1) && small(b, &n2, &d2)) {
+        // cancel across before multiplying, so that the products overflow less often
+        long g1 = gcd(n1, d2);
+        long g2 = gcd(n2, d1);
+        int128_t num = (int128_t) (n1 / g1) * (n2 / g2);
+        int128_t den = (int128_t) (d1 / g2) * (d2 / g1);
+        if (fits(num) && fits(den)) return make_small((long) num, (long) den);
+    }
+    mp_rat r = make(mpint_prod(&a->num, &b->num), mpint_prod(&a->den, &b->den), false);
+    r.reduced_size = a->reduced_size + b->reduced_size;
+    maybe_reduce(&r);
+    return r;
+}
+
+mp_rat mprat_neg(const mp_rat* const a) {
+    mp_int zero = mpint_from_long(0);
+    mp_rat r = *a;
+    r.num = mpint_sub(&zero, &a->num);
+    r.den = mpint_copy(&a->den);
+    mpint_free(&zero);
+    return r;
+}
+
+mp_rat mprat_inv(const mp_rat* const a) {
+    assert(mpint_nz(&a->num));
+    mp_rat r = make(mpint_copy(&a->den), mpint_copy(&a->num), a->reduced);
+    r.reduced_size = a->reduced_size;
+    return r;
+}
+
+mp_rat mprat_div(const mp_rat* const a, const mp_rat* const b) {
+    mp_rat inv = mprat_inv(b);
+    mp_rat r = mprat_mul(a, &inv);
+    mprat_free(&inv);
+    return r;
+}
+
+int mprat_cmp(mp_rat* a, mp_rat* b) {
+    mprat_canonicalize(a);
+    mprat_canonicalize(b);
+    long n1, d1, n2, d2;
+    if (small(a, &n1, &d1) && small(b, &n2, &d2)) {
+        int128_t x = (int128_t) n1 * d2;
+        int128_t y = (int128_t) n2 * d1;
+        return (x > y) - (x < y);
+    }
+    int sa = mprat_sgn(a);
+    int sb = mprat_sgn(b);
+    if (sa != sb) return sa < sb ? -1 : 1;
+    mp_int x = mpint_prod(&a->num, &b->den);
+    mp_int y = mpint_prod(&b->num, &a->den);
+    int c = mpint_cmp(&x, &y);
+    mpint_free(&x);
+    mpint_free(&y);
+    return c;
+}
+
+bool mprat_eq(mp_rat* a, mp_rat* b) {
+    mprat_canonicalize(a);
+    mprat_canonicalize(b);
+    return mpint_eq(&a->num, &b->num) && mpint_eq(&a->den, &b->den);
+}
+
+int mprat_sgn(const mp_rat* const r) {
+    return mpint_lt_i(&r->num, 0) ? -1 : mpint_nz(&r->num);
+}
+
+bool mprat_is_int(mp_rat* r) {
+    mprat_canonicalize(r);
+    return is_one(&r->den);
+}
+
+char* mprat_to_string(mp_rat* r, size_t* len) {
+    mprat_canonicalize(r);
+    size_t nlen, dlen;
+    char* num = mpint_to_string(&r->num, &nlen);
+    if (is_one(&r->den)) {
+        if (len) *len = nlen;
+        return num;
+    }
+    char* den = mpint_to_string(&r->den, &dlen);
+    char* s = realloc(num, nlen + dlen + 2);
+    if (!s) {
+        perror("Could not allocate memory in mprat_to_string");
+        exit(EXIT_FAILURE);
+    }
+    s[nlen] = '/';
+    memcpy(s + nlen + 1, den, dlen + 1);
+    free(den);
+    if (len) *len = nlen + dlen + 1;
+    return s;
+}
+
+void mprat_display(mp_rat* r) {
+    char* s = mprat_to_string(r, NULL);
+    printf("%s\n", s);
+    free(s);
+}
+
+mprat_vec mprat_vec_zero(size_t n) {
+    mprat_vec v = {
+        .n = n,
+        .nums = malloc((n ? n : 1) * sizeof(mp_int)),
+        .den = mpint_from_long(1)
+    };
+    if (!v.nums) {
+        perror("Could not allocate memory in mprat_vec_zero");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < n; i++) v.nums[i] = mpint_from_long(0);
+    return v;
+}
+
+mprat_vec mprat_vec_copy(const mprat_vec* const v) {
+    mprat_vec out = {
+        .n = v->n,
+        .nums = malloc((v->n ? v->n : 1) * sizeof(mp_int)),
+        .den = mpint_copy(&v->den)
+    };
+    if (!out.nums) {
+        perror("Could not allocate memory in mprat_vec_copy");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < v->n; i++) out.nums[i] = mpint_copy(&v->nums[i]);
+    return out;
+}
+
+void mprat_vec_free(mprat_vec* v) {
+    for (size_t i = 0; i < v->n; i++) mpint_free(&v->nums[i]);
+    free(v->nums);
+    mpint_free(&v->den);
+}
+
+mp_rat mprat_vec_get(const mprat_vec* const v, size_t i) {
+    assert(i < v->n);
+    return mprat_from_mpint(&v->nums[i], &v->den);
+}
+
+void mprat_vec_set(mprat_vec* v, size_t i, const mp_rat* const r) {
+    assert(i < v->n);
+    // over lcm(den, r.den) = den (r.den / g), entry j gets the factor r.den / g and entry i the factor den / g
+    mp_int g = mpint_gcd(&v->den, &r->den);
+    mp_int fv = mpint_div(&r->den, &g);
+    mp_int fr = mpint_div(&v->den, &g);
+    if (!is_one(&fv)) {
+        for (size_t j = 0; j < v->n; j++) {
+            if (j != i && mpint_nz(&v->nums[j])) mul_to(&v->nums[j], &fv);
+        }
+        mul_to(&v->den, &fv);
+    }
+    mpint_free(&v->nums[i]);
+    v->nums[i] = mpint_prod(&r->num, &fr);
+    mpint_free(&g);
+    mpint_free(&fv);
+    mpint_free(&fr);
+}
+
+void mprat_vec_scale(mprat_vec* v, const mp_rat* const c) {
+    if (!mprat_sgn(c)) {
+        for (size_t i = 0; i < v->n; i++) {
+            mpint_free(&v->nums[i]);
+            v->nums[i] = mpint_from_long(0);
+        }
+        mpint_free(&v->den);
+        v->den = mpint_from_long(1);
+        return;
+    }
+    if (!is_one(&c->num)) {
+        for (size_t i = 0; i < v->n; i++) {
+            if (mpint_nz(&v->nums[i])) mul_to(&v->nums[i], &c->num);
+        }
+    }
+    if (!is_one(&c->den)) mul_to(&v->den, &c->den);
+}
+
+void mprat_vec_axpy(mprat_vec* v, const mp_rat* const c, const mprat_vec* const w) {
+    assert(v->n == w->n);
+    if (!mprat_sgn(c)) return;
+    // v + c w = (v.nums (d / g) + c.num w.nums (v.den / g)) / (v.den d / g) with d = c.den w.den
+    mp_int d = mpint_prod(&c->den, &w->den);
+    mp_int g = mpint_gcd(&v->den, &d);
+    mp_int fv = mpint_div(&d, &g);
+    mp_int fw = mpint_div(&v->den, &g);
+    mul_to(&fw, &c->num);
+    bool scale_v = !is_one(&fv);
+    for (size_t i = 0; i < v->n; i++) {
+        if (scale_v && mpint_nz(&v->nums[i])) mul_to(&v->nums[i], &fv);
+        if (!mpint_nz(&w->nums[i])) continue;
+        mp_int t = mpint_prod(&w->nums[i], &fw);
+        mp_int s = mpint_add(&v->nums[i], &t);
+        mpint_free(&v->nums[i]);
+        mpint_free(&t);
+        v->nums[i] = s;
+    }
+    if (scale_v) mul_to(&v->den, &fv);
+    mpint_free(&d);
+    mpint_free(&g);
+    mpint_free(&fv);
+    mpint_free(&fw);
+}
+
+void mprat_vec_canonicalize(mprat_vec* v) {
+    mp_int g = mpint_copy(&v->den);
+    for (size_t i = 0; i < v->n && !is_one(&g); i++) {
+        if (!mpint_nz(&v->nums[i])) continue;
+        mp_int t = mpint_gcd(&g, &v->nums[i]);
+        mpint_free(&g);
+        g = t;
+    }
+    if (!is_one(&g)) {
+        for (size_t i = 0; i < v->n; i++) {
+            if (mpint_nz(&v->nums[i])) div_to(&v->nums[i], &g);
+        }
+        div_to(&v->den, &g);
+    }
+    mpint_free(&g);
+}
@@ -0,0 +1,81 @@
+#ifndef _MP_RAT_H_INCLUDED_
+#define _MP_RAT_H_INCLUDED_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "./mp_int.h"
+
+/* Reduction is postponed until the numerator and denominator together are longer than this many limbs, and then
+ * until they have doubled in size since the last reduction. */
+#define MPRAT_REDUCE_LIMBS 8
+
+/* Exact rational number num / den with den > 0. The fraction need not be in lowest terms: sums and products are
+ * reduced lazily, when they grow past MPRAT_REDUCE_LIMBS, and always before they are compared or printed. Zero is
+ * 0 / 1. When the operands of an operation fit in a long, the result is computed in machine words and is always
+ * reduced. */
+typedef struct mp_rat mp_rat;
+
+struct mp_rat {
+    mp_int num;
+    mp_int den;
+    // num and den are known to be coprime
+    bool reduced;
+    // limbs of num and den at the last reduction
+    size_t reduced_size;
+};
+
+mp_rat mprat_from_long(long num, long den);
+/* Copies num and den; den must not be zero. */
+mp_rat mprat_from_mpint(const mp_int* const num, const mp_int* const den);
+mp_rat mprat_copy(const mp_rat* const);
+void mprat_free(mp_rat*);
+
+mp_rat mprat_add(const mp_rat* const, const mp_rat* const);
+mp_rat mprat_sub(const mp_rat* const, const mp_rat* const);
+mp_rat mprat_mul(const mp_rat* const, const mp_rat* const);
+/* The divisor must not be zero. */
+mp_rat mprat_div(const mp_rat* const, const mp_rat* const);
+mp_rat mprat_neg(const mp_rat* const);
+/* The argument must not be zero. */
+mp_rat mprat_inv(const mp_rat* const);
+
+/* Brings the fraction to lowest terms. */
+void mprat_canonicalize(mp_rat*);
+
+/* Comparisons canonicalize their arguments first. */
+int mprat_cmp(mp_rat*, mp_rat*);
+bool mprat_eq(mp_rat*, mp_rat*);
+/* -1, 0 or 1. */
+int mprat_sgn(const mp_rat* const);
+bool mprat_is_int(mp_rat*);
+
+/* "num/den" in lowest terms, or "num" for an integer, in a \0 terminated string that the caller frees. */
+char* mprat_to_string(mp_rat*, size_t* len);
+void mprat_display(mp_rat*);
+
+/* A vector of rationals over a single positive denominator, as for the rows of a fraction-free elimination. Entry i
+ * is nums[i] / den. */
+typedef struct mprat_vec mprat_vec;
+
+struct mprat_vec {
+    size_t n;
+    mp_int* nums;
+    mp_int den;
+};
+
+/* n zeros over the denominator 1. */
+mprat_vec mprat_vec_zero(size_t n);
+mprat_vec mprat_vec_copy(const mprat_vec* const);
+void mprat_vec_free(mprat_vec*);
+
+mp_rat mprat_vec_get(const mprat_vec* const, size_t i);
+/* Sets entry i, bringing the whole vector over the lcm of the denominators. */
+void mprat_vec_set(mprat_vec*, size_t i, const mp_rat* const);
+/* v *= c. */
+void mprat_vec_scale(mprat_vec* v, const mp_rat* const c);
+/* v += c w, the row operation of Gaussian elimination. The vectors must have the same length. */
+void mprat_vec_axpy(mprat_vec* v, const mp_rat* const c, const mprat_vec* const w);
+/* Divides the numerators and the denominator by their common gcd. */
+void mprat_vec_canonicalize(mprat_vec*);
+
+#endif
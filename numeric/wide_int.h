@@ -0,0 +1,285 @@
+/** Fixed-width integers of 128, 256 and 512 bits, for values that outgrow a long by a few words but do not need
+ * the allocations of mp_int. The 128-bit types are the compiler's __int128. The wider ones are arrays of 64-bit
+ * words, least significant first, in two's complement for the signed types. Every function is inline over a
+ * constant number of words, so the compiler unrolls the loops for each width. Arithmetic wraps around and reports
+ * overflow through its return value. */
+#ifndef _WIDE_INT_H_INCLUDED_
+#define _WIDE_INT_H_INCLUDED_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned __int128 u128;
+typedef __int128 i128;
+
+typedef struct u256 u256;
+typedef struct i256 i256;
+typedef struct u512 u512;
+typedef struct i512 i512;
+
+struct u256 {
+    uint64_t w[4];
+};
+
+struct i256 {
+    uint64_t w[4];
+};
+
+struct u512 {
+    uint64_t w[8];
+};
+
+struct i512 {
+    uint64_t w[8];
+};
+
+/* ---------------- word arrays of n words ---------------- */
+
+static inline void wide_set_i64(uint64_t* r, size_t n, int64_t a) {
+    r[0] = (uint64_t) a;
+    for (size_t i = 1; i < n; i++) r[i] = a < 0 ? UINT64_MAX : 0;
+}
+
+/* r = a + b, returning the carry out of the top word. */
+static inline bool wide_add(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    bool c = 0;
+    for (size_t i = 0; i < n; i++) {
+        u128 s = (u128) a[i] + b[i] + c;
+        r[i] = (uint64_t) s;
+        c = s >> 64;
+    }
+    return c;
+}
+
+/* r = a - b, returning the borrow out of the top word. */
+static inline bool wide_sub(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    bool c = 0;
+    for (size_t i = 0; i < n; i++) {
+        u128 d = (u128) a[i] - b[i] - c;
+        r[i] = (uint64_t) d;
+        c = (d >> 64) != 0;
+    }
+    return c;
+}
+
+static inline void wide_neg(uint64_t* r, const uint64_t* a, size_t n) {
+    bool c = 1;
+    for (size_t i = 0; i < n; i++) {
+        u128 s = (u128) ~a[i] + c;
+        r[i] = (uint64_t) s;
+        c = s >> 64;
+    }
+}
+
+static inline bool wide_is_zero(const uint64_t* a, size_t n) {
+    uint64_t x = 0;
+    for (size_t i = 0; i < n; i++) x |= a[i];
+    return !x;
+}
+
+static inline int wide_cmp(const uint64_t* a, const uint64_t* b, size_t n) {
+    for (size_t i = n; i-- > 0;) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+/* r = a b mod 2^(64 n), returning true if the full product does not fit. r must not alias a or b. */
+static inline bool wide_mul(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    bool over = 0;
+    for (size_t i = 0; i < n; i++) r[i] = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t c = 0;
+        for (size_t j = 0; i + j < n; j++) {
+            u128 t = (u128) a[i] * b[j] + r[i + j] + c;
+            r[i + j] = (uint64_t) t;
+            c = t >> 64;
+        }
+        // the words of the product above the top word
+        if (c) over = 1;
+        for (size_t j = n - i; j < n && !over; j++) over = a[i] && b[j];
+    }
+    return over;
+}
+
+/* Number of significant bits. */
+static inline size_t wide_bits(const uint64_t* a, size_t n) {
+    for (size_t i = n; i-- > 0;) {
+        if (a[i]) return 64 * i + 64 - __builtin_clzl(a[i]);
+    }
+    return 0;
+}
+
+static inline void wide_shl1(uint64_t* a, size_t n, bool in) {
+    for (size_t i = 0; i < n; i++) {
+        bool out = a[i] >> 63;
+        a[i] = (a[i] << 1) | in;
+        in = out;
+    }
+}
+
+/* Unsigned division with remainder; b must not be zero. q and r must not alias a or b. */
+static inline void wide_divmod(uint64_t* q, uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    for (size_t i = 0; i < n; i++) q[i] = r[i] = 0;
+    if (wide_bits(b, n) <= 64) {
+        // one-word divisor: a run of 128 by 64 divisions, most significant word first
+        uint64_t rem = 0;
+        for (size_t i = n; i-- > 0;) {
+            u128 cur = ((u128) rem << 64) | a[i];
+            q[i] = (uint64_t) (cur / b[0]);
+            rem = (uint64_t) (cur % b[0]);
+        }
+        r[0] = rem;
+        return;
+    }
+    // restoring division, one bit of the quotient per step from the top bit of a
+    for (size_t k = wide_bits(a, n); k-- > 0;) {
+        wide_shl1(r, n, (a[k / 64] >> (k % 64)) & 1);
+        if (wide_cmp(r, b, n) >= 0) {
+            wide_sub(r, r, b, n);
+            q[k / 64] |= (uint64_t) 1 << (k % 64);
+        }
+    }
+}
+
+static inline bool wide_is_neg(const uint64_t* a, size_t n) {
+    return a[n - 1] >> 63;
+}
+
+/* Signed r = a b, returning true on overflow. r must not alias a or b. */
+static inline bool wide_mul_signed(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    uint64_t ma[n], mb[n];
+    bool na = wide_is_neg(a, n), nb = wide_is_neg(b, n);
+    if (na) wide_neg(ma, a, n); else for (size_t i = 0; i < n; i++) ma[i] = a[i];
+    if (nb) wide_neg(mb, b, n); else for (size_t i = 0; i < n; i++) mb[i] = b[i];
+    bool over = wide_mul(r, ma, mb, n);
+    if (na != nb) {
+        // -2^(64 n - 1) is the one magnitude with the top bit set that still fits
+        uint64_t top = r[n - 1];
+        wide_neg(r, r, n);
+        return over || ((top >> 63) && (top != (uint64_t) 1 << 63 || !wide_is_zero(r, n - 1)));
+    }
+    return over || wide_is_neg(r, n);
+}
+
+/* Signed r = a + b, returning true on overflow. */
+static inline bool wide_add_signed(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    bool na = wide_is_neg(a, n), nb = wide_is_neg(b, n);
+    wide_add(r, a, b, n);
+    return na == nb && wide_is_neg(r, n) != na;
+}
+
+/* Signed r = a - b, returning true on overflow. */
+static inline bool wide_sub_signed(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    bool na = wide_is_neg(a, n), nb = wide_is_neg(b, n);
+    wide_sub(r, a, b, n);
+    return na != nb && wide_is_neg(r, n) != na;
+}
+
+/* Truncated signed division, as in C; b must not be zero. */
+static inline void wide_divmod_signed(uint64_t* q, uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+    uint64_t ma[n], mb[n];
+    bool na = wide_is_neg(a, n), nb = wide_is_neg(b, n);
+    if (na) wide_neg(ma, a, n); else for (size_t i = 0; i < n; i++) ma[i] = a[i];
+    if (nb) wide_neg(mb, b, n); else for (size_t i = 0; i < n; i++) mb[i] = b[i];
+    wide_divmod(q, r, ma, mb, n);
+    if (na != nb) wide_neg(q, q, n);
+    if (na) wide_neg(r, r, n);
+}
+
+/* Whether a sign-extends from its low word. */
+static inline bool wide_fits_i64(const uint64_t* a, size_t n) {
+    uint64_t ext = (int64_t) a[0] < 0 ? UINT64_MAX : 0;
+    for (size_t i = 1; i < n; i++) {
+        if (a[i] != ext) return false;
+    }
+    return true;
+}
+
+/* ---------------- typed wrappers ---------------- */
+
+static inline u256 u256_from_u128(u128 a) {
+    return (u256){{(uint64_t) a, (uint64_t) (a >> 64), 0, 0}};
+}
+
+static inline i256 i256_from_i128(i128 a) {
+    uint64_t ext = a < 0 ? UINT64_MAX : 0;
+    return (i256){{(uint64_t) a, (uint64_t) ((u128) a >> 64), ext, ext}};
+}
+
+static inline i256 i256_from_i64(int64_t a) {
+    i256 r;
+    wide_set_i64(r.w, 4, a);
+    return r;
+}
+
+static inline u512 u512_from_u256(u256 a) {
+    u512 r = {{0}};
+    for (size_t i = 0; i < 4; i++) r.w[i] = a.w[i];
+    return r;
+}
+
+static inline i512 i512_from_i256(i256 a) {
+    i512 r;
+    uint64_t ext = wide_is_neg(a.w, 4) ? UINT64_MAX : 0;
+    for (size_t i = 0; i < 8; i++) r.w[i] = i < 4 ? a.w[i] : ext;
+    return r;
+}
+
+static inline i512 i512_from_i64(int64_t a) {
+    i512 r;
+    wide_set_i64(r.w, 8, a);
+    return r;
+}
+
+/* Addition, subtraction and multiplication return true on overflow, leaving the wrapped result in *r. */
+static inline bool u256_add(u256* r, u256 a, u256 b) { return wide_add(r->w, a.w, b.w, 4); }
+static inline bool u256_sub(u256* r, u256 a, u256 b) { return wide_sub(r->w, a.w, b.w, 4); }
+static inline bool u256_mul(u256* r, u256 a, u256 b) { return wide_mul(r->w, a.w, b.w, 4); }
+static inline void u256_divmod(u256 a, u256 b, u256* q, u256* r) { wide_divmod(q->w, r->w, a.w, b.w, 4); }
+static inline int u256_cmp(u256 a, u256 b) { return wide_cmp(a.w, b.w, 4); }
+
+static inline bool u512_add(u512* r, u512 a, u512 b) { return wide_add(r->w, a.w, b.w, 8); }
+static inline bool u512_sub(u512* r, u512 a, u512 b) { return wide_sub(r->w, a.w, b.w, 8); }
+static inline bool u512_mul(u512* r, u512 a, u512 b) { return wide_mul(r->w, a.w, b.w, 8); }
+static inline void u512_divmod(u512 a, u512 b, u512* q, u512* r) { wide_divmod(q->w, r->w, a.w, b.w, 8); }
+static inline int u512_cmp(u512 a, u512 b) { return wide_cmp(a.w, b.w, 8); }
+
+static inline bool i256_add(i256* r, i256 a, i256 b) { return wide_add_signed(r->w, a.w, b.w, 4); }
+static inline bool i256_sub(i256* r, i256 a, i256 b) { return wide_sub_signed(r->w, a.w, b.w, 4); }
+static inline bool i256_mul(i256* r, i256 a, i256 b) { return wide_mul_signed(r->w, a.w, b.w, 4); }
+static inline void i256_divmod(i256 a, i256 b, i256* q, i256* r) { wide_divmod_signed(q->w, r->w, a.w, b.w, 4); }
+static inline bool i256_is_neg(i256 a) { return wide_is_neg(a.w, 4); }
+static inline bool i256_fits_i64(i256 a) { return wide_fits_i64(a.w, 4); }
+
+static inline i256 i256_neg(i256 a) {
+    i256 r;
+    wide_neg(r.w, a.w, 4);
+    return r;
+}
+
+static inline int i256_cmp(i256 a, i256 b) {
+    bool na = i256_is_neg(a), nb = i256_is_neg(b);
+    return na != nb ? (na ? -1 : 1) : wide_cmp(a.w, b.w, 4);
+}
+
+static inline bool i512_add(i512* r, i512 a, i512 b) { return wide_add_signed(r->w, a.w, b.w, 8); }
+static inline bool i512_sub(i512* r, i512 a, i512 b) { return wide_sub_signed(r->w, a.w, b.w, 8); }
+static inline bool i512_mul(i512* r, i512 a, i512 b) { return wide_mul_signed(r->w, a.w, b.w, 8); }
+static inline void i512_divmod(i512 a, i512 b, i512* q, i512* r) { wide_divmod_signed(q->w, r->w, a.w, b.w, 8); }
+static inline bool i512_is_neg(i512 a) { return wide_is_neg(a.w, 8); }
+static inline bool i512_fits_i64(i512 a) { return wide_fits_i64(a.w, 8); }
+
+static inline i512 i512_neg(i512 a) {
+    i512 r;
+    wide_neg(r.w, a.w, 8);
+    return r;
+}
+
+static inline int i512_cmp(i512 a, i512 b) {
+    bool na = i512_is_neg(a), nb = i512_is_neg(b);
+    return na != nb ? (na ? -1 : 1) : wide_cmp(a.w, b.w, 8);
+}
+
+#endif
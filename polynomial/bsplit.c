@@ -0,0 +1,211 @@
+#include "./bsplit.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "stdatomic.h"
+#include "limits.h"
+#include "../util/instrument.h"
+
+typedef struct bs_triple bs_triple;
+
+/* The products P, Q and the numerator T of a range (see bsplit.h). */
+struct bs_triple {
+    mp_int p;
+    mp_int q;
+    mp_int t;
+};
+
+typedef struct bs_ctx bs_ctx;
+
+struct bs_ctx {
+    const sum* a;
+    const sum* b;
+    // the last k of the range
+    long last;
+    // set when b vanishes somewhere in the range
+    atomic_bool singular;
+};
+
+/* acc * x^e, freeing acc. */
+static mp_int mul_pow(mp_int acc, const mp_int* const x, int e) {
+    if (!e) return acc;
+    mp_int pe = mpint_from_long(e);
+    mp_int xe = mpint_pow(x, &pe);
+    mp_int out = mpint_prod(&acc, &xe);
+    mpint_free(&pe);
+    mpint_free(&xe);
+    mpint_free(&acc);
+    return out;
+}
+
+int mpint_eval_sum(const sum* const p, long k, mp_int* out) {
+    if (p->n && p->terms[p->n - 1].exp < 0) return -1;
+    mp_int acc = mpint_from_long(0);
+    if (!p->n) {
+        *out = acc;
+        return 0;
+    }
+    mp_int x = mpint_from_long(k);
+    // Horner's rule over the nonzero terms, jumping over the gaps between exponents
+    int prev = p->terms[0].exp;
+    for (size_t i = 0; i < p->n; i++) {
+        acc = mul_pow(acc, &x, prev - p->terms[i].exp);
+        mp_int c = mpint_from_long(p->terms[i].coeff);
+        mp_int next = mpint_add(&acc, &c);
+        mpint_free(&c);
+        mpint_free(&acc);
+        acc = next;
+        prev = p->terms[i].exp;
+    }
+    *out = mul_pow(acc, &x, prev);
+    mpint_free(&x);
+    return 0;
+}
+
+/* Combines the triples of two adjacent ranges, left first, into out and frees them. */
+static void combine(bs_triple* l, bs_triple* r, bs_triple* out) {
+    mp_int t1q2 = mpint_prod(&l->t, &r->q);
+    mp_int p1t2 = mpint_prod(&l->p, &r->t);
+    bs_triple c = {
+        .p = mpint_prod(&l->p, &r->p),
+        .q = mpint_prod(&l->q, &r->q),
+        .t = mpint_add(&t1q2, &p1t2)
+    };
+    mpint_free(&t1q2);
+    mpint_free(&p1t2);
+    mpint_free(&l->p);
+    mpint_free(&l->q);
+    mpint_free(&l->t);
+    mpint_free(&r->p);
+    mpint_free(&r->q);
+    mpint_free(&r->t);
+    *out = c;
+}
+
+/* The triple of [lo, hi), which must not be empty. */
+static void bs_range(bs_ctx* ctx, long lo, long hi, bs_triple* out) {
+    if (hi - lo == 1) {
+        if (lo == ctx->last) {
+            // the ratio at the last k leads past the range, so a(last) and b(last) do not enter the sum
+            out->p = mpint_from_long(1);
+            out->q = mpint_from_long(1);
+            out->t = mpint_from_long(1);
+            return;
+        }
+        // bsplit_sum checked the exponents
+        mpint_eval_sum(ctx->a, lo, &out->p);
+        mpint_eval_sum(ctx->b, lo, &out->q);
+        out->t = mpint_copy(&out->q);
+        if (!mpint_nz(&out->q)) atomic_store_explicit(&ctx->singular, true, memory_order_relaxed);
+        return;
+    }
+    long mid = lo + (hi - lo) / 2;
+    bs_triple l, r;
+    bs_range(ctx, lo, mid, &l);
+    bs_range(ctx, mid, hi, &r);
+    combine(&l, &r, out);
+}
+
+typedef struct bs_task bs_task;
+
+struct bs_task {
+    bs_ctx* ctx;
+    long lo;
+    long hi;
+    bs_triple out;
+};
+
+static void range_task(void* arg) {
+    bs_task* t = arg;
+    bs_range(t->ctx, t->lo, t->hi, &t->out);
+}
+
+typedef struct bs_merge bs_merge;
+
+struct bs_merge {
+    bs_triple* left;
+    bs_triple* right;
+};
+
+static void merge_task(void* arg) {
+    bs_merge* m = arg;
+    combine(m->left, m->right, m->left);
+}
+
+int bsplit_sum(tpool* pool, const sum* const a, const sum* const b, long start, size_t count, mp_int* num,
+               mp_int* den) {
+    if ((a->n && a->terms[a->n - 1].exp < 0) || (b->n && b->terms[b->n - 1].exp < 0)) return -1;
+    // start + count must be a long
+    if (count > (size_t) LONG_MAX || start > LONG_MAX - (long) count) return -1;
+    if (!count) {
+        *num = mpint_from_long(0);
+        *den = mpint_from_long(1);
+        return 0;
+    }
+    long end = start + (long) count;
+    bs_ctx ctx = {.a = a, .b = b, .last = end - 1};
+    atomic_init(&ctx.singular, false);
+
+    size_t ntasks = pool ? tpool_size(pool) * BSPLIT_TASKS_PER_THREAD : 1;
+    if (ntasks > count / BSPLIT_MIN_TASK) ntasks = count / BSPLIT_MIN_TASK;
+    bs_triple all;
+    if (ntasks <= 1) {
+        bs_range(&ctx, start, end, &all);
+    } else {
+        bs_task* tasks = malloc(ntasks * sizeof(bs_task));
+        bs_merge* merges = malloc(ntasks * sizeof(bs_merge));
+        if (!tasks || !merges) {
+            perror("Could not allocate memory in bsplit_sum");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < ntasks; i++) {
+            tasks[i] = (bs_task){
+                .ctx = &ctx,
+                .lo = start + (long) (count * i / ntasks),
+                .hi = start + (long) (count * (i + 1) / ntasks)
+            };
+            tpool_submit(pool, range_task, &tasks[i]);
+        }
+        tpool_wait(pool);
+        // merge neighbouring ranges in rounds, so that the operands of each round stay balanced
+        for (size_t width = 1; width < ntasks; width *= 2) {
+            size_t nmerges = 0;
+            for (size_t i = 0; i + width < ntasks; i += 2 * width) {
+                merges[nmerges] = (bs_merge){.left = &tasks[i].out, .right = &tasks[i + width].out};
+                tpool_submit(pool, merge_task, &merges[nmerges]);
+                nmerges++;
+            }
+            tpool_wait(pool);
+        }
+        all = tasks[0].out;
+        free(tasks);
+        free(merges);
+    }
+    mpint_free(&all.p);
+
+    if (atomic_load(&ctx.singular)) {
+        mpint_free(&all.q);
+        mpint_free(&all.t);
+        return -1;
+    }
+    // the sum is T / Q
+    mp_int g = mpint_gcd(&all.t, &all.q);
+    mp_int n = mpint_div(&all.t, &g);
+    mp_int d = mpint_div(&all.q, &g);
+    mpint_free(&g);
+    mpint_free(&all.t);
+    mpint_free(&all.q);
+    if (mpint_lt_i(&d, 0)) {
+        mp_int zero = mpint_from_long(0);
+        mp_int nn = mpint_sub(&zero, &n);
+        mp_int nd = mpint_sub(&zero, &d);
+        mpint_free(&n);
+        mpint_free(&d);
+        mpint_free(&zero);
+        n = nn;
+        d = nd;
+    }
+    *num = n;
+    *den = d;
+    return 0;
+}
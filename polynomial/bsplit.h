@@ -0,0 +1,37 @@
+/** Exact partial sums of hypergeometric series by binary splitting. For a term ratio t(k+1) / t(k) = a(k) / b(k)
+ * with polynomials a and b, the sum of t(k) / t(start) over start <= k < end = start + count is built from the
+ * products
+ *     P = a(start) ... a(end - 2),  Q = b(start) ... b(end - 2)
+ * and a numerator T, computed for the two halves of the range and combined as
+ *     P = P1 P2,  Q = Q1 Q2,  T = T1 Q2 + P1 T2.
+ * The last ratio, a(end - 1) / b(end - 1), would only lead to t(end), so it is left out. The multiplications have
+ * balanced operands, so the whole sum costs a few multiplications of the size of the result instead of count
+ * additions of growing numbers. They are schoolbook products of mp_ints, though, so the cost is still quadratic in
+ * the size of the result. */
+#ifndef BSPLIT_H_INCLUDED
+#define BSPLIT_H_INCLUDED
+
+#include <stddef.h>
+#include "./sum.h"
+#include "../numeric/mp_int.h"
+#include "../util/thread_pool.h"
+
+/* Ranges shorter than this are not split into tasks of their own. */
+#define BSPLIT_MIN_TASK 256
+
+/* Number of tasks created per thread. */
+#define BSPLIT_TASKS_PER_THREAD 4
+
+/* Computes num / den = sum over start <= k < start + count of t(k) / t(start), where t(k+1) / t(k) = a(k) / b(k),
+ * in lowest terms with den > 0. The polynomials are evaluated exactly, so their values may exceed a long. With a
+ * pool, the range is split into tasks whose results are combined in a fixed order. Returns 0 on success and -1,
+ * leaving num and den untouched, if b vanishes at some start <= k < start + count - 1, if a or b has a negative
+ * exponent or if start + count does not fit in a long. */
+int bsplit_sum(tpool* pool, const sum* const a, const sum* const b, long start, size_t count, mp_int* num,
+               mp_int* den);
+
+/* The value of p at k, computed exactly, into out. Returns 0 on success and -1, leaving out untouched, if p has a
+ * negative exponent, whose value need not be an integer. */
+int mpint_eval_sum(const sum* const p, long k, mp_int* out);
+
+#endif
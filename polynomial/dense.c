@@ -0,0 +1,146 @@
+#include "./dense.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "stdint.h"
+#include "string.h"
+#include "../util/instrument.h"
+
+long* dense_from_sum(const sum* const p, size_t* len) {
+    *len = (size_t) deg(p) + 1;
+    long* c = calloc(*len, sizeof(long));
+    if (!c) {
+        perror("Could not allocate memory in dense_from_sum");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < p->n; i++) {
+        c[p->terms[i].exp] = p->terms[i].coeff;
+    }
+    return c;
+}
+
+sum dense_to_sum(const long* const c, size_t len) {
+    size_t k = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (c[i]) k++;
+    }
+    if (!k) {
+        return zero_polynomial();
+    }
+    sum g = {
+        .n = k,
+        .terms = malloc(k * sizeof(term))
+    };
+    if (!g.terms) {
+        perror("Could not allocate memory in dense_to_sum");
+        exit(EXIT_FAILURE);
+    }
+    k = 0;
+    for (size_t i = len; i-- > 0;) {
+        if (c[i]) {
+            g.terms[k].exp = (int) i;
+            g.terms[k].coeff = c[i];
+            k++;
+        }
+    }
+    return g;
+}
+
+int is_dense(const sum* const p) {
+    if (!p->n) {
+        return 0;
+    }
+    long span = (long) p->terms[0].exp - p->terms[p->n - 1].exp + 1;
+    return 4 * (long) p->n >= span;
+}
+
+/* out += a * b, all arithmetic modulo 2^64. */
+static void schoolbook_addmul(const long* a, size_t na, const long* b, size_t nb, long* out) {
+    for (size_t i = 0; i < na; i++) {
+        uint64_t ai = (uint64_t) a[i];
+        if (!ai) continue;
+        for (size_t j = 0; j < nb; j++) {
+            out[i + j] = (long) ((uint64_t) out[i + j] + ai * (uint64_t) b[j]);
+        }
+    }
+}
+
+static void add_to(long* out, const long* a, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (long) ((uint64_t) out[i] + (uint64_t) a[i]);
+    }
+}
+
+static void sub_from(long* out, const long* a, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (long) ((uint64_t) out[i] - (uint64_t) a[i]);
+    }
+}
+
+/* out[0 .. 2n-2] = a * b for operands of equal length n. */
+static void karatsuba(const long* a, const long* b, size_t n, long* out) {
+    if (n < KARATSUBA_THRESHOLD) {
+        memset(out, 0, (2 * n - 1) * sizeof(long));
+        schoolbook_addmul(a, n, b, n, out);
+        return;
+    }
+    // a = a0 + x^l a1, with a0 of length l and a1 of length h <= l
+    size_t h = n / 2;
+    size_t l = n - h;
+
+    long* buf = malloc((6 * l) * sizeof(long));
+    if (!buf) {
+        perror("Could not allocate memory in karatsuba");
+        exit(EXIT_FAILURE);
+    }
+    long* sa = buf;
+    long* sb = buf + l;
+    long* z1 = buf + 2 * l;
+    long* z2 = buf + 4 * l;
+
+    memcpy(sa, a, l * sizeof(long));
+    memcpy(sb, b, l * sizeof(long));
+    add_to(sa, a + l, h);
+    add_to(sb, b + l, h);
+
+    memset(out, 0, (2 * n - 1) * sizeof(long));
+    karatsuba(a, b, l, out);
+    karatsuba(a + l, b + l, h, z2);
+    karatsuba(sa, sb, l, z1);
+
+    // z1 = (a0 + a1)(b0 + b1) - a0 b0 - a1 b1
+    sub_from(z1, out, 2 * l - 1);
+    sub_from(z1, z2, 2 * h - 1);
+
+    memcpy(out + 2 * l, z2, (2 * h - 1) * sizeof(long));
+    add_to(out + l, z1, 2 * l - 1);
+    free(buf);
+}
+
+void dense_mul(const long* const a, size_t na, const long* const b, size_t nb, long* out) {
+    if (na < nb) {
+        dense_mul(b, nb, a, na, out);
+        return;
+    }
+    memset(out, 0, (na + nb - 1) * sizeof(long));
+    if (nb < KARATSUBA_THRESHOLD) {
+        schoolbook_addmul(a, na, b, nb, out);
+        return;
+    }
+    // split the longer operand into pieces the length of the shorter one
+    long* piece = malloc((2 * nb - 1) * sizeof(long));
+    if (!piece) {
+        perror("Could not allocate memory in dense_mul");
+        exit(EXIT_FAILURE);
+    }
+    size_t i = 0;
+    for (; i + nb <= na; i += nb) {
+        karatsuba(a + i, b, nb, piece);
+        add_to(out + i, piece, 2 * nb - 1);
+    }
+    if (i < na) {
+        dense_mul(a + i, na - i, b, nb, piece);
+        add_to(out + i, piece, na - i + nb - 1);
+    }
+    free(piece);
+}
@@ -0,0 +1,25 @@
+/** Dense coefficient vectors: c[i] is the coefficient of x^i, for polynomials with nonnegative exponents. Used by
+ * the algorithms that are only fast on dense inputs. Arithmetic wraps modulo 2^64 like the rest of the library. */
+#ifndef DENSE_H_INCLUDED
+#define DENSE_H_INCLUDED
+
+#include <stddef.h>
+#include "./sum.h"
+
+/* Below this many coefficients in the shorter operand, dense_mul uses the schoolbook method. */
+#define KARATSUBA_THRESHOLD 32
+
+/* Returns deg(p) + 1 coefficients in a new array, storing the length in len. p must be nonzero and have
+ * nonnegative exponents. */
+long* dense_from_sum(const sum* const p, size_t* len);
+
+/* Collects the nonzero coefficients of c into a sum. */
+sum dense_to_sum(const long* const c, size_t len);
+
+/* out[0 .. na+nb-2] = a * b. out must not overlap a or b. Picks schoolbook or Karatsuba multiplication by size. */
+void dense_mul(const long* const a, size_t na, const long* const b, size_t nb, long* out);
+
+/* Returns nonzero if the n terms of p cover at least a quarter of the exponents they span. */
+int is_dense(const sum* const p);
+
+#endif
@@ -0,0 +1,169 @@
+#include "./dense_mod.h"
+#include "../numeric/modular.h"
+#include "../numeric/coeff_vec.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "immintrin.h"
+#include "../util/instrument.h"
+
+/* The AVX2 kernels compare residues as signed words, which needs a + b < 2^63. */
+#define DMOD_LANE_BITS 62
+
+/* ---------------- scalar ---------------- */
+
+static void add_n_scalar(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n, uint64_t p) {
+    for (size_t i = 0; i < n; i++) out[i] = mod_add(a[i], b[i], p);
+}
+
+static void sub_n_scalar(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n, uint64_t p) {
+    for (size_t i = 0; i < n; i++) out[i] = mod_sub(a[i], b[i], p);
+}
+
+/* ---------------- AVX2 ---------------- */
+
+__attribute__((target("avx2")))
+static void add_n_avx2(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n, uint64_t p) {
+    __m256i vp = _mm256_set1_epi64x((long long) p);
+    __m256i vpm1 = _mm256_set1_epi64x((long long) p - 1);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i s = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*) (a + i)),
+                                     _mm256_loadu_si256((const __m256i*) (b + i)));
+        __m256i over = _mm256_cmpgt_epi64(s, vpm1);
+        _mm256_storeu_si256((__m256i*) (out + i), _mm256_sub_epi64(s, _mm256_and_si256(over, vp)));
+    }
+    add_n_scalar(out + i, a + i, b + i, n - i, p);
+}
+
+__attribute__((target("avx2")))
+static void sub_n_avx2(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n, uint64_t p) {
+    __m256i vp = _mm256_set1_epi64x((long long) p);
+    __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i d = _mm256_sub_epi64(_mm256_loadu_si256((const __m256i*) (a + i)),
+                                     _mm256_loadu_si256((const __m256i*) (b + i)));
+        __m256i under = _mm256_cmpgt_epi64(zero, d);
+        _mm256_storeu_si256((__m256i*) (out + i), _mm256_add_epi64(d, _mm256_and_si256(under, vp)));
+    }
+    sub_n_scalar(out + i, a + i, b + i, n - i, p);
+}
+
+/* ---------------- dispatch ---------------- */
+
+static int use_lanes(uint64_t p) {
+    return p < ((uint64_t) 1 << DMOD_LANE_BITS) && cvec_get_isa() >= CVEC_AVX2;
+}
+
+static void add_n(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n, uint64_t p) {
+    if (use_lanes(p)) add_n_avx2(out, a, b, n, p); else add_n_scalar(out, a, b, n, p);
+}
+
+static void sub_n(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n, uint64_t p) {
+    if (use_lanes(p)) sub_n_avx2(out, a, b, n, p); else sub_n_scalar(out, a, b, n, p);
+}
+
+static uint64_t* dmod_alloc(size_t n) {
+    uint64_t* ptr = malloc((n ? n : 1) * sizeof(uint64_t));
+    if (!ptr) {
+        perror("Could not allocate memory in dense_mod");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+size_t dmod_trim(const uint64_t* a, size_t n) {
+    while (n && !a[n - 1]) n--;
+    return n;
+}
+
+size_t dmod_add(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* out, uint64_t p) {
+    size_t n = na < nb ? na : nb;
+    add_n(out, a, b, n, p);
+    if (na > n) memmove(out + n, a + n, (na - n) * sizeof(uint64_t));
+    if (nb > n) memmove(out + n, b + n, (nb - n) * sizeof(uint64_t));
+    return dmod_trim(out, na > nb ? na : nb);
+}
+
+size_t dmod_sub(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* out, uint64_t p) {
+    size_t n = na < nb ? na : nb;
+    sub_n(out, a, b, n, p);
+    if (na > n) memmove(out + n, a + n, (na - n) * sizeof(uint64_t));
+    for (size_t i = n; i < nb; i++) out[i] = b[i] ? p - b[i] : 0;
+    return dmod_trim(out, na > nb ? na : nb);
+}
+
+void dmod_scale(uint64_t* a, size_t n, uint64_t c, uint64_t p) {
+    uint64_t cp = mod_shoup_precomp(c, p);
+    for (size_t i = 0; i < n; i++) a[i] = mod_shoup_mul(a[i], c, cp, p);
+}
+
+void dmod_addmul(uint64_t* y, size_t n, uint64_t c, const uint64_t* x, uint64_t p) {
+    if (!c) return;
+    uint64_t cp = mod_shoup_precomp(c, p);
+    for (size_t i = 0; i < n; i++) y[i] = mod_add(y[i], mod_shoup_mul(x[i], c, cp, p), p);
+}
+
+size_t dmod_prod(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* out, uint64_t p) {
+    if (!na || !nb) return 0;
+    // one row per coefficient of the shorter operand, each a Shoup multiplication by that coefficient
+    if (na > nb) {
+        const uint64_t* t = a;
+        a = b;
+        b = t;
+        size_t tn = na;
+        na = nb;
+        nb = tn;
+    }
+    memset(out, 0, (na + nb - 1) * sizeof(uint64_t));
+    for (size_t i = 0; i < na; i++) dmod_addmul(out + i, nb, a[i], b, p);
+    return dmod_trim(out, na + nb - 1);
+}
+
+size_t dmod_divrem(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* q, uint64_t* r, size_t* nr,
+                   uint64_t p) {
+    if (r != a) memmove(r, a, na * sizeof(uint64_t));
+    if (na < nb) {
+        *nr = dmod_trim(r, na);
+        return 0;
+    }
+    uint64_t inv = mod_inv(b[nb - 1], p);
+    for (size_t k = na - nb + 1; k-- > 0;) {
+        uint64_t c = mod_mul(r[k + nb - 1], inv, p);
+        if (q) q[k] = c;
+        // r -= c x^k b, which clears the leading coefficient
+        if (c) dmod_addmul(r + k, nb - 1, p - c, b, p);
+        r[k + nb - 1] = 0;
+    }
+    *nr = dmod_trim(r, nb - 1);
+    return na - nb + 1;
+}
+
+size_t dmod_gcd(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* out, uint64_t p) {
+    na = dmod_trim(a, na);
+    nb = dmod_trim(b, nb);
+    uint64_t* u = dmod_alloc(na);
+    uint64_t* v = dmod_alloc(nb);
+    memcpy(u, a, na * sizeof(uint64_t));
+    memcpy(v, b, nb * sizeof(uint64_t));
+    size_t nu = na, nv = nb;
+    // Euclid's algorithm, with each remainder written over the dividend
+    while (nv) {
+        size_t nr;
+        dmod_divrem(u, nu, v, nv, NULL, u, &nr, p);
+        uint64_t* t = u;
+        u = v;
+        v = t;
+        nu = nv;
+        nv = nr;
+    }
+    if (nu) {
+        dmod_scale(u, nu, mod_inv(u[nu - 1], p), p);
+        memcpy(out, u, nu * sizeof(uint64_t));
+    }
+    free(u);
+    free(v);
+    return nu;
+}
@@ -0,0 +1,38 @@
+/** Dense polynomials over Z/p for a word-sized prime p < 2^63: c[i] is the residue of the coefficient of x^i, and a
+ * polynomial of length n has c[n-1] != 0, the zero polynomial having length 0. These are the kernels of the modular
+ * algorithms, which map a problem to several primes and do all of their work at word size. Additions run in AVX2
+ * lanes for primes below 2^62 when the CPU has them (see coeff_vec.h); products use Shoup multiplication by the
+ * repeated operand. */
+#ifndef DENSE_MOD_H_INCLUDED
+#define DENSE_MOD_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* The length of a without its zero leading coefficients. */
+size_t dmod_trim(const uint64_t* a, size_t n);
+
+/* out = a + b and out = a - b, returning the length of the result. out has room for max(na, nb) coefficients and
+ * may be a or b. */
+size_t dmod_add(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* out, uint64_t p);
+size_t dmod_sub(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* out, uint64_t p);
+
+/* a[i] = c a[i]. */
+void dmod_scale(uint64_t* a, size_t n, uint64_t c, uint64_t p);
+
+/* y[i] += c x[i] for i < n, without trimming y. */
+void dmod_addmul(uint64_t* y, size_t n, uint64_t c, const uint64_t* x, uint64_t p);
+
+/* out = a b, returning its length, na + nb - 1 or 0. out must not overlap a or b. */
+size_t dmod_prod(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* out, uint64_t p);
+
+/* Division with remainder by a nonzero b. The quotient goes to q, if it is not null, which needs room for
+ * na - nb + 1 coefficients; its length is returned. The remainder goes to r, which needs room for na coefficients
+ * and may be a; its length is stored in nr. */
+size_t dmod_divrem(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* q, uint64_t* r, size_t* nr,
+                   uint64_t p);
+
+/* The monic gcd of a and b, returning its length. out needs room for max(na, nb) coefficients. */
+size_t dmod_gcd(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* out, uint64_t p);
+
+#endif
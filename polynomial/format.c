@@ -0,0 +1,85 @@
+#include "./format.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "../util/instrument.h"
+
+/* Room for a separator, a coefficient, the variable and an exponent. */
+#define TERM_CHARS (3 + OUTBUF_MAX_DIGITS + 2 + OUTBUF_MAX_DIGITS)
+
+static unsigned long magnitude(long c) {
+    return c < 0 ? 0 - (unsigned long) c : (unsigned long) c;
+}
+
+/* Writes the digits of v to p and returns the end of what was written. */
+static char* put_ulong(char* p, unsigned long v) {
+    char digits[OUTBUF_MAX_DIGITS];
+    char* d = outbuf_format_ulong(digits + sizeof(digits), v);
+    size_t n = (size_t) (digits + sizeof(digits) - d);
+    memcpy(p, d, n);
+    return p + n;
+}
+
+static char* put_long(char* p, long v) {
+    if (v < 0) *p++ = '-';
+    return put_ulong(p, magnitude(v));
+}
+
+static void format_text(outbuf* ob, const sum* const p) {
+    if (!p->n) {
+        outbuf_putc(ob, '0');
+        return;
+    }
+    char buf[TERM_CHARS];
+    for (size_t i = 0; i < p->n; i++) {
+        long c = p->terms[i].coeff;
+        int e = p->terms[i].exp;
+        char* q = buf;
+        if (i) {
+            memcpy(q, c < 0 ? " - " : " + ", 3);
+            q += 3;
+        } else if (c < 0) {
+            *q++ = '-';
+        }
+        if (magnitude(c) != 1 || !e) q = put_ulong(q, magnitude(c));
+        if (e) {
+            *q++ = 'x';
+            if (e != 1) {
+                *q++ = '^';
+                q = put_long(q, e);
+            }
+        }
+        outbuf_write(ob, buf, (size_t) (q - buf));
+    }
+}
+
+static void format_machine(outbuf* ob, const sum* const p) {
+    outbuf_ulong(ob, p->n);
+    char buf[TERM_CHARS];
+    for (size_t i = 0; i < p->n; i++) {
+        char* q = buf;
+        *q++ = ' ';
+        q = put_long(q, p->terms[i].exp);
+        *q++ = ' ';
+        q = put_long(q, p->terms[i].coeff);
+        outbuf_write(ob, buf, (size_t) (q - buf));
+    }
+}
+
+void format_sum(outbuf* ob, const sum* const p, format_style style) {
+    if (style == FORMAT_MACHINE) {
+        format_machine(ob, p);
+    } else {
+        format_text(ob, p);
+    }
+}
+
+char* format_sum_string(const sum* const p, format_style style, size_t* len) {
+    outbuf ob;
+    outbuf_memory(&ob);
+    format_sum(&ob, p, style);
+    outbuf_putc(&ob, '\0');
+    if (len) *len = ob.len - 1;
+    return ob.data;
+}
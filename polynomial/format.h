@@ -0,0 +1,22 @@
+/** Formatting polynomials into an outbuf (see util/outbuf.h). Each term is assembled in a small local buffer and
+ * copied out in one piece, so the cost is close to that of copying the text. */
+#ifndef FORMAT_H_INCLUDED
+#define FORMAT_H_INCLUDED
+
+#include <stddef.h>
+#include "./sum.h"
+#include "../util/outbuf.h"
+
+typedef enum {
+    // "3x^5 - 2x + 7", as read by parse_sum; the zero polynomial is "0"
+    FORMAT_TEXT,
+    // the number of terms, then the exponent and coefficient of each term, separated by spaces: "3 5 3 1 -2 0 7"
+    FORMAT_MACHINE
+} format_style;
+
+void format_sum(outbuf* ob, const sum* const p, format_style style);
+
+/* p formatted into a new \0-terminated string, of length *len if len is not null. */
+char* format_sum_string(const sum* const p, format_style style, size_t* len);
+
+#endif
@@ -0,0 +1,200 @@
+#include "./heap_div.h"
+#include "./prod_iter.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "stdint.h"
+#include "../util/instrument.h"
+
+/* The product of quotient term k with divisor term j. */
+typedef struct div_entry div_entry;
+
+struct div_entry {
+    int exp;
+    uint32_t k;
+    uint32_t j;
+};
+
+typedef struct div_heap div_heap;
+
+struct div_heap {
+    size_t n;
+    size_t capacity;
+    div_entry* arr;
+};
+
+static void div_heap_push(div_heap* h, div_entry e) {
+    if (h->n == h->capacity) {
+        h->capacity = h->capacity ? 2 * h->capacity : 16;
+        div_entry* tmp = reallocarray(h->arr, h->capacity, sizeof(div_entry));
+        if (!tmp) {
+            perror("Could not allocate more memory in division heap");
+            exit(EXIT_FAILURE);
+        }
+        h->arr = tmp;
+    }
+    size_t curr = h->n++;
+    while (curr > 0 && h->arr[(curr - 1) / 2].exp < e.exp) {
+        h->arr[curr] = h->arr[(curr - 1) / 2];
+        curr = (curr - 1) / 2;
+        INSTR_SIFTS(1);
+    }
+    h->arr[curr] = e;
+}
+
+static div_entry div_heap_pop(div_heap* h) {
+    div_entry max = h->arr[0];
+    div_entry last = h->arr[--h->n];
+    size_t curr = 0;
+    for (;;) {
+        size_t child = 2 * curr + 1;
+        if (child >= h->n) break;
+        if (child + 1 < h->n && h->arr[child + 1].exp > h->arr[child].exp) child++;
+        if (h->arr[child].exp <= last.exp) break;
+        h->arr[curr] = h->arr[child];
+        curr = child;
+        INSTR_SIFTS(1);
+    }
+    if (h->n) h->arr[curr] = last;
+    return max;
+}
+
+/* The terms of the dividend, highest first: those of p, or those of a product as a prod_iter yields them. */
+typedef struct div_source div_source;
+
+struct div_source {
+    const sum* p;
+    size_t i;
+    prod_iter* it;
+};
+
+static bool source_next(div_source* src, term* t) {
+    if (src->it) {
+        return prod_iter_next(src->it, t);
+    }
+    if (src->i == src->p->n) {
+        return false;
+    }
+    *t = src->p->terms[src->i++];
+    return true;
+}
+
+/* The division itself. With exact set, stops and returns false at the first term that would go to the remainder. */
+static bool divide(div_source* src, const sum* const q, sum* quot, sum* rem, bool exact) {
+    sum Q = {.n = 0, .capacity = 0, .terms = 0};
+    sum R = {.n = 0, .capacity = 0, .terms = 0};
+    div_heap h = {.n = 0, .capacity = 0, .arr = 0};
+
+    int dq = deg(q);
+    long c = lc(q);
+    // the next term of the dividend, if more is set
+    term next;
+    bool more = source_next(src, &next);
+    // once a leading coefficient fails to divide, quo stops producing quotient terms; so do we
+    bool dividing = true;
+    bool ok = true;
+
+    while (more || h.n) {
+        int e;
+        if (h.n && (!more || h.arr[0].exp > next.exp)) {
+            e = h.arr[0].exp;
+        } else {
+            e = next.exp;
+        }
+
+        long coeff = 0;
+        if (more && next.exp == e) {
+            coeff = next.coeff;
+            more = source_next(src, &next);
+        }
+        while (h.n && h.arr[0].exp == e) {
+            div_entry d = div_heap_pop(&h);
+            coeff -= Q.terms[d.k].coeff * q->terms[d.j].coeff;
+            if (d.j + 1 < q->n) {
+                d.j++;
+                d.exp = Q.terms[d.k].exp + q->terms[d.j].exp;
+                div_heap_push(&h, d);
+            }
+        }
+        if (!coeff) {
+            continue;
+        }
+
+        if (dividing && e >= dq && !(coeff % c)) {
+            push_term(&Q, (term) {.exp = e - dq, .coeff = coeff / c});
+            if (q->n > 1) {
+                div_entry d = {
+                    .exp = e - dq + q->terms[1].exp,
+                    .k = (uint32_t) (Q.n - 1),
+                    .j = 1
+                };
+                div_heap_push(&h, d);
+            }
+        } else {
+            if (exact) {
+                ok = false;
+                break;
+            }
+            dividing = false;
+            if (!rem) {
+                // the quotient is finished and nobody wants the remainder
+                break;
+            }
+            push_term(&R, (term) {.exp = e, .coeff = coeff});
+        }
+    }
+    free(h.arr);
+
+    if (quot && ok) {
+        *quot = finish_terms(&Q);
+    } else {
+        free(Q.terms);
+    }
+    if (rem && ok) {
+        *rem = finish_terms(&R);
+    } else {
+        free(R.terms);
+    }
+    return ok;
+}
+
+void heap_divrem(const sum* const p, const sum* const q, sum* quot, sum* rem) {
+    div_source src = {.p = p};
+    divide(&src, q, quot, rem, false);
+}
+
+sum heap_quo(const sum* const p, const sum* const q) {
+    sum out;
+    div_source src = {.p = p};
+    divide(&src, q, &out, 0, false);
+    return out;
+}
+
+sum heap_rem(const sum* const p, const sum* const q) {
+    sum out;
+    div_source src = {.p = p};
+    divide(&src, q, 0, &out, false);
+    return out;
+}
+
+bool heap_divides(const sum* const p, const sum* const q, sum* quot) {
+    div_source src = {.p = p};
+    return divide(&src, q, quot, 0, true);
+}
+
+void heap_divrem_prod(const sum* const a, const sum* const b, const sum* const q, sum* quot, sum* rem) {
+    prod_iter it;
+    prod_iter_init(&it, a, b);
+    div_source src = {.it = &it};
+    divide(&src, q, quot, rem, false);
+    prod_iter_free(&it);
+}
+
+bool heap_divides_prod(const sum* const a, const sum* const b, const sum* const q, sum* quot) {
+    prod_iter it;
+    prod_iter_init(&it, a, b);
+    div_source src = {.it = &it};
+    bool ok = divide(&src, q, quot, 0, true);
+    prod_iter_free(&it);
+    return ok;
+}
@@ -0,0 +1,31 @@
+/** Sparse polynomial division in the style of Monagan and Pearce. The products of the quotient with the divisor
+ * are never formed: a heap with one entry per quotient term merges them lazily, highest exponent first, against
+ * the terms of the dividend. Memory is linear in the size of the inputs plus the outputs, and the work is
+ * O(#q * #quotient * log #quotient) regardless of how far apart the exponents are. */
+#ifndef HEAP_DIV_H_INCLUDED
+#define HEAP_DIV_H_INCLUDED
+
+#include <stdbool.h>
+#include "./sum.h"
+
+/* Divides p by q. Like quo, quotient terms are produced until the degree of what is left drops below deg(q) or
+ * lc(q) fails to divide its leading coefficient; everything from then on goes to the remainder. Either output may
+ * be null if it is not wanted. */
+void heap_divrem(const sum* const p, const sum* const q, sum* quot, sum* rem);
+
+sum heap_quo(const sum* const p, const sum* const q);
+
+sum heap_rem(const sum* const p, const sum* const q);
+
+/* Returns true if q divides p exactly over the integers, storing the quotient in quot if it is not null. Returns
+ * false as soon as a coefficient fails to divide or a remainder term appears, without finishing the division. */
+bool heap_divides(const sum* const p, const sum* const q, sum* quot);
+
+/* The same with the dividend a b, whose terms are taken from a prod_iter (see polynomial/prod_iter.h) as the
+ * division needs them, so the product is never stored. heap_divides_prod reads only as far as the first term that
+ * rules out divisibility. */
+void heap_divrem_prod(const sum* const a, const sum* const b, const sum* const q, sum* quot, sum* rem);
+
+bool heap_divides_prod(const sum* const a, const sum* const b, const sum* const q, sum* quot);
+
+#endif
@@ -0,0 +1,243 @@
+#include "./job.h"
+#include "./sum.h"
+#include "./parse.h"
+#include "./format.h"
+#include "./bsplit.h"
+#include "../numeric/mp_int.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "errno.h"
+#include "limits.h"
+#include "../util/instrument.h"
+
+/* Most operands a spec can have. */
+#define JOB_MAX_ARGS 4
+
+typedef enum {
+    JOB_ADD,
+    JOB_PROD,
+    JOB_QUO,
+    JOB_REM,
+    JOB_PQUO,
+    JOB_PREM,
+    JOB_GCD,
+    JOB_HSUM
+} job_op;
+
+static const struct {
+    const char* name;
+    job_op op;
+} ops[] = {
+    {"add", JOB_ADD},
+    {"prod", JOB_PROD},
+    {"quo", JOB_QUO},
+    {"rem", JOB_REM},
+    {"pquo", JOB_PQUO},
+    {"prem", JOB_PREM},
+    {"gcd", JOB_GCD},
+    {"hsum", JOB_HSUM}
+};
+
+typedef struct job_state job_state;
+
+struct job_state {
+    job_op op;
+    sum p;
+    sum q;
+    long start;
+    size_t count;
+};
+
+static int is_space(char c) {
+    return c == ' ' || c == '\t';
+}
+
+static void operand_error(outbuf* out, const char* what, size_t arg) {
+    outbuf_puts(out, what);
+    outbuf_puts(out, " in operand ");
+    outbuf_ulong(out, arg);
+}
+
+static int parse_long(const char* s, size_t len, long* out) {
+    char buf[32];
+    while (len && is_space(*s)) s++, len--;
+    while (len && is_space(s[len - 1])) len--;
+    if (!len || len >= sizeof(buf)) return -1;
+    memcpy(buf, s, len);
+    buf[len] = '\0';
+    char* end;
+    errno = 0;
+    *out = strtol(buf, &end, 10);
+    return *end || errno ? -1 : 0;
+}
+
+static int bits(unsigned long v) {
+    return v ? 64 - __builtin_clzl(v) : 0;
+}
+
+/* A bound on the bits of p(k) for |k| < 2^kbits: n terms of at most c bits times k^deg(p). */
+static double value_bits(const sum* const p, int kbits) {
+    int c = 0;
+    for (size_t i = 0; i < p->n; i++) {
+        long v = p->terms[i].coeff;
+        int b = bits(v < 0 ? 0 - (unsigned long) v : (unsigned long) v);
+        if (b > c) c = b;
+    }
+    int d = p->n && deg(p) > 0 ? deg(p) : 0;
+    return c + bits(p->n) + (double) d * kbits;
+}
+
+/* A bound on the bits of the numbers bsplit_sum builds for s, which are about count values of a and of b. */
+static double hsum_bits(const job_state* const s) {
+    long last = s->start + (long) s->count;
+    unsigned long m = s->start < 0 ? 0 - (unsigned long) s->start : (unsigned long) s->start;
+    if ((unsigned long) last > m) m = (unsigned long) last;
+    int kbits = bits(m) ? bits(m) : 1;
+    double pb = value_bits(&s->p, kbits), qb = value_bits(&s->q, kbits);
+    return (double) s->count * (pb > qb ? pb : qb);
+}
+
+static batch_status prepare(const char* spec, size_t len, void** state, outbuf* out) {
+    size_t i = 0;
+    while (i < len && is_space(spec[i])) i++;
+    size_t name = i;
+    while (i < len && !is_space(spec[i])) i++;
+    size_t k = 0;
+    while (k < sizeof(ops) / sizeof(ops[0])
+           && (strlen(ops[k].name) != i - name || memcmp(ops[k].name, spec + name, i - name))) {
+        k++;
+    }
+    if (k == sizeof(ops) / sizeof(ops[0])) {
+        outbuf_puts(out, "unknown operation");
+        return BATCH_ERROR;
+    }
+    job_op op = ops[k].op;
+
+    // the operands are the pieces between semicolons
+    const char* args[JOB_MAX_ARGS];
+    size_t lens[JOB_MAX_ARGS];
+    size_t n = 0;
+    size_t want = op == JOB_HSUM ? 4 : 2;
+    size_t from = i;
+    for (size_t j = i; j <= len; j++) {
+        if (j < len && spec[j] != ';') continue;
+        if (n == want) {
+            n++;
+            break;
+        }
+        args[n] = spec + from;
+        lens[n] = j - from;
+        n++;
+        from = j + 1;
+    }
+    if (n != want) {
+        outbuf_puts(out, "wrong number of operands");
+        return BATCH_ERROR;
+    }
+
+    job_state* s = malloc(sizeof(job_state));
+    if (!s) {
+        perror("Could not allocate memory in job");
+        exit(EXIT_FAILURE);
+    }
+    *s = (job_state) {.op = op};
+    parse_error err;
+    if (parse_sum(args[0], lens[0], &s->p, &err) != PARSE_OK) {
+        operand_error(out, parse_strerror(err.status), 1);
+        free(s);
+        return BATCH_ERROR;
+    }
+    if (parse_sum(args[1], lens[1], &s->q, &err) != PARSE_OK) {
+        operand_error(out, parse_strerror(err.status), 2);
+        free_polynomial(&s->p);
+        free(s);
+        return BATCH_ERROR;
+    }
+    const char* problem = NULL;
+    if (op == JOB_HSUM) {
+        long count = 0;
+        // bsplit_sum takes ranges that end at or below LONG_MAX
+        if (parse_long(args[2], lens[2], &s->start) || parse_long(args[3], lens[3], &count) || count < 0
+            || s->start > LONG_MAX - count) {
+            problem = "bad range";
+        }
+        s->count = (size_t) count;
+        if (!problem && hsum_bits(s) > JOB_HSUM_MAX_BITS) problem = "sum too large";
+    } else if (op >= JOB_QUO && op <= JOB_PREM && !s->q.n) {
+        problem = "division by zero";
+    }
+    if (problem) {
+        outbuf_puts(out, problem);
+        free_polynomial(&s->p);
+        free_polynomial(&s->q);
+        free(s);
+        return BATCH_ERROR;
+    }
+    *state = s;
+    return BATCH_OK;
+}
+
+static batch_status run(void* state, arena* a, outbuf* out) {
+    job_state* s = state;
+    sum r;
+    switch (s->op) {
+        case JOB_ADD:
+            r = add(&s->p, &s->q);
+            format_sum(out, &r, FORMAT_TEXT);
+            free_polynomial(&r);
+            return BATCH_OK;
+        case JOB_GCD:
+            r = prim_gcd_a(&s->p, &s->q, a);
+            format_sum(out, &r, FORMAT_TEXT);
+            free_polynomial(&r);
+            return BATCH_OK;
+        case JOB_HSUM: {
+            mp_int num, den;
+            if (bsplit_sum(NULL, &s->p, &s->q, s->start, s->count, &num, &den)) {
+                outbuf_puts(out, "negative exponent, or denominator vanishes in the range");
+                return BATCH_ERROR;
+            }
+            size_t len;
+            char* str = mpint_to_string(&num, &len);
+            outbuf_write(out, str, len);
+            free(str);
+            outbuf_putc(out, '/');
+            str = mpint_to_string(&den, &len);
+            outbuf_write(out, str, len);
+            free(str);
+            mpint_free(&num);
+            mpint_free(&den);
+            return BATCH_OK;
+        }
+        case JOB_PROD: r = prod_a(&s->p, &s->q, a); break;
+        case JOB_QUO:
+            // quo_a requires deg(p) >= deg(q); below that the quotient is 0, as pquo_a returns
+            if (deg(&s->p) < deg(&s->q)) {
+                outbuf_putc(out, '0');
+                return BATCH_OK;
+            }
+            r = quo_a(&s->p, &s->q, a);
+            break;
+        case JOB_REM: r = rem_a(&s->p, &s->q, a); break;
+        case JOB_PQUO: r = pquo_a(&s->p, &s->q, a); break;
+        case JOB_PREM: r = prem_a(&s->p, &s->q, a); break;
+    }
+    // the arena versions leave r in a, which the runner releases
+    format_sum(out, &r, FORMAT_TEXT);
+    return BATCH_OK;
+}
+
+static void cleanup(void* state) {
+    job_state* s = state;
+    free_polynomial(&s->p);
+    free_polynomial(&s->q);
+    free(s);
+}
+
+const batch_job sum_job = {
+    .prepare = prepare,
+    .run = run,
+    .cleanup = cleanup
+};
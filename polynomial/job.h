@@ -0,0 +1,23 @@
+/** Polynomial problems as batch jobs (see util/batch.h). A spec is an operation name followed by its operands,
+ * separated by ';':
+ *
+ *     prod 3x^2 + 1 ; x - 5
+ *     hsum k + 1 ; k + 2 ; 0 ; 1000
+ *
+ * add, prod, quo, rem, pquo and prem take two polynomials and print the result; gcd prints the primitive gcd.
+ * hsum takes the polynomials a and b of a term ratio a(k) / b(k), a start and a count, and prints the partial sum
+ * of bsplit_sum as "num/den". The products, divisions and gcd work in the worker's arena and so stop promptly at a
+ * limit; add and hsum allocate with malloc and are only checked for time once they finish. As bsplit_sum cannot be
+ * stopped, an hsum whose numbers could pass JOB_HSUM_MAX_BITS is rejected as too large before it runs. */
+#ifndef JOB_H_INCLUDED
+#define JOB_H_INCLUDED
+
+#include "../util/batch.h"
+
+/* Bound on the size of the numbers of an hsum job, estimated from the count and the values of a and b at the ends of
+ * the range. Sums at the bound take about half a second. */
+#define JOB_HSUM_MAX_BITS (1 << 19)
+
+extern const batch_job sum_job;
+
+#endif
@@ -0,0 +1,342 @@
+#include "./memo.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "pthread.h"
+#include "../util/instrument.h"
+
+#define MEMO_MIN_BUCKETS 64
+
+/* The finalizer of splitmix64, which spreads every input bit over the whole word. */
+static uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t sum_hash(const sum* const p) {
+    uint64_t h = mix64(p->n + 0x9e3779b97f4a7c15ULL);
+    for (size_t i = 0; i < p->n; i++) {
+        h = mix64(h ^ (uint32_t) p->terms[i].exp);
+        h = mix64(h ^ (uint64_t) p->terms[i].coeff);
+    }
+    return h;
+}
+
+bool sum_equal(const sum* const p, const sum* const q) {
+    if (p->n != q->n) return false;
+    for (size_t i = 0; i < p->n; i++) {
+        if (p->terms[i].exp != q->terms[i].exp || p->terms[i].coeff != q->terms[i].coeff) return false;
+    }
+    return true;
+}
+
+static void* memo_alloc(size_t n, size_t size) {
+    void* ptr = calloc(n ? n : 1, size);
+    if (!ptr) {
+        perror("Could not allocate memory in memo");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+/* A copy of p with its own terms, keeping the zeroed first term of the zero polynomial. */
+static sum copy_sum(const sum* const p) {
+    size_t n = p->n ? p->n : 1;
+    sum out = {
+        .n = p->n,
+        .capacity = 0,
+        .terms = memo_alloc(n, sizeof(term))
+    };
+    if (p->n) memcpy(out.terms, p->terms, n * sizeof(term));
+    return out;
+}
+
+static size_t sum_bytes(const sum* const p) {
+    return (p->n ? p->n : 1) * sizeof(term);
+}
+
+/* ---------------- interning ---------------- */
+
+typedef struct pool_entry pool_entry;
+
+struct pool_entry {
+    uint64_t hash;
+    sum p;
+    pool_entry* next;
+};
+
+struct sum_pool {
+    pthread_mutex_t lock;
+    pool_entry** buckets;
+    size_t nbuckets;
+    size_t n;
+};
+
+sum_pool* sum_pool_create() {
+    sum_pool* pool = memo_alloc(1, sizeof(sum_pool));
+    pthread_mutex_init(&pool->lock, NULL);
+    pool->nbuckets = MEMO_MIN_BUCKETS;
+    pool->buckets = memo_alloc(pool->nbuckets, sizeof(pool_entry*));
+    return pool;
+}
+
+static void pool_grow(sum_pool* pool) {
+    size_t nb = 2 * pool->nbuckets;
+    pool_entry** buckets = memo_alloc(nb, sizeof(pool_entry*));
+    for (size_t i = 0; i < pool->nbuckets; i++) {
+        for (pool_entry* e = pool->buckets[i]; e;) {
+            pool_entry* next = e->next;
+            e->next = buckets[e->hash & (nb - 1)];
+            buckets[e->hash & (nb - 1)] = e;
+            e = next;
+        }
+    }
+    free(pool->buckets);
+    pool->buckets = buckets;
+    pool->nbuckets = nb;
+}
+
+const sum* sum_pool_intern(sum_pool* pool, const sum* const p) {
+    uint64_t h = sum_hash(p);
+    pthread_mutex_lock(&pool->lock);
+    for (pool_entry* e = pool->buckets[h & (pool->nbuckets - 1)]; e; e = e->next) {
+        if (e->hash == h && sum_equal(&e->p, p)) {
+            pthread_mutex_unlock(&pool->lock);
+            return &e->p;
+        }
+    }
+    if (pool->n >= pool->nbuckets) pool_grow(pool);
+    pool_entry* e = memo_alloc(1, sizeof(pool_entry));
+    e->hash = h;
+    e->p = copy_sum(p);
+    e->next = pool->buckets[h & (pool->nbuckets - 1)];
+    pool->buckets[h & (pool->nbuckets - 1)] = e;
+    pool->n++;
+    pthread_mutex_unlock(&pool->lock);
+    return &e->p;
+}
+
+size_t sum_pool_size(const sum_pool* const pool) {
+    return pool->n;
+}
+
+void sum_pool_free(sum_pool* pool) {
+    if (!pool) return;
+    for (size_t i = 0; i < pool->nbuckets; i++) {
+        for (pool_entry* e = pool->buckets[i]; e;) {
+            pool_entry* next = e->next;
+            free_polynomial(&e->p);
+            free(e);
+            e = next;
+        }
+    }
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->buckets);
+    free(pool);
+}
+
+/* ---------------- the cache ---------------- */
+
+typedef struct memo_entry memo_entry;
+
+/* An entry is in a hash chain and in the recency list, most recently used first. */
+struct memo_entry {
+    uint64_t hash;
+    int op;
+    size_t nops;
+    sum operands[MEMO_MAX_OPERANDS];
+    sum result;
+    size_t bytes;
+    memo_entry* chain;
+    memo_entry* newer;
+    memo_entry* older;
+};
+
+struct memo_cache {
+    pthread_mutex_t lock;
+    memo_entry** buckets;
+    size_t nbuckets;
+    memo_entry* newest;
+    memo_entry* oldest;
+    size_t max_bytes;
+    memo_stats stats;
+};
+
+memo_cache* memo_create(size_t max_bytes) {
+    memo_cache* c = memo_alloc(1, sizeof(memo_cache));
+    pthread_mutex_init(&c->lock, NULL);
+    c->nbuckets = MEMO_MIN_BUCKETS;
+    c->buckets = memo_alloc(c->nbuckets, sizeof(memo_entry*));
+    c->max_bytes = max_bytes;
+    return c;
+}
+
+static uint64_t key_hash(int op, const sum* const* operands, size_t nops) {
+    uint64_t h = mix64((uint64_t) op + 1);
+    for (size_t i = 0; i < nops; i++) {
+        h = mix64(h ^ sum_hash(operands[i]));
+    }
+    return h;
+}
+
+static memo_entry* find_entry(memo_cache* c, uint64_t h, int op, const sum* const* operands, size_t nops) {
+    for (memo_entry* e = c->buckets[h & (c->nbuckets - 1)]; e; e = e->chain) {
+        if (e->hash != h || e->op != op || e->nops != nops) continue;
+        size_t i = 0;
+        while (i < nops && sum_equal(&e->operands[i], operands[i])) i++;
+        if (i == nops) return e;
+    }
+    return NULL;
+}
+
+static void unlink_recency(memo_cache* c, memo_entry* e) {
+    if (e->newer) e->newer->older = e->older; else c->newest = e->older;
+    if (e->older) e->older->newer = e->newer; else c->oldest = e->newer;
+    e->newer = e->older = NULL;
+}
+
+static void push_newest(memo_cache* c, memo_entry* e) {
+    e->older = c->newest;
+    e->newer = NULL;
+    if (c->newest) c->newest->newer = e; else c->oldest = e;
+    c->newest = e;
+}
+
+static void free_entry(memo_entry* e) {
+    for (size_t i = 0; i < e->nops; i++) free_polynomial(&e->operands[i]);
+    free_polynomial(&e->result);
+    free(e);
+}
+
+static void remove_entry(memo_cache* c, memo_entry* e) {
+    memo_entry** link = &c->buckets[e->hash & (c->nbuckets - 1)];
+    while (*link != e) link = &(*link)->chain;
+    *link = e->chain;
+    unlink_recency(c, e);
+    c->stats.entries--;
+    c->stats.bytes -= e->bytes;
+    free_entry(e);
+}
+
+static void cache_grow(memo_cache* c) {
+    size_t nb = 2 * c->nbuckets;
+    memo_entry** buckets = memo_alloc(nb, sizeof(memo_entry*));
+    for (size_t i = 0; i < c->nbuckets; i++) {
+        for (memo_entry* e = c->buckets[i]; e;) {
+            memo_entry* next = e->chain;
+            e->chain = buckets[e->hash & (nb - 1)];
+            buckets[e->hash & (nb - 1)] = e;
+            e = next;
+        }
+    }
+    free(c->buckets);
+    c->buckets = buckets;
+    c->nbuckets = nb;
+}
+
+bool memo_find(memo_cache* c, int op, const sum* const* operands, size_t nops, sum* out) {
+    if (nops > MEMO_MAX_OPERANDS) return false;
+    uint64_t h = key_hash(op, operands, nops);
+    pthread_mutex_lock(&c->lock);
+    memo_entry* e = find_entry(c, h, op, operands, nops);
+    if (e) {
+        unlink_recency(c, e);
+        push_newest(c, e);
+        *out = copy_sum(&e->result);
+        c->stats.hits++;
+    } else {
+        c->stats.misses++;
+    }
+    pthread_mutex_unlock(&c->lock);
+    return e != NULL;
+}
+
+void memo_store(memo_cache* c, int op, const sum* const* operands, size_t nops, const sum* const result) {
+    if (nops > MEMO_MAX_OPERANDS) return;
+    size_t bytes = sizeof(memo_entry) + sum_bytes(result);
+    for (size_t i = 0; i < nops; i++) bytes += sum_bytes(operands[i]);
+    if (bytes > c->max_bytes) return;
+
+    uint64_t h = key_hash(op, operands, nops);
+    pthread_mutex_lock(&c->lock);
+    // another thread may have computed the same result in the meantime
+    if (find_entry(c, h, op, operands, nops)) {
+        pthread_mutex_unlock(&c->lock);
+        return;
+    }
+    while (c->stats.bytes + bytes > c->max_bytes) {
+        remove_entry(c, c->oldest);
+        c->stats.evictions++;
+    }
+    if (c->stats.entries >= c->nbuckets) cache_grow(c);
+
+    memo_entry* e = memo_alloc(1, sizeof(memo_entry));
+    e->hash = h;
+    e->op = op;
+    e->nops = nops;
+    for (size_t i = 0; i < nops; i++) e->operands[i] = copy_sum(operands[i]);
+    e->result = copy_sum(result);
+    e->bytes = bytes;
+    e->chain = c->buckets[h & (c->nbuckets - 1)];
+    c->buckets[h & (c->nbuckets - 1)] = e;
+    push_newest(c, e);
+    c->stats.entries++;
+    c->stats.bytes += bytes;
+    pthread_mutex_unlock(&c->lock);
+}
+
+sum memo_prim_gcd(memo_cache* c, const sum* const p, const sum* const q) {
+    const sum* ops[] = {p, q};
+    sum g;
+    if (memo_find(c, MEMO_PRIM_GCD, ops, 2, &g)) return g;
+    g = prim_gcd(p, q);
+    memo_store(c, MEMO_PRIM_GCD, ops, 2, &g);
+    return g;
+}
+
+long memo_cont(memo_cache* c, const sum* const p) {
+    const sum* ops[] = {p};
+    sum r;
+    if (memo_find(c, MEMO_CONT, ops, 1, &r)) {
+        long out = r.terms[0].coeff;
+        free_polynomial(&r);
+        return out;
+    }
+    // the content is kept as a constant polynomial
+    term t = {.exp = 0, .coeff = cont(p)};
+    r = (sum){.n = 1, .capacity = 0, .terms = &t};
+    memo_store(c, MEMO_CONT, ops, 1, &r);
+    return t.coeff;
+}
+
+sum memo_prim(memo_cache* c, const sum* const p) {
+    const sum* ops[] = {p};
+    sum r;
+    if (memo_find(c, MEMO_PRIM, ops, 1, &r)) return r;
+    r = prim(p);
+    memo_store(c, MEMO_PRIM, ops, 1, &r);
+    return r;
+}
+
+memo_stats memo_get_stats(memo_cache* c) {
+    pthread_mutex_lock(&c->lock);
+    memo_stats s = c->stats;
+    pthread_mutex_unlock(&c->lock);
+    return s;
+}
+
+void memo_clear(memo_cache* c) {
+    pthread_mutex_lock(&c->lock);
+    while (c->oldest) remove_entry(c, c->oldest);
+    pthread_mutex_unlock(&c->lock);
+}
+
+void memo_free(memo_cache* c) {
+    if (!c) return;
+    memo_clear(c);
+    pthread_mutex_destroy(&c->lock);
+    free(c->buckets);
+    free(c);
+}
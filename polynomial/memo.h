@@ -0,0 +1,75 @@
+/** Hash-consing and memoization for sums. sum_hash is a stable hash of the exponents and coefficients, the same on
+ * every run and platform, and sum_equal is the matching structural equality. A sum_pool keeps one shared copy of
+ * each distinct sum, so that interned sums can be compared by pointer. A memo_cache remembers the results of
+ * expensive operations keyed on the operation and its operands, evicting the least recently used results to stay
+ * under a memory cap. Both are safe to use from several threads. */
+#ifndef MEMO_H_INCLUDED
+#define MEMO_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "./sum.h"
+
+uint64_t sum_hash(const sum* const p);
+
+bool sum_equal(const sum* const p, const sum* const q);
+
+typedef struct sum_pool sum_pool;
+
+sum_pool* sum_pool_create();
+
+/* The pool's copy of p, made on first sight. It stays valid until sum_pool_free and must not be modified. */
+const sum* sum_pool_intern(sum_pool* pool, const sum* const p);
+
+size_t sum_pool_size(const sum_pool* const pool);
+
+void sum_pool_free(sum_pool* pool);
+
+/* Operations known to the cache. Callers may cache operations of their own with ids from MEMO_USER on. */
+typedef enum {
+    MEMO_PRIM_GCD,
+    MEMO_CONT,
+    MEMO_PRIM,
+    MEMO_USER = 64
+} memo_op;
+
+/* Most operands an operation may be keyed on. */
+#define MEMO_MAX_OPERANDS 4
+
+typedef struct memo_cache memo_cache;
+
+typedef struct memo_stats memo_stats;
+
+struct memo_stats {
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t entries;
+    // estimated memory held by the cache, for the operands it keeps to check keys and for the results
+    size_t bytes;
+};
+
+/* A cache holding at most max_bytes of operands and results. */
+memo_cache* memo_create(size_t max_bytes);
+
+/* Looks up op applied to the nops operands. On a hit, copies the result to out, which the caller must free. */
+bool memo_find(memo_cache* c, int op, const sum* const* operands, size_t nops, sum* out);
+
+/* Remembers result for op applied to the operands. The cache keeps copies, so the caller keeps ownership of
+ * everything passed in. Results larger than the whole cap are not kept. */
+void memo_store(memo_cache* c, int op, const sum* const* operands, size_t nops, const sum* const result);
+
+/* Memoized versions of the operations, returning results the caller must free. */
+sum memo_prim_gcd(memo_cache* c, const sum* const p, const sum* const q);
+long memo_cont(memo_cache* c, const sum* const p);
+sum memo_prim(memo_cache* c, const sum* const p);
+
+memo_stats memo_get_stats(memo_cache* c);
+
+/* Drops every result, keeping the statistics. */
+void memo_clear(memo_cache* c);
+
+void memo_free(memo_cache* c);
+
+#endif
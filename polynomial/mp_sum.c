@@ -0,0 +1,117 @@
+#include "./mp_sum.h"
+#include "./prod_iter.h"
+#include "../numeric/wide_int.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "assert.h"
+#include "../util/instrument.h"
+
+mp_sum mp_sum_from_sum(const sum* const p) {
+    mp_sum out = {.n = p->n};
+    if (!p->n) return out;
+    out.exps = malloc(p->n * sizeof(int));
+    out.coeffs = malloc(p->n * sizeof(mp_int));
+    if (!out.exps || !out.coeffs) {
+        perror("Could not allocate memory in mp_sum_from_sum");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < p->n; i++) {
+        out.exps[i] = p->terms[i].exp;
+        out.coeffs[i] = mpint_from_long(p->terms[i].coeff);
+    }
+    return out;
+}
+
+bool mp_sum_to_sum(const mp_sum* const p, sum* out) {
+    for (size_t i = 0; i < p->n; i++) {
+        if (!mpint_fits_long(&p->coeffs[i])) return false;
+    }
+    if (!p->n) {
+        *out = zero_polynomial();
+        return true;
+    }
+    sum g = {
+        .n = p->n,
+        .capacity = 0,
+        .terms = malloc(p->n * sizeof(term))
+    };
+    if (!g.terms) {
+        perror("Could not allocate memory in mp_sum_to_sum");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < p->n; i++) {
+        g.terms[i].exp = p->exps[i];
+        g.terms[i].coeff = mpint_to_long(&p->coeffs[i]);
+    }
+    *out = g;
+    return true;
+}
+
+static mp_int mpint_from_i256(i256 a) {
+    if (i256_fits_i64(a)) return mpint_from_long((long) a.w[0]);
+    bool neg = i256_is_neg(a);
+    if (neg) a = i256_neg(a);
+    size_t n = 4;
+    while (!a.w[n - 1]) n--;
+    mp_int view = mpint_view(neg, a.w, n);
+    mp_int out = mpint_copy(&view);
+    mpint_free(&view);
+    return out;
+}
+
+/* Appends a term to out, which has room for capacity terms. */
+static void push_mp_term(mp_sum* out, size_t* capacity, int exp, i256 coeff) {
+    if (out->n == *capacity) {
+        *capacity = *capacity ? 2 * *capacity : 8;
+        int* exps = reallocarray(out->exps, *capacity, sizeof(int));
+        if (exps) out->exps = exps;
+        mp_int* coeffs = reallocarray(out->coeffs, *capacity, sizeof(mp_int));
+        if (coeffs) out->coeffs = coeffs;
+        if (!exps || !coeffs) {
+            perror("Could not allocate memory in mp_sum_prod");
+            exit(EXIT_FAILURE);
+        }
+    }
+    out->exps[out->n] = exp;
+    out->coeffs[out->n++] = mpint_from_i256(coeff);
+}
+
+mp_sum mp_sum_prod(const sum* const p, const sum* const q) {
+    mp_sum out = {.n = 0};
+    size_t capacity = 0;
+    prod_iter it;
+    prod_iter_init(&it, p, q);
+    prod_entry d;
+    bool more = prod_iter_pop(&it, &d);
+    while (more) {
+        int e = d.exp;
+        i256 coeff = i256_from_i128(0);
+        // fewer than 2^127 products of two longs cannot overflow 256 bits
+        do {
+            i128 t = (i128) it.p->terms[d.i].coeff * it.q->terms[d.j].coeff;
+            bool over = i256_add(&coeff, coeff, i256_from_i128(t));
+            assert(!over);
+            (void) over;
+        } while ((more = prod_iter_pop(&it, &d)) && d.exp == e);
+        if (!wide_is_zero(coeff.w, 4)) push_mp_term(&out, &capacity, e, coeff);
+    }
+    prod_iter_free(&it);
+    if (out.n && out.n < capacity) {
+        int* exps = realloc(out.exps, out.n * sizeof(int));
+        if (exps) out.exps = exps;
+        mp_int* coeffs = realloc(out.coeffs, out.n * sizeof(mp_int));
+        if (coeffs) out.coeffs = coeffs;
+    }
+    return out;
+}
+
+void mp_sum_free(mp_sum* p) {
+    if (!p) return;
+    for (size_t i = 0; i < p->n; i++) {
+        mpint_free(&p->coeffs[i]);
+    }
+    free(p->exps);
+    free(p->coeffs);
+    *p = (mp_sum){0};
+}
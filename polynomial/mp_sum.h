@@ -0,0 +1,33 @@
+/** Polynomials with multiprecision coefficients, for results that may not fit the long coefficients of sum. */
+#ifndef MP_SUM_H_INCLUDED
+#define MP_SUM_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "./sum.h"
+#include "../numeric/mp_int.h"
+
+typedef struct mp_sum mp_sum;
+
+/* Terms with exponents exps, in decreasing order, and nonzero coefficients coeffs. The zero polynomial has n = 0
+ * and may have null arrays. */
+struct mp_sum {
+    size_t n;
+    int* exps;
+    mp_int* coeffs;
+};
+
+mp_sum mp_sum_from_sum(const sum* const p);
+
+/* Converts p if every coefficient fits in a long. Returns false, leaving out untouched, otherwise. */
+bool mp_sum_to_sum(const mp_sum* const p, sum* out);
+
+/* The exact product of two polynomials with long coefficients. The products of terms are merged in order of
+ * exponent with the heap of prod_iter, so memory grows with the result and the shorter operand rather than with
+ * p->n q->n. Each coefficient is accumulated in 256 bits, which cannot overflow, and only becomes an mp_int at the
+ * end; coefficients that fit in a long never allocate limbs. */
+mp_sum mp_sum_prod(const sum* const p, const sum* const q);
+
+void mp_sum_free(mp_sum* p);
+
+#endif
@@ -0,0 +1,393 @@
+#include "./multimod.h"
+#include "../numeric/modular.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "limits.h"
+#include "../util/instrument.h"
+
+#define MULTIMOD_DEFAULT_MAX_PRIMES 1024
+
+typedef struct prime_task prime_task;
+
+struct prime_task {
+    uint64_t prime;
+    const sum* inputs;
+    size_t ninputs;
+    multimod_kernel kernel;
+    void* ctx;
+    sum image;
+    int status;
+};
+
+/* The Chinese remainder state: coefficients v, in the symmetric range of the modulus, for the exponents exps. */
+typedef struct crt_state crt_state;
+
+struct crt_state {
+    size_t n;
+    int* exps;
+    mp_int* v;
+    mp_int modulus;
+    size_t used;
+    int deg;
+};
+
+typedef enum {
+    COMBINE_DROPPED,
+    COMBINE_CHANGED,
+    COMBINE_SAME
+} combine_status;
+
+static void* multimod_alloc(size_t n, size_t size) {
+    void* ptr = malloc(n ? n * size : 1);
+    if (!ptr) {
+        perror("Could not allocate memory in multimod_run");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+sum sum_mod_prime(const sum* const p, uint64_t prime) {
+    sum out = {
+        .n = 0,
+        .capacity = 0,
+        .terms = multimod_alloc(p->n ? p->n : 1, sizeof(term))
+    };
+    for (size_t i = 0; i < p->n; i++) {
+        uint64_t c = mod_reduce(p->terms[i].coeff, prime);
+        if (c) {
+            out.terms[out.n].exp = p->terms[i].exp;
+            out.terms[out.n].coeff = (long) c;
+            out.n++;
+        }
+    }
+    if (!out.n) {
+        out.terms[0] = (term){0};
+    }
+    return out;
+}
+
+void sum_eval_mod_batch(const sum* const p, const uint64_t* xs, size_t n, uint64_t prime, uint64_t* out) {
+    for (size_t j = 0; j < n; j++) out[j] = 0;
+    if (!p->n) return;
+    mod_barrett b = mod_barrett_init(prime);
+    int prev = p->terms[0].exp;
+    for (size_t i = 0; i < p->n; i++) {
+        uint64_t gap = (uint64_t) (prev - p->terms[i].exp);
+        uint64_t c = mod_reduce(p->terms[i].coeff, prime);
+        for (size_t j = 0; j < n; j++) {
+            uint64_t xg = gap == 1 ? xs[j] % prime : mod_pow(xs[j] % prime, gap, prime);
+            out[j] = mod_add(mod_barrett_mul(&b, out[j], xg), c, prime);
+        }
+        prev = p->terms[i].exp;
+    }
+    for (size_t j = 0; j < n; j++) {
+        if (prev) out[j] = mod_barrett_mul(&b, out[j], mod_pow(xs[j] % prime, (uint64_t) prev, prime));
+    }
+}
+
+static void prime_task_run(void* arg) {
+    prime_task* t = arg;
+    sum* images = multimod_alloc(t->ninputs, sizeof(sum));
+    for (size_t i = 0; i < t->ninputs; i++) {
+        images[i] = sum_mod_prime(&t->inputs[i], t->prime);
+    }
+    t->status = t->kernel(t->prime, images, t->ninputs, &t->image, t->ctx);
+    for (size_t i = 0; i < t->ninputs; i++) {
+        free_polynomial(&images[i]);
+    }
+    free(images);
+}
+
+static void crt_clear(crt_state* s) {
+    for (size_t i = 0; i < s->n; i++) {
+        mpint_free(&s->v[i]);
+    }
+    free(s->exps);
+    free(s->v);
+    mpint_free(&s->modulus);
+    *s = (crt_state){0};
+}
+
+/* v mod p, for a prime p below 2^63. */
+static uint64_t mpint_mod_word(const mp_int* const v, uint64_t p) {
+    mp_int P = mpint_from_long((long) p);
+    mp_int r = mpint_mod(v, &P);
+    uint64_t out = mod_reduce(mpint_to_long(&r), p);
+    mpint_free(&r);
+    mpint_free(&P);
+    return out;
+}
+
+/* Lifts the state by one image modulo p. Each coefficient v is replaced by v + M t, with t in the symmetric range
+ * of p chosen so that the new value matches the image; the reconstruction is unchanged exactly when every t is 0. */
+static combine_status crt_combine(crt_state* s, const sum* const image, uint64_t p, bool lower_degree_wins) {
+    int d = image->n ? image->terms[0].exp : INT_MIN;
+    if (s->used && lower_degree_wins && d != s->deg) {
+        if (d > s->deg) return COMBINE_DROPPED;
+        crt_clear(s);
+    }
+    if (!s->used) {
+        s->n = image->n;
+        s->exps = multimod_alloc(image->n, sizeof(int));
+        s->v = multimod_alloc(image->n, sizeof(mp_int));
+        for (size_t i = 0; i < image->n; i++) {
+            uint64_t c = (uint64_t) image->terms[i].coeff;
+            s->exps[i] = image->terms[i].exp;
+            s->v[i] = mpint_from_long(c > p / 2 ? (long) c - (long) p : (long) c);
+        }
+        s->modulus = mpint_from_long((long) p);
+        s->used = 1;
+        s->deg = d;
+        return COMBINE_CHANGED;
+    }
+
+    uint64_t minv = mod_inv(mpint_mod_word(&s->modulus, p), p);
+    size_t cap = s->n + image->n;
+    int* exps = multimod_alloc(cap, sizeof(int));
+    mp_int* v = multimod_alloc(cap, sizeof(mp_int));
+    bool changed = false;
+    size_t i = 0, j = 0, k = 0;
+    // merge the supports; a term missing on either side is zero there
+    while (i < s->n || j < image->n) {
+        int e;
+        mp_int cur;
+        uint64_t a = 0;
+        if (j >= image->n || (i < s->n && s->exps[i] > image->terms[j].exp)) {
+            e = s->exps[i];
+            cur = s->v[i++];
+        } else if (i >= s->n || image->terms[j].exp > s->exps[i]) {
+            e = image->terms[j].exp;
+            a = (uint64_t) image->terms[j++].coeff;
+            cur = mpint_from_long(0);
+        } else {
+            e = s->exps[i];
+            cur = s->v[i++];
+            a = (uint64_t) image->terms[j++].coeff;
+        }
+        uint64_t t = mod_mul(mod_sub(a, mpint_mod_word(&cur, p), p), minv, p);
+        if (t) {
+            changed = true;
+            mp_int ts = mpint_from_long(t > p / 2 ? (long) t - (long) p : (long) t);
+            mp_int step = mpint_prod(&s->modulus, &ts);
+            mp_int next = mpint_add(&cur, &step);
+            mpint_free(&ts);
+            mpint_free(&step);
+            mpint_free(&cur);
+            cur = next;
+        }
+        if (mpint_nz(&cur)) {
+            exps[k] = e;
+            v[k++] = cur;
+        } else {
+            mpint_free(&cur);
+        }
+    }
+    free(s->exps);
+    free(s->v);
+    s->exps = exps;
+    s->v = v;
+    s->n = k;
+
+    mp_int P = mpint_from_long((long) p);
+    mp_int m = mpint_prod(&s->modulus, &P);
+    mpint_free(&P);
+    mpint_free(&s->modulus);
+    s->modulus = m;
+    s->used++;
+    return changed ? COMBINE_CHANGED : COMBINE_SAME;
+}
+
+/* Whether 2 x^2 < m. */
+static bool below_half_sqrt(const mp_int* const x, const mp_int* const m) {
+    mp_int sq = mpint_prod(x, x);
+    mp_int twice = mpint_add(&sq, &sq);
+    bool out = mpint_lt(&twice, m);
+    mpint_free(&sq);
+    mpint_free(&twice);
+    return out;
+}
+
+/* Finds num / den = v modulo m with |num|, den < sqrt(m / 2) by the half extended Euclidean algorithm on (m, v).
+ * The fraction is unique when it exists. */
+static bool rational_reconstruct(const mp_int* const v, const mp_int* const m, mp_int* num, mp_int* den) {
+    mp_int r0 = mpint_copy(m);
+    mp_int r1 = mpint_lt_i(v, 0) ? mpint_add(v, m) : mpint_copy(v);
+    mp_int s0 = mpint_from_long(0);
+    mp_int s1 = mpint_from_long(1);
+    while (!below_half_sqrt(&r1, m)) {
+        mp_int q, r2;
+        mpint_divmod(&r0, &r1, &q, &r2);
+        mp_int qs = mpint_prod(&q, &s1);
+        mp_int s2 = mpint_sub(&s0, &qs);
+        mpint_free(&q);
+        mpint_free(&qs);
+        mpint_free(&r0);
+        mpint_free(&s0);
+        r0 = r1;
+        r1 = r2;
+        s0 = s1;
+        s1 = s2;
+    }
+    bool ok = below_half_sqrt(&s1, m);
+    if (ok) {
+        mp_int g = mpint_gcd(&r1, &s1);
+        ok = mpint_eq_i(&g, 1);
+        mpint_free(&g);
+    }
+    if (ok) {
+        mp_int zero = mpint_from_long(0);
+        if (mpint_lt_i(&s1, 0)) {
+            *num = mpint_sub(&zero, &r1);
+            *den = mpint_sub(&zero, &s1);
+        } else {
+            *num = mpint_copy(&r1);
+            *den = mpint_copy(&s1);
+        }
+        mpint_free(&zero);
+    }
+    mpint_free(&r0);
+    mpint_free(&r1);
+    mpint_free(&s0);
+    mpint_free(&s1);
+    return ok;
+}
+
+/* The candidate answer for the current state, or false if some coefficient has no rational reconstruction. */
+static bool build_result(const crt_state* const s, bool rational, multimod_result* out) {
+    multimod_result r = {
+        .n = s->n,
+        .exps = multimod_alloc(s->n, sizeof(int)),
+        .num = multimod_alloc(s->n, sizeof(mp_int)),
+        .den = rational ? multimod_alloc(s->n, sizeof(mp_int)) : NULL,
+        .modulus = mpint_copy(&s->modulus),
+        .primes_used = s->used
+    };
+    memcpy(r.exps, s->exps, s->n * sizeof(int));
+    for (size_t i = 0; i < s->n; i++) {
+        if (!rational) {
+            r.num[i] = mpint_copy(&s->v[i]);
+        } else if (!rational_reconstruct(&s->v[i], &s->modulus, &r.num[i], &r.den[i])) {
+            r.n = i;
+            multimod_result_free(&r);
+            return false;
+        }
+    }
+    *out = r;
+    return true;
+}
+
+static bool same_result(const multimod_result* const a, const multimod_result* const b) {
+    if (a->n != b->n) return false;
+    for (size_t i = 0; i < a->n; i++) {
+        if (a->exps[i] != b->exps[i] || !mpint_eq(&a->num[i], &b->num[i])) return false;
+        if (a->den && !mpint_eq(&a->den[i], &b->den[i])) return false;
+    }
+    return true;
+}
+
+int multimod_run(tpool* pool, const sum* inputs, size_t ninputs, multimod_kernel kernel, void* ctx,
+                 const multimod_opts* opts, multimod_result* out) {
+    multimod_opts o = opts ? *opts : (multimod_opts){0};
+    if (!o.max_primes) o.max_primes = MULTIMOD_DEFAULT_MAX_PRIMES;
+    // one prime per worker per round; images are combined in prime order, so the answer and the number of primes
+    // used do not depend on the number of threads
+    size_t batch = pool ? tpool_size(pool) : 1;
+    prime_task* tasks = multimod_alloc(batch, sizeof(prime_task));
+
+    crt_state s = {0};
+    multimod_result prev = {0};
+    bool have_prev = false;
+    bool done = false;
+    size_t next = 0;
+    while (!done && next < o.max_primes) {
+        size_t k = o.max_primes - next < batch ? o.max_primes - next : batch;
+        for (size_t i = 0; i < k; i++) {
+            tasks[i] = (prime_task){
+                .prime = mod_prime(next++),
+                .inputs = inputs, .ninputs = ninputs,
+                .kernel = kernel, .ctx = ctx,
+                .image = {0}
+            };
+            if (pool) {
+                tpool_submit(pool, prime_task_run, &tasks[i]);
+            } else {
+                prime_task_run(&tasks[i]);
+            }
+        }
+        if (pool) tpool_wait(pool);
+
+        for (size_t i = 0; i < k; i++) {
+            combine_status c = COMBINE_DROPPED;
+            if (!done && tasks[i].status == MULTIMOD_OK) {
+                c = crt_combine(&s, &tasks[i].image, tasks[i].prime, o.lower_degree_wins);
+            }
+            free_polynomial(&tasks[i].image);
+            if (done || c == COMBINE_DROPPED) continue;
+            if (c == COMBINE_CHANGED && !o.rational) {
+                continue;
+            }
+
+            multimod_result cand;
+            if (!build_result(&s, o.rational, &cand)) {
+                continue;
+            }
+            // integers are stable once a prime changes nothing; rationals once two reconstructions in a row agree
+            bool stable = o.rational ? have_prev && same_result(&prev, &cand) : s.used > 1;
+            if (stable && (!o.verify || o.verify(&cand, o.verify_ctx))) {
+                *out = cand;
+                done = true;
+            } else if (o.rational) {
+                if (have_prev) multimod_result_free(&prev);
+                prev = cand;
+                have_prev = true;
+            } else {
+                multimod_result_free(&cand);
+            }
+        }
+    }
+    if (have_prev) multimod_result_free(&prev);
+    crt_clear(&s);
+    free(tasks);
+    if (!done) {
+        *out = (multimod_result){0};
+        return -1;
+    }
+    return 0;
+}
+
+void multimod_result_free(multimod_result* r) {
+    if (!r) return;
+    for (size_t i = 0; i < r->n; i++) {
+        mpint_free(&r->num[i]);
+        if (r->den) mpint_free(&r->den[i]);
+    }
+    free(r->exps);
+    free(r->num);
+    free(r->den);
+    if (r->modulus.arr) mpint_free(&r->modulus);
+    *r = (multimod_result){0};
+}
+
+bool multimod_result_to_sum(const multimod_result* r, sum* out) {
+    for (size_t i = 0; i < r->n; i++) {
+        if (!mpint_fits_long(&r->num[i])) return false;
+        if (r->den && !mpint_eq_i(&r->den[i], 1)) return false;
+    }
+    if (!r->n) {
+        *out = zero_polynomial();
+        return true;
+    }
+    sum p = {
+        .n = r->n,
+        .capacity = 0,
+        .terms = multimod_alloc(r->n, sizeof(term))
+    };
+    for (size_t i = 0; i < r->n; i++) {
+        p.terms[i].exp = r->exps[i];
+        p.terms[i].coeff = mpint_to_long(&r->num[i]);
+    }
+    *out = p;
+    return true;
+}
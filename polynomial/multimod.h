@@ -0,0 +1,74 @@
+/** A multi-prime pipeline for modular algorithms. The inputs are reduced modulo word primes from the prime table
+ * (see numeric/modular.h), a caller-supplied kernel computes the image of the answer modulo each prime on a thread
+ * pool, and the images are combined in prime order by incremental Chinese remaindering, optionally followed by
+ * rational reconstruction. The pipeline stops as soon as a new prime leaves the reconstruction unchanged and the
+ * optional verify callback accepts it. */
+#ifndef MULTIMOD_H_INCLUDED
+#define MULTIMOD_H_INCLUDED
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "./sum.h"
+#include "../numeric/mp_int.h"
+#include "../util/thread_pool.h"
+
+/* Return values of a kernel. */
+#define MULTIMOD_OK 0
+/* The prime is bad for this problem (for instance it divides a leading coefficient); its image is dropped. */
+#define MULTIMOD_UNLUCKY 1
+
+/* Computes the image of the answer modulo prime from the images of the inputs, whose coefficients are in
+ * [0, prime). The output must be a sorted sum with coefficients in [0, prime); it is freed by the pipeline.
+ * Kernels for different primes run concurrently, so ctx must only be read. */
+typedef int (*multimod_kernel)(uint64_t prime, const sum* images, size_t nimages, sum* out, void* ctx);
+
+typedef struct multimod_result multimod_result;
+
+/* The reconstructed answer: terms with exponents exps, in decreasing order, and coefficients num / den. den is
+ * null unless rational reconstruction was requested, in which case every den is positive and coprime to its num. */
+struct multimod_result {
+    size_t n;
+    int* exps;
+    mp_int* num;
+    mp_int* den;
+    // product of the primes that were used
+    mp_int modulus;
+    size_t primes_used;
+};
+
+/* Accepts or rejects a stable reconstruction, for instance by checking a division over the integers. */
+typedef bool (*multimod_verify)(const multimod_result* candidate, void* ctx);
+
+typedef struct multimod_opts multimod_opts;
+
+struct multimod_opts {
+    // give up after this many primes; 0 means 1024
+    size_t max_primes;
+    // reconstruct rationals num / den with |num|, den < sqrt(modulus / 2) instead of integers in the symmetric range
+    bool rational;
+    // images of lower degree replace everything combined so far and images of higher degree are dropped, as
+    // unlucky primes do in modular gcd algorithms; otherwise a missing term is taken to be zero modulo that prime
+    bool lower_degree_wins;
+    multimod_verify verify;
+    void* verify_ctx;
+};
+
+/* Runs the pipeline on the workers of pool, one prime per task, or on the calling thread with a null pool. opts
+ * may be null. Returns 0 and fills out on success and -1 when max_primes is exhausted, in which case out is left
+ * empty. The result must be released with multimod_result_free. */
+int multimod_run(tpool* pool, const sum* inputs, size_t ninputs, multimod_kernel kernel, void* ctx,
+                 const multimod_opts* opts, multimod_result* out);
+
+void multimod_result_free(multimod_result* r);
+
+/* Converts an integer result whose coefficients fit in a long. Returns false, leaving out untouched, otherwise. */
+bool multimod_result_to_sum(const multimod_result* r, sum* out);
+
+/* The image of p modulo prime, with coefficients in [0, prime) and zero terms removed. */
+sum sum_mod_prime(const sum* const p, uint64_t prime);
+
+/* p(xs[i]) modulo prime into out[i] for i < n, for nonnegative exponents. The points go through Horner's rule
+ * together, so each coefficient is reduced once for all of them. */
+void sum_eval_mod_batch(const sum* const p, const uint64_t* xs, size_t n, uint64_t prime, uint64_t* out);
+
+#endif
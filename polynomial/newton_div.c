@@ -0,0 +1,229 @@
+#include "./newton_div.h"
+#include "./dense.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "stdint.h"
+#include "string.h"
+#include "pthread.h"
+#include "../util/instrument.h"
+
+/* Number of divisors whose inverses are remembered per thread by newton_divrem. */
+#define NEWTON_CACHE_SIZE 4
+
+struct newton_inv {
+    sum q;
+    /* the divisor as a dense vector, and reversed: rev[i] is the coefficient of x^(m - i) in q */
+    long* dense;
+    long* rev;
+    size_t len;
+    /* the first prec coefficients of 1 / rev(q) as a power series */
+    long* h;
+    size_t prec;
+};
+
+bool newton_applicable(const sum* const q) {
+    if (!q->n || q->terms[q->n - 1].exp < 0) {
+        return false;
+    }
+    return lc(q) == 1 || lc(q) == -1;
+}
+
+newton_inv* newton_inv_init(const sum* const q) {
+    newton_inv* inv = malloc(sizeof(newton_inv));
+    if (!inv) {
+        perror("Could not allocate memory in newton_inv_init");
+        exit(EXIT_FAILURE);
+    }
+    inv->q.n = q->n;
+    inv->q.capacity = 0;
+    inv->q.terms = malloc(q->n * sizeof(term));
+    inv->dense = dense_from_sum(q, &inv->len);
+    inv->rev = malloc(inv->len * sizeof(long));
+    inv->h = malloc(sizeof(long));
+    if (!inv->q.terms || !inv->rev || !inv->h) {
+        perror("Could not allocate memory in newton_inv_init");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(inv->q.terms, q->terms, q->n * sizeof(term));
+    for (size_t i = 0; i < inv->len; i++) {
+        inv->rev[i] = inv->dense[inv->len - 1 - i];
+    }
+    // lc(q) is a unit, and its own inverse
+    inv->h[0] = lc(q);
+    inv->prec = 1;
+    return inv;
+}
+
+void newton_inv_free(newton_inv* inv) {
+    if (!inv) {
+        return;
+    }
+    free(inv->q.terms);
+    free(inv->dense);
+    free(inv->rev);
+    free(inv->h);
+    free(inv);
+}
+
+/* Extends the inverse to at least k coefficients with h <- h (2 - rev(q) h) mod x^(2 prec). */
+static void extend_inverse(newton_inv* inv, size_t k) {
+    if (inv->prec >= k) {
+        return;
+    }
+    long* t = malloc(2 * k * sizeof(long));
+    long* u = malloc(2 * k * sizeof(long));
+    if (!t || !u) {
+        perror("Could not allocate memory in extend_inverse");
+        exit(EXIT_FAILURE);
+    }
+    while (inv->prec < k) {
+        size_t next = 2 * inv->prec < k ? 2 * inv->prec : k;
+        size_t nr = inv->len < next ? inv->len : next;
+
+        // t = 2 - rev(q) h mod x^next
+        dense_mul(inv->rev, nr, inv->h, inv->prec, t);
+        for (size_t i = 0; i < next; i++) {
+            t[i] = (long) (0 - (uint64_t) (i < nr + inv->prec - 1 ? t[i] : 0));
+        }
+        t[0] = (long) ((uint64_t) t[0] + 2);
+
+        // h = h t mod x^next
+        dense_mul(inv->h, inv->prec, t, next, u);
+        long* h = realloc(inv->h, next * sizeof(long));
+        if (!h) {
+            perror("Could not allocate memory in extend_inverse");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(h, u, next * sizeof(long));
+        inv->h = h;
+        inv->prec = next;
+    }
+    free(t);
+    free(u);
+}
+
+void newton_divrem_pre(const sum* const p, newton_inv* inv, sum* quot, sum* rem) {
+    size_t m = inv->len - 1;
+    if (!p->n || deg(p) < (int) m) {
+        if (quot) *quot = zero_polynomial();
+        if (rem) *rem = p->n ? scalar_prod(1, p) : zero_polynomial();
+        return;
+    }
+    size_t np;
+    long* a = dense_from_sum(p, &np);
+    size_t k = np - m;
+    extend_inverse(inv, k);
+
+    // rev(quotient) = rev(p) / rev(q) mod x^k
+    long* revp = malloc(k * sizeof(long));
+    long* t = malloc((2 * k) * sizeof(long));
+    if (!revp || !t) {
+        perror("Could not allocate memory in newton_divrem_pre");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < k; i++) {
+        revp[i] = a[np - 1 - i];
+    }
+    dense_mul(revp, k, inv->h, k, t);
+    long* qc = revp;
+    for (size_t i = 0; i < k; i++) {
+        qc[i] = t[k - 1 - i];
+    }
+    free(t);
+
+    if (rem) {
+        // the remainder is p - quotient * q, which lives in the low m coefficients
+        long* prod_qc = malloc((k + m) * sizeof(long));
+        if (!prod_qc) {
+            perror("Could not allocate memory in newton_divrem_pre");
+            exit(EXIT_FAILURE);
+        }
+        dense_mul(qc, k, inv->dense, inv->len, prod_qc);
+        for (size_t i = 0; i < m; i++) {
+            a[i] = (long) ((uint64_t) a[i] - (uint64_t) prod_qc[i]);
+        }
+        *rem = dense_to_sum(a, m);
+        free(prod_qc);
+    }
+    if (quot) {
+        *quot = dense_to_sum(qc, k);
+    }
+    free(qc);
+    free(a);
+}
+
+/* Compares field by field, since the padding after each exponent is not guaranteed to match. */
+static int same_divisor(const sum* const a, const sum* const b) {
+    if (a->n != b->n) return 0;
+    for (size_t i = 0; i < a->n; i++) {
+        if (a->terms[i].exp != b->terms[i].exp || a->terms[i].coeff != b->terms[i].coeff) return 0;
+    }
+    return 1;
+}
+
+/* Least recently used inverses are evicted first; slot 0 is the most recent. */
+static _Thread_local newton_inv* cache[NEWTON_CACHE_SIZE];
+
+/* A thread that fills its cache registers it under this key, whose destructor empties it when the thread exits. */
+static pthread_key_t cache_key;
+static pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+
+static void release_cache(void* arg) {
+    newton_inv** c = arg;
+    for (size_t i = 0; i < NEWTON_CACHE_SIZE; i++) {
+        newton_inv_free(c[i]);
+        c[i] = NULL;
+    }
+}
+
+static void make_cache_key() {
+    if (pthread_key_create(&cache_key, release_cache)) {
+        perror("Could not create the newton cache key");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void newton_cache_clear() {
+    release_cache(cache);
+}
+
+static newton_inv* cached_inverse(const sum* const q) {
+    size_t i = 0;
+    while (i < NEWTON_CACHE_SIZE && cache[i] && !same_divisor(&cache[i]->q, q)) {
+        i++;
+    }
+    newton_inv* inv;
+    if (i < NEWTON_CACHE_SIZE && cache[i]) {
+        inv = cache[i];
+    } else {
+        if (i == NEWTON_CACHE_SIZE) {
+            i--;
+            newton_inv_free(cache[i]);
+        }
+        inv = newton_inv_init(q);
+        if (!cache[0]) {
+            pthread_once(&cache_key_once, make_cache_key);
+            pthread_setspecific(cache_key, cache);
+        }
+    }
+    memmove(cache + 1, cache, i * sizeof(newton_inv*));
+    cache[0] = inv;
+    return inv;
+}
+
+void newton_divrem(const sum* const p, const sum* const q, sum* quot, sum* rem) {
+    newton_divrem_pre(p, cached_inverse(q), quot, rem);
+}
+
+sum newton_quo(const sum* const p, const sum* const q) {
+    sum out;
+    newton_divrem(p, q, &out, 0);
+    return out;
+}
+
+sum newton_rem(const sum* const p, const sum* const q) {
+    sum out;
+    newton_divrem(p, q, 0, &out);
+    return out;
+}
@@ -0,0 +1,44 @@
+/** Fast division for large dense polynomials. The reversed divisor is inverted as a power series by Newton
+ * iteration, after which the quotient costs two multiplications with dense_mul, which switches to Karatsuba
+ * multiplication for large operands. Over the integers the power series inverse exists when lc(q) = 1 or -1, so
+ * this path is limited to such divisors; quo and rem fall back to the other methods for the rest.
+ *
+ * The inverse of a divisor can be kept in a newton_inv and reused by every division by that divisor, as in a
+ * remainder sequence or a reduction modulo a fixed polynomial. Its precision is extended on demand. */
+#ifndef NEWTON_DIV_H_INCLUDED
+#define NEWTON_DIV_H_INCLUDED
+
+#include <stdbool.h>
+#include "./sum.h"
+
+/* Divisions whose quotient has at least this many coefficients, by divisors of at least NEWTON_MIN_DIVISOR
+ * coefficients, are routed here by quo and rem. */
+#define NEWTON_MIN_QUOTIENT 128
+#define NEWTON_MIN_DIVISOR 32
+
+typedef struct newton_inv newton_inv;
+
+/* Returns true if newton division applies to q: lc(q) is 1 or -1 and all exponents are nonnegative. */
+bool newton_applicable(const sum* const q);
+
+/* Precomputes the inverse of the reversed divisor q. q must satisfy newton_applicable. q is copied. */
+newton_inv* newton_inv_init(const sum* const q);
+
+void newton_inv_free(newton_inv* inv);
+
+/* Quotient and remainder of p by the divisor of inv, as quo and rem would compute them. p must have nonnegative
+ * exponents. Either output may be null. */
+void newton_divrem_pre(const sum* const p, newton_inv* inv, sum* quot, sum* rem);
+
+/* As newton_divrem_pre, looking the inverse of q up in a small per-thread cache of recent divisors. A thread's
+ * cache is freed when the thread exits. */
+void newton_divrem(const sum* const p, const sum* const q, sum* quot, sum* rem);
+
+/* Frees the inverses cached by the calling thread, for a thread that keeps running, such as the main one. */
+void newton_cache_clear();
+
+sum newton_quo(const sum* const p, const sum* const q);
+
+sum newton_rem(const sum* const p, const sum* const q);
+
+#endif
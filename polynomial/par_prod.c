@@ -0,0 +1,199 @@
+#include "./par_prod.h"
+#include "./dense.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "stdint.h"
+#include "string.h"
+#include "../util/instrument.h"
+
+typedef struct dense_block dense_block;
+
+/* The product of coefficients [lo, hi) of a with all of b, in a buffer of its own. */
+struct dense_block {
+    const long* a;
+    size_t lo;
+    size_t hi;
+    const long* b;
+    size_t nb;
+    long* out;
+};
+
+static void dense_block_task(void* arg) {
+    dense_block* t = arg;
+    t->out = malloc((t->hi - t->lo + t->nb - 1) * sizeof(long));
+    if (!t->out) {
+        perror("Could not allocate memory in par_prod");
+        exit(EXIT_FAILURE);
+    }
+    dense_mul(t->a + t->lo, t->hi - t->lo, t->b, t->nb, t->out);
+}
+
+typedef struct sparse_chunk sparse_chunk;
+
+/* The product of terms [lo, hi) of p with q. */
+struct sparse_chunk {
+    const sum* p;
+    const sum* q;
+    size_t lo;
+    size_t hi;
+    sum out;
+};
+
+static void sparse_chunk_task(void* arg) {
+    sparse_chunk* t = arg;
+    sum piece = {
+        .n = t->hi - t->lo,
+        .capacity = 0,
+        .terms = t->p->terms + t->lo
+    };
+    t->out = prod(&piece, t->q);
+}
+
+typedef struct merge_pair merge_pair;
+
+struct merge_pair {
+    sum* left;
+    sum* right;
+};
+
+/* Merges right into left and frees right. */
+static void merge_task(void* arg) {
+    merge_pair* m = arg;
+    add_inplace(m->left, m->right);
+    free_polynomial(m->right);
+}
+
+/* Dense vector of p shifted down by its lowest exponent. */
+static long* shifted_dense(const sum* const p, size_t* len) {
+    int lo = p->terms[p->n - 1].exp;
+    *len = (size_t) ((long) deg(p) - lo + 1);
+    long* c = calloc(*len, sizeof(long));
+    if (!c) {
+        perror("Could not allocate memory in par_prod");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < p->n; i++) {
+        c[p->terms[i].exp - lo] = p->terms[i].coeff;
+    }
+    return c;
+}
+
+static sum par_prod_dense(tpool* pool, const sum* const p, const sum* const q, size_t ntasks) {
+    size_t na, nb;
+    long* a = shifted_dense(p, &na);
+    long* b = shifted_dense(q, &nb);
+    if (na < nb) {
+        long* t = a;
+        a = b;
+        b = t;
+        size_t n = na;
+        na = nb;
+        nb = n;
+    }
+    size_t nout = na + nb - 1;
+    if (ntasks > na) ntasks = na;
+    long* out = calloc(nout, sizeof(long));
+    dense_block* blocks = malloc(ntasks * sizeof(dense_block));
+    if (!out || !blocks) {
+        perror("Could not allocate memory in par_prod");
+        exit(EXIT_FAILURE);
+    }
+    // each task multiplies a slice of the longer operand by the shorter one with dense_mul, so the blocks get
+    // Karatsuba multiplication once they are long enough
+    for (size_t t = 0; t < ntasks; t++) {
+        blocks[t] = (dense_block){
+            .a = a, .b = b, .nb = nb,
+            .lo = na * t / ntasks,
+            .hi = na * (t + 1) / ntasks
+        };
+        tpool_submit(pool, dense_block_task, &blocks[t]);
+    }
+    tpool_wait(pool);
+    // neighbouring slices overlap in nb - 1 coefficients; the sums wrap, so their order does not change the result
+    for (size_t t = 0; t < ntasks; t++) {
+        size_t len = blocks[t].hi - blocks[t].lo + nb - 1;
+        long* o = out + blocks[t].lo;
+        for (size_t i = 0; i < len; i++) {
+            o[i] = (long) ((uint64_t) o[i] + (uint64_t) blocks[t].out[i]);
+        }
+        free(blocks[t].out);
+    }
+
+    // out[k] is the coefficient of x^(k + lowest exponents)
+    int shift = p->terms[p->n - 1].exp + q->terms[q->n - 1].exp;
+    size_t k = 0;
+    for (size_t i = 0; i < nout; i++) {
+        if (out[i]) k++;
+    }
+    sum g;
+    if (!k) {
+        g = zero_polynomial();
+    } else {
+        g.n = k;
+        g.capacity = 0;
+        g.terms = malloc(k * sizeof(term));
+        if (!g.terms) {
+            perror("Could not allocate memory in par_prod");
+            exit(EXIT_FAILURE);
+        }
+        k = 0;
+        for (size_t i = nout; i-- > 0;) {
+            if (out[i]) {
+                g.terms[k].exp = (int) i + shift;
+                g.terms[k].coeff = out[i];
+                k++;
+            }
+        }
+    }
+    free(blocks);
+    free(out);
+    free(a);
+    free(b);
+    return g;
+}
+
+static sum par_prod_sparse(tpool* pool, const sum* const p, const sum* const q, size_t ntasks) {
+    if (ntasks > p->n) ntasks = p->n;
+    sparse_chunk* chunks = malloc(ntasks * sizeof(sparse_chunk));
+    merge_pair* pairs = malloc(ntasks * sizeof(merge_pair));
+    if (!chunks || !pairs) {
+        perror("Could not allocate memory in par_prod");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t t = 0; t < ntasks; t++) {
+        chunks[t] = (sparse_chunk){
+            .p = p, .q = q,
+            .lo = p->n * t / ntasks,
+            .hi = p->n * (t + 1) / ntasks
+        };
+        tpool_submit(pool, sparse_chunk_task, &chunks[t]);
+    }
+    tpool_wait(pool);
+
+    // merge neighbouring chunks in rounds, in parallel within a round; the order of additions is fixed
+    for (size_t width = 1; width < ntasks; width *= 2) {
+        size_t npairs = 0;
+        for (size_t t = 0; t + width < ntasks; t += 2 * width) {
+            pairs[npairs] = (merge_pair){.left = &chunks[t].out, .right = &chunks[t + width].out};
+            tpool_submit(pool, merge_task, &pairs[npairs]);
+            npairs++;
+        }
+        tpool_wait(pool);
+    }
+    sum g = chunks[0].out;
+    free(chunks);
+    free(pairs);
+    return g;
+}
+
+sum par_prod(tpool* pool, const sum* const p, const sum* const q) {
+    if (!pool || !p->n || !q->n || p->n * q->n < PAR_PROD_MIN_WORK) {
+        return prod(p, q);
+    }
+    size_t ntasks = tpool_size(pool) * PAR_PROD_TASKS_PER_THREAD;
+    if (is_dense(p) && is_dense(q)) {
+        return par_prod_dense(pool, p, q, ntasks);
+    }
+    return par_prod_sparse(pool, p, q, ntasks);
+}
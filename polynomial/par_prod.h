@@ -0,0 +1,21 @@
+/** Parallel polynomial multiplication on a thread pool (see util/thread_pool.h). Dense products split the longer
+ * operand into slices, multiply each by the shorter one with dense_mul (Karatsuba for long slices) and add the
+ * overlapping results. Sparse products are split into chunks of the first operand, multiplied into per-task
+ * buffers, and merged in a fixed order. Either way the result does not depend on the number of threads or on
+ * scheduling. */
+#ifndef PAR_PROD_H_INCLUDED
+#define PAR_PROD_H_INCLUDED
+
+#include "./sum.h"
+#include "../util/thread_pool.h"
+
+/* Products with fewer than this many term-by-term multiplications are left to prod. */
+#define PAR_PROD_MIN_WORK (1 << 16)
+
+/* Number of tasks created per thread, so that stealing can even out uneven blocks. */
+#define PAR_PROD_TASKS_PER_THREAD 4
+
+/* p * q, computed on the workers of pool. With a null pool, computes prod(p, q). */
+sum par_prod(tpool* pool, const sum* const p, const sum* const q);
+
+#endif
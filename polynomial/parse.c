@@ -0,0 +1,334 @@
+#include "./parse.h"
+#include "../util/term_sort.h"
+
+#include "stdbool.h"
+#include "stdlib.h"
+#include "string.h"
+#include "limits.h"
+#include "../util/instrument.h"
+
+typedef struct scanner scanner;
+
+struct scanner {
+    const char* s;
+    size_t len;
+    size_t pos;
+    // the variable, once a term has named it
+    const char* var;
+    size_t var_len;
+    parse_error err;
+};
+
+/* A term as written: the coefficient is left as digits so that each caller can convert it as it needs. */
+typedef struct raw_term raw_term;
+
+struct raw_term {
+    bool neg;
+    // no digits means an implicit coefficient of 1
+    const char* digits;
+    size_t ndigits;
+    int exp;
+    // where the term starts, for errors
+    size_t pos;
+};
+
+static const char* const messages[] = {
+    [PARSE_OK] = "ok",
+    [PARSE_SYNTAX] = "syntax error",
+    [PARSE_OVERFLOW] = "coefficient does not fit in a long",
+    [PARSE_EXPONENT] = "exponent does not fit in an int",
+    [PARSE_VARIABLE] = "more than one variable"
+};
+
+const char* parse_strerror(parse_status status) {
+    return status <= PARSE_VARIABLE ? messages[status] : "unknown error";
+}
+
+static void* parse_alloc(void* ptr, size_t n, size_t size) {
+    ptr = reallocarray(ptr, n ? n : 1, size);
+    if (!ptr) {
+        perror("Could not allocate memory in parse");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static void skip_spaces(scanner* sc) {
+    while (sc->pos < sc->len && (sc->s[sc->pos] == ' ' || sc->s[sc->pos] == '\t')) sc->pos++;
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool is_ident_start(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static int fail(scanner* sc, parse_status status, size_t pos) {
+    sc->err = (parse_error){.status = status, .pos = pos};
+    return -1;
+}
+
+/* Scans the next term. Returns 1 for a term, 0 at the end of the expression and -1 on an error, which is left in
+ * sc->err. Every term but the first must start with a sign. */
+static int next_term(scanner* sc, raw_term* t, bool first) {
+    skip_spaces(sc);
+    if (sc->pos == sc->len) {
+        return first ? fail(sc, PARSE_SYNTAX, sc->pos) : 0;
+    }
+    *t = (raw_term){.pos = sc->pos};
+    char c = sc->s[sc->pos];
+    if (c == '+' || c == '-') {
+        t->neg = c == '-';
+        sc->pos++;
+        skip_spaces(sc);
+    } else if (!first) {
+        return fail(sc, PARSE_SYNTAX, sc->pos);
+    }
+
+    size_t start = sc->pos;
+    while (sc->pos < sc->len && is_digit(sc->s[sc->pos])) sc->pos++;
+    t->digits = sc->s + start;
+    t->ndigits = sc->pos - start;
+    skip_spaces(sc);
+    if (t->ndigits && sc->pos < sc->len && sc->s[sc->pos] == '*') {
+        sc->pos++;
+        skip_spaces(sc);
+        if (sc->pos == sc->len || !is_ident_start(sc->s[sc->pos])) return fail(sc, PARSE_SYNTAX, sc->pos);
+    }
+
+    if (sc->pos < sc->len && is_ident_start(sc->s[sc->pos])) {
+        size_t vstart = sc->pos;
+        while (sc->pos < sc->len && (is_ident_start(sc->s[sc->pos]) || is_digit(sc->s[sc->pos]))) sc->pos++;
+        size_t vlen = sc->pos - vstart;
+        if (!sc->var) {
+            sc->var = sc->s + vstart;
+            sc->var_len = vlen;
+        } else if (vlen != sc->var_len || memcmp(sc->var, sc->s + vstart, vlen)) {
+            return fail(sc, PARSE_VARIABLE, vstart);
+        }
+        t->exp = 1;
+        skip_spaces(sc);
+        if (sc->pos < sc->len && sc->s[sc->pos] == '^') {
+            sc->pos++;
+            skip_spaces(sc);
+            size_t estart = sc->pos;
+            bool neg = estart < sc->len && sc->s[estart] == '-';
+            if (neg) {
+                sc->pos++;
+                skip_spaces(sc);
+            }
+            if (sc->pos == sc->len || !is_digit(sc->s[sc->pos])) return fail(sc, PARSE_SYNTAX, sc->pos);
+            // accumulate with the exponent's sign, so that INT_MIN reads back
+            int e = 0;
+            while (sc->pos < sc->len && is_digit(sc->s[sc->pos])) {
+                int d = sc->s[sc->pos] - '0';
+                if (__builtin_mul_overflow(e, 10, &e) || __builtin_add_overflow(e, neg ? -d : d, &e)) {
+                    return fail(sc, PARSE_EXPONENT, estart);
+                }
+                sc->pos++;
+            }
+            t->exp = e;
+        }
+    } else if (!t->ndigits) {
+        return fail(sc, PARSE_SYNTAX, sc->pos);
+    }
+    return 1;
+}
+
+/* The coefficient of t as a long, or false if it does not fit. */
+static bool coeff_to_long(const raw_term* const t, long* out) {
+    if (!t->ndigits) {
+        *out = t->neg ? -1 : 1;
+        return true;
+    }
+    // accumulate the magnitude, which may be one more than LONG_MAX for LONG_MIN
+    unsigned long m = 0;
+    for (size_t i = 0; i < t->ndigits; i++) {
+        if (__builtin_mul_overflow(m, 10UL, &m) || __builtin_add_overflow(m, (unsigned long) (t->digits[i] - '0'), &m)) {
+            return false;
+        }
+    }
+    if (m > (unsigned long) LONG_MAX + t->neg) return false;
+    *out = t->neg ? (long) (0 - m) : (long) m;
+    return true;
+}
+
+parse_status parse_sum(const char* s, size_t len, sum* out, parse_error* err) {
+    scanner sc = {.s = s, .len = len};
+    // a term takes at least two characters, except for the first
+    size_t cap = len / 2 + 1;
+    term* terms = parse_alloc(NULL, cap, sizeof(term));
+    size_t n = 0;
+    bool sorted = true;
+    raw_term t;
+    int got;
+    for (bool first = true; (got = next_term(&sc, &t, first)) == 1; first = false) {
+        long c;
+        if (!coeff_to_long(&t, &c)) {
+            fail(&sc, PARSE_OVERFLOW, t.pos);
+            got = -1;
+            break;
+        }
+        if (n && terms[n - 1].exp == t.exp) {
+            // combine with the previous term as we go, which covers like terms written next to each other
+            if (__builtin_add_overflow(terms[n - 1].coeff, c, &terms[n - 1].coeff)) {
+                fail(&sc, PARSE_OVERFLOW, t.pos);
+                got = -1;
+                break;
+            }
+            continue;
+        }
+        if (n && terms[n - 1].exp < t.exp) sorted = false;
+        terms[n++] = (term){.exp = t.exp, .coeff = c};
+    }
+    if (got < 0) {
+        free(terms);
+        if (err) *err = sc.err;
+        return sc.err.status;
+    }
+
+    if (!sorted) {
+        sort_terms(n, terms);
+        size_t k = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (k && terms[k - 1].exp == terms[i].exp) {
+                if (__builtin_add_overflow(terms[k - 1].coeff, terms[i].coeff, &terms[k - 1].coeff)) {
+                    free(terms);
+                    if (err) *err = (parse_error){.status = PARSE_OVERFLOW, .pos = 0};
+                    return PARSE_OVERFLOW;
+                }
+            } else {
+                terms[k++] = terms[i];
+            }
+        }
+        n = k;
+    }
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (terms[i].coeff) terms[k++] = terms[i];
+    }
+    if (!k) {
+        free(terms);
+        *out = zero_polynomial();
+    } else {
+        *out = (sum){
+            .n = k,
+            .capacity = 0,
+            .terms = k < cap ? parse_alloc(terms, k, sizeof(term)) : terms
+        };
+    }
+    if (err) *err = (parse_error){.status = PARSE_OK};
+    return PARSE_OK;
+}
+
+typedef struct big_term big_term;
+
+struct big_term {
+    int exp;
+    mp_int coeff;
+};
+
+static int cmp_big_terms(const void* a, const void* b) {
+    int ea = ((const big_term*) a)->exp;
+    int eb = ((const big_term*) b)->exp;
+    return (ea < eb) - (ea > eb);
+}
+
+parse_status parse_mp_sum(const char* s, size_t len, mp_sum* out, parse_error* err) {
+    scanner sc = {.s = s, .len = len};
+    size_t cap = len / 2 + 1;
+    big_term* terms = parse_alloc(NULL, cap, sizeof(big_term));
+    size_t n = 0;
+    bool sorted = true;
+    raw_term t;
+    int got;
+    for (bool first = true; (got = next_term(&sc, &t, first)) == 1; first = false) {
+        mp_int c = t.ndigits ? mpint_from_digits(t.digits, t.ndigits, t.neg) : mpint_from_long(t.neg ? -1 : 1);
+        if (n && terms[n - 1].exp < t.exp) sorted = false;
+        terms[n++] = (big_term){.exp = t.exp, .coeff = c};
+    }
+    if (got < 0) {
+        for (size_t i = 0; i < n; i++) mpint_free(&terms[i].coeff);
+        free(terms);
+        if (err) *err = sc.err;
+        return sc.err.status;
+    }
+
+    if (!sorted) qsort(terms, n, sizeof(big_term), cmp_big_terms);
+    mp_sum p = {
+        .n = 0,
+        .exps = parse_alloc(NULL, n, sizeof(int)),
+        .coeffs = parse_alloc(NULL, n, sizeof(mp_int))
+    };
+    for (size_t i = 0; i < n;) {
+        mp_int c = terms[i].coeff;
+        size_t j = i + 1;
+        for (; j < n && terms[j].exp == terms[i].exp; j++) {
+            mp_int next = mpint_add(&c, &terms[j].coeff);
+            mpint_free(&c);
+            mpint_free(&terms[j].coeff);
+            c = next;
+        }
+        if (mpint_nz(&c)) {
+            p.exps[p.n] = terms[i].exp;
+            p.coeffs[p.n++] = c;
+        } else {
+            mpint_free(&c);
+        }
+        i = j;
+    }
+    free(terms);
+    *out = p;
+    if (err) *err = (parse_error){.status = PARSE_OK};
+    return PARSE_OK;
+}
+
+struct parse_reader {
+    FILE* in;
+    char* line;
+    size_t cap;
+    size_t lineno;
+};
+
+parse_reader* parse_reader_open(FILE* in) {
+    parse_reader* r = parse_alloc(NULL, 1, sizeof(parse_reader));
+    *r = (parse_reader){.in = in};
+    return r;
+}
+
+/* The next line that holds an expression, without its line ending, or -1 at the end of the input. */
+static ssize_t next_line(parse_reader* r) {
+    ssize_t n;
+    while ((n = getline(&r->line, &r->cap, r->in)) >= 0) {
+        r->lineno++;
+        while (n && (r->line[n - 1] == '\n' || r->line[n - 1] == '\r')) n--;
+        size_t i = 0;
+        while (i < (size_t) n && (r->line[i] == ' ' || r->line[i] == '\t')) i++;
+        if (i < (size_t) n && r->line[i] != '#') return n;
+    }
+    return -1;
+}
+
+int parse_next(parse_reader* r, sum* out, parse_error* err) {
+    ssize_t n = next_line(r);
+    if (n < 0) return 0;
+    return parse_sum(r->line, (size_t) n, out, err) == PARSE_OK ? 1 : -1;
+}
+
+int parse_next_mp(parse_reader* r, mp_sum* out, parse_error* err) {
+    ssize_t n = next_line(r);
+    if (n < 0) return 0;
+    return parse_mp_sum(r->line, (size_t) n, out, err) == PARSE_OK ? 1 : -1;
+}
+
+size_t parse_reader_line(const parse_reader* const r) {
+    return r->lineno;
+}
+
+void parse_reader_free(parse_reader* r) {
+    if (!r) return;
+    free(r->line);
+    free(r);
+}
@@ -0,0 +1,61 @@
+/** Parsing polynomials from text such as "3x^5 - 2x + 7" or "-x^2 + 4*x^2 + 12345678901234567890123". A term is an
+ * optional decimal coefficient, optionally followed by '*', and an optional variable raised to an optional power
+ * with '^', which may be negative as in "x^-2", the form format_sum writes. Terms are separated by '+' or '-',
+ * spaces are ignored anywhere between tokens, and the variable may have any name as long as every term uses the
+ * same one. Terms may come in any order and may repeat exponents: like terms are combined and the result is
+ * sorted. Input that is already in decreasing order skips the sort, so the common case is a single pass over the
+ * text and a single allocation. */
+#ifndef PARSE_H_INCLUDED
+#define PARSE_H_INCLUDED
+
+#include <stddef.h>
+#include <stdio.h>
+#include "./sum.h"
+#include "./mp_sum.h"
+
+typedef enum {
+    PARSE_OK,
+    PARSE_SYNTAX,
+    // a coefficient, or a sum of like terms, does not fit in a long; parse_mp_sum accepts it
+    PARSE_OVERFLOW,
+    // an exponent does not fit in an int
+    PARSE_EXPONENT,
+    // two terms use different variables
+    PARSE_VARIABLE
+} parse_status;
+
+typedef struct parse_error parse_error;
+
+struct parse_error {
+    parse_status status;
+    // offset into the expression where the error was found
+    size_t pos;
+};
+
+const char* parse_strerror(parse_status status);
+
+/* Parses the len bytes of s into out. On failure out is untouched and err, which may be null, says where. */
+parse_status parse_sum(const char* s, size_t len, sum* out, parse_error* err);
+
+/* As parse_sum, with coefficients of any size. */
+parse_status parse_mp_sum(const char* s, size_t len, mp_sum* out, parse_error* err);
+
+/* Reads expressions from a stream, one per line. Blank lines and lines starting with '#' are skipped. The line
+ * buffer is reused from one expression to the next. */
+typedef struct parse_reader parse_reader;
+
+parse_reader* parse_reader_open(FILE* in);
+
+/* Returns 1 and fills out with the next expression, 0 at the end of the input, or -1 if the expression does not
+ * parse, in which case err is filled in and the next call moves on to the following line. */
+int parse_next(parse_reader* r, sum* out, parse_error* err);
+
+int parse_next_mp(parse_reader* r, mp_sum* out, parse_error* err);
+
+/* Line number, starting from 1, of the expression last returned. */
+size_t parse_reader_line(const parse_reader* const r);
+
+/* Frees the reader, but does not close its stream. */
+void parse_reader_free(parse_reader* r);
+
+#endif
@@ -0,0 +1,211 @@
+#include "./precurrence.h"
+#include "./bsplit.h"
+#include "../numeric/modular.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "stdbool.h"
+#include "../util/instrument.h"
+
+/* The product M(hi - 1) ... M(lo) of the companion matrices over a range, row-major, with the product of the
+ * values of the leading coefficient. */
+typedef struct prec_mat prec_mat;
+
+struct prec_mat {
+    mp_int* e;
+    mp_int den;
+};
+
+typedef struct prec_ctx prec_ctx;
+
+struct prec_ctx {
+    const sum* c;
+    size_t r;
+    // set when the leading coefficient vanishes in the range
+    bool singular;
+};
+
+static void* prec_alloc(size_t n, size_t size) {
+    void* ptr = calloc(n ? n : 1, size);
+    if (!ptr) {
+        perror("Could not allocate memory in precurrence");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static void free_mat(prec_mat* m, size_t r) {
+    for (size_t i = 0; i < r * r; i++) mpint_free(&m->e[i]);
+    free(m->e);
+    mpint_free(&m->den);
+}
+
+/* M(n): c[r](n) on the superdiagonal and -c[0](n), ..., -c[r-1](n) in the last row. */
+static void leaf(prec_ctx* ctx, long n, prec_mat* out) {
+    size_t r = ctx->r;
+    out->e = prec_alloc(r * r, sizeof(mp_int));
+    // prec_eval checked the exponents
+    mpint_eval_sum(&ctx->c[r], n, &out->den);
+    if (!mpint_nz(&out->den)) ctx->singular = true;
+    mp_int zero = mpint_from_long(0);
+    for (size_t i = 0; i + 1 < r; i++) {
+        for (size_t j = 0; j < r; j++) {
+            out->e[i * r + j] = j == i + 1 ? mpint_copy(&out->den) : mpint_from_long(0);
+        }
+    }
+    for (size_t j = 0; j < r; j++) {
+        mp_int v;
+        mpint_eval_sum(&ctx->c[j], n, &v);
+        out->e[(r - 1) * r + j] = mpint_sub(&zero, &v);
+        mpint_free(&v);
+    }
+    mpint_free(&zero);
+}
+
+/* out = right left, freeing both. Zero entries, of which the leaves have many, are skipped. */
+static void combine(size_t r, prec_mat* left, prec_mat* right, prec_mat* out) {
+    prec_mat m = {
+        .e = prec_alloc(r * r, sizeof(mp_int)),
+        .den = mpint_prod(&left->den, &right->den)
+    };
+    for (size_t i = 0; i < r; i++) {
+        for (size_t j = 0; j < r; j++) {
+            mp_int acc = mpint_from_long(0);
+            for (size_t k = 0; k < r; k++) {
+                if (!mpint_nz(&right->e[i * r + k]) || !mpint_nz(&left->e[k * r + j])) continue;
+                mp_int t = mpint_prod(&right->e[i * r + k], &left->e[k * r + j]);
+                mp_int s = mpint_add(&acc, &t);
+                mpint_free(&acc);
+                mpint_free(&t);
+                acc = s;
+            }
+            m.e[i * r + j] = acc;
+        }
+    }
+    free_mat(left, r);
+    free_mat(right, r);
+    *out = m;
+}
+
+static void split(prec_ctx* ctx, long lo, long hi, prec_mat* out) {
+    if (hi - lo == 1) {
+        leaf(ctx, lo, out);
+        return;
+    }
+    long mid = lo + (hi - lo) / 2;
+    prec_mat l, h;
+    split(ctx, lo, mid, &l);
+    split(ctx, mid, hi, &h);
+    combine(ctx->r, &l, &h, out);
+}
+
+/* The coefficients c[0], ..., c[order] have no negative exponents. */
+static bool polynomial_coeffs(const sum* c, size_t order) {
+    for (size_t i = 0; i <= order; i++) {
+        if (c[i].n && c[i].terms[c[i].n - 1].exp < 0) return false;
+    }
+    return true;
+}
+
+int prec_eval(const sum* c, size_t order, long n0, const mp_rat* init, long N, mp_rat* out) {
+    if (!order || N < n0 || !polynomial_coeffs(c, order)) return -1;
+    if ((size_t) (N - n0) < order) {
+        *out = mprat_copy(&init[N - n0]);
+        return 0;
+    }
+    // u(N) is the last entry of U(N - order + 1)
+    prec_ctx ctx = {.c = c, .r = order};
+    prec_mat m;
+    split(&ctx, n0, N - (long) order + 1, &m);
+    if (ctx.singular) {
+        free_mat(&m, order);
+        return -1;
+    }
+    mp_int one = mpint_from_long(1);
+    mp_rat acc = mprat_from_long(0, 1);
+    for (size_t j = 0; j < order; j++) {
+        mp_rat e = mprat_from_mpint(&m.e[(order - 1) * order + j], &one);
+        mp_rat t = mprat_mul(&e, &init[j]);
+        mp_rat s = mprat_add(&acc, &t);
+        mprat_free(&e);
+        mprat_free(&t);
+        mprat_free(&acc);
+        acc = s;
+    }
+    mp_rat den = mprat_from_mpint(&m.den, &one);
+    *out = mprat_div(&acc, &den);
+    mprat_canonicalize(out);
+    mprat_free(&den);
+    mprat_free(&acc);
+    mpint_free(&one);
+    free_mat(&m, order);
+    return 0;
+}
+
+/* p(x) mod q by Horner's rule over the nonzero terms. */
+static uint64_t eval_mod(const sum* const p, uint64_t x, const mod_barrett* b) {
+    if (!p->n) return 0;
+    uint64_t acc = 0;
+    int prev = p->terms[0].exp;
+    for (size_t i = 0; i < p->n; i++) {
+        acc = mod_barrett_mul(b, acc, mod_pow(x, (uint64_t) (prev - p->terms[i].exp), b->p));
+        acc = mod_add(acc, mod_reduce(p->terms[i].coeff, b->p), b->p);
+        prev = p->terms[i].exp;
+    }
+    return mod_barrett_mul(b, acc, mod_pow(x, (uint64_t) prev, b->p));
+}
+
+/* Forward differences of p at n0, so that each later value costs deg(p) additions: d[0] = p(n), and advancing to
+ * n + 1 adds d[i + 1] to d[i]. */
+static uint64_t* differences(const sum* const p, long n0, const mod_barrett* b) {
+    size_t d = p->n ? (size_t) p->terms[0].exp : 0;
+    uint64_t* v = prec_alloc(d + 1, sizeof(uint64_t));
+    for (size_t j = 0; j <= d; j++) v[j] = eval_mod(p, mod_reduce(n0 + (long) j, b->p), b);
+    for (size_t level = 1; level <= d; level++) {
+        for (size_t j = d; j >= level; j--) v[j] = mod_sub(v[j], v[j - 1], b->p);
+    }
+    return v;
+}
+
+int prec_eval_mod(const sum* c, size_t order, long n0, const uint64_t* init, long N, uint64_t p, uint64_t* out) {
+    if (!order || N < n0 || !polynomial_coeffs(c, order)) return -1;
+    if ((size_t) (N - n0) < order) {
+        *out = init[N - n0] % p;
+        return 0;
+    }
+    mod_barrett b = mod_barrett_init(p);
+    uint64_t** diffs = prec_alloc(order + 1, sizeof(uint64_t*));
+    size_t* degs = prec_alloc(order + 1, sizeof(size_t));
+    for (size_t i = 0; i <= order; i++) {
+        diffs[i] = differences(&c[i], n0, &b);
+        degs[i] = c[i].n ? (size_t) c[i].terms[0].exp : 0;
+    }
+    // V(n) = D(n) U(n) with D(n) the product of the leading coefficients so far, so that V(n + 1) = M(n) V(n)
+    uint64_t* v = prec_alloc(order, sizeof(uint64_t));
+    for (size_t i = 0; i < order; i++) v[i] = init[i] % p;
+    uint64_t den = 1 % p;
+    int ret = 0;
+    for (long n = n0; n < N - (long) order + 1; n++) {
+        uint64_t lead = diffs[order][0];
+        if (!lead) {
+            ret = -1;
+            break;
+        }
+        uint64_t last = 0;
+        for (size_t j = 0; j < order; j++) {
+            last = mod_sub(last, mod_barrett_mul(&b, diffs[j][0], v[j]), p);
+        }
+        for (size_t i = 0; i + 1 < order; i++) v[i] = mod_barrett_mul(&b, lead, v[i + 1]);
+        v[order - 1] = last;
+        den = mod_barrett_mul(&b, den, lead);
+        for (size_t i = 0; i <= order; i++) {
+            for (size_t j = 0; j < degs[i]; j++) diffs[i][j] = mod_add(diffs[i][j], diffs[i][j + 1], p);
+        }
+    }
+    if (!ret) *out = mod_mul(v[order - 1], mod_inv(den, p), p);
+    for (size_t i = 0; i <= order; i++) free(diffs[i]);
+    free(diffs);
+    free(degs);
+    free(v);
+    return ret;
+}
@@ -0,0 +1,25 @@
+/** N-th terms of P-recursive sequences, given by a linear recurrence with polynomial coefficients
+ *     c[0](n) u(n) + c[1](n) u(n + 1) + ... + c[r](n) u(n + r) = 0
+ * as produced by creative telescoping. With U(n) = (u(n), ..., u(n + r - 1)), one step of the recurrence is
+ * U(n + 1) = M(n) U(n) / c[r](n) for the companion matrix M(n) with polynomial entries, so u(N) comes from the
+ * product of the matrices M(n) over a range of n. The exact engine builds that product by binary splitting, which
+ * keeps the operands of every multiplication balanced. The modular engine steps through the range in words. */
+#ifndef PRECURRENCE_H_INCLUDED
+#define PRECURRENCE_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include "./sum.h"
+#include "../numeric/mp_rat.h"
+
+/* Computes u(N) into out from the initial values init[i] = u(n0 + i), i < order, for the recurrence with the
+ * order + 1 coefficients c. Returns 0 on success and -1, leaving out untouched, if N < n0, if some c[i] has a
+ * negative exponent or if c[order] vanishes at some n between n0 and N - order. */
+int prec_eval(const sum* c, size_t order, long n0, const mp_rat* init, long N, mp_rat* out);
+
+/* The same modulo a prime p < 2^63, with init and the result as residues. The division by the product of the
+ * values of c[order] is deferred to a single inversion at the end. Returns -1 if N < n0, if some c[i] has a
+ * negative exponent or if c[order] vanishes modulo p at some n in the range. */
+int prec_eval_mod(const sum* c, size_t order, long n0, const uint64_t* init, long N, uint64_t p, uint64_t* out);
+
+#endif
@@ -0,0 +1,128 @@
+#include "./prod_iter.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "../util/instrument.h"
+
+static void push(prod_iter* it, uint32_t i, uint32_t j) {
+    if (it->n == it->capacity) {
+        it->capacity = it->capacity ? 2 * it->capacity : 16;
+        prod_entry* tmp = reallocarray(it->heap, it->capacity, sizeof(prod_entry));
+        if (!tmp) {
+            perror("Could not allocate memory in product iterator");
+            exit(EXIT_FAILURE);
+        }
+        it->heap = tmp;
+    }
+    prod_entry e = {
+        .exp = it->p->terms[i].exp + it->q->terms[j].exp,
+        .i = i,
+        .j = j
+    };
+    size_t curr = it->n++;
+    while (curr > 0 && it->heap[(curr - 1) / 2].exp < e.exp) {
+        it->heap[curr] = it->heap[(curr - 1) / 2];
+        curr = (curr - 1) / 2;
+        INSTR_SIFTS(1);
+    }
+    it->heap[curr] = e;
+}
+
+static prod_entry pop(prod_iter* it) {
+    prod_entry max = it->heap[0];
+    prod_entry last = it->heap[--it->n];
+    size_t curr = 0;
+    for (;;) {
+        size_t child = 2 * curr + 1;
+        if (child >= it->n) break;
+        if (child + 1 < it->n && it->heap[child + 1].exp > it->heap[child].exp) child++;
+        if (it->heap[child].exp <= last.exp) break;
+        it->heap[curr] = it->heap[child];
+        curr = child;
+        INSTR_SIFTS(1);
+    }
+    if (it->n) it->heap[curr] = last;
+    return max;
+}
+
+void prod_iter_init(prod_iter* it, const sum* const p, const sum* const q) {
+    const sum* short_op = p->n <= q->n ? p : q;
+    it->p = short_op;
+    it->q = short_op == p ? q : p;
+    it->n = 0;
+    it->capacity = 0;
+    it->heap = 0;
+    if (p->n && q->n) {
+        push(it, 0, 0);
+    }
+}
+
+bool prod_iter_pop(prod_iter* it, prod_entry* e) {
+    if (!it->n) return false;
+    prod_entry d = pop(it);
+    // the first product of a row starts the next row, so that rows enter the heap only when needed
+    if (!d.j && d.i + 1 < it->p->n) push(it, d.i + 1, 0);
+    if (d.j + 1 < it->q->n) push(it, d.i, d.j + 1);
+    *e = d;
+    return true;
+}
+
+bool prod_iter_next(prod_iter* it, term* t) {
+    while (it->n) {
+        int e = it->heap[0].exp;
+        long coeff = 0;
+        prod_entry d;
+        while (it->n && it->heap[0].exp == e && prod_iter_pop(it, &d)) {
+            coeff += it->p->terms[d.i].coeff * it->q->terms[d.j].coeff;
+        }
+        if (coeff) {
+            t->exp = e;
+            t->coeff = coeff;
+            return true;
+        }
+    }
+    return false;
+}
+
+void prod_iter_free(prod_iter* it) {
+    free(it->heap);
+    it->heap = 0;
+    it->n = it->capacity = 0;
+}
+
+sum prod_leading(const sum* const p, const sum* const q, size_t k) {
+    INSTR_OP(PROD, p->n * q->n);
+    prod_iter it;
+    prod_iter_init(&it, p, q);
+    sum out = {.n = 0, .capacity = 0, .terms = 0};
+    term t;
+    while (out.n < k && prod_iter_next(&it, &t)) {
+        push_term(&out, t);
+    }
+    prod_iter_free(&it);
+    return finish_terms(&out);
+}
+
+sum add_prod(const sum* const r, const sum* const p, const sum* const q) {
+    INSTR_OP(PROD, p->n * q->n);
+    prod_iter it;
+    prod_iter_init(&it, p, q);
+    sum out = {.n = 0, .capacity = 0, .terms = 0};
+    term t;
+    bool more = prod_iter_next(&it, &t);
+    size_t i = 0;
+    while (more || i < r->n) {
+        if (!more || (i < r->n && r->terms[i].exp > t.exp)) {
+            push_term(&out, r->terms[i++]);
+        } else if (i < r->n && r->terms[i].exp == t.exp) {
+            term s = {.exp = t.exp, .coeff = t.coeff + r->terms[i++].coeff};
+            if (s.coeff) push_term(&out, s);
+            more = prod_iter_next(&it, &t);
+        } else {
+            push_term(&out, t);
+            more = prod_iter_next(&it, &t);
+        }
+    }
+    prod_iter_free(&it);
+    return finish_terms(&out);
+}
@@ -0,0 +1,54 @@
+/** Lazy products of sparse polynomials. The terms of p q are produced one at a time, highest exponent first, by
+ * merging the rows p[i] q with a heap that holds at most one entry per term of the shorter operand: popping the
+ * product of terms i and j pushes i, j + 1, and the first product of a row pushes the first of the next. A caller
+ * that only needs the leading terms, or a division that finds its answer early, pays for the terms it reads and
+ * never for the rest. As in prod, coefficients are multiplied and added as longs. */
+#ifndef PROD_ITER_H_INCLUDED
+#define PROD_ITER_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "./sum.h"
+
+/* The product of term i of p with term j of q. */
+typedef struct prod_entry prod_entry;
+
+struct prod_entry {
+    int exp;
+    uint32_t i;
+    uint32_t j;
+};
+
+/* The operands must outlive the iterator and stay unchanged while it is in use. */
+typedef struct prod_iter prod_iter;
+
+struct prod_iter {
+    // p is the operand with fewer terms
+    const sum* p;
+    const sum* q;
+    size_t n;
+    size_t capacity;
+    prod_entry* heap;
+};
+
+void prod_iter_init(prod_iter* it, const sum* const p, const sum* const q);
+
+/* Stores the next nonzero term of p q in t and returns true, or returns false once every term has been produced.
+ * Like terms are combined, and terms that cancel are skipped. */
+bool prod_iter_next(prod_iter* it, term* t);
+
+/* Stores the product with the highest exponent left in e and returns true, or returns false once every product has
+ * been produced. Like terms are not combined, for callers that accumulate the coefficients in their own type; e.i
+ * indexes it->p and e.j indexes it->q. */
+bool prod_iter_pop(prod_iter* it, prod_entry* e);
+
+void prod_iter_free(prod_iter* it);
+
+/* The k leading terms of p q, or all of them if there are fewer. */
+sum prod_leading(const sum* const p, const sum* const q, size_t k);
+
+/* r + p q, merging the terms of the product into r as they are produced. */
+sum add_prod(const sum* const r, const sum* const p, const sum* const q);
+
+#endif
@@ -1,6 +1,11 @@
 #include "./sum.h"
 #include "../numeric/euclid.h"
-#include "../util/heap.h"
+#include "../util/term_sort.h"
+#include "../util/arena.h"
+#include "./heap_div.h"
+#include "./newton_div.h"
+#include "./dense.h"
+#include "./format.h"
 #include "../numeric/pow.h"
 
 #include "stdio.h"
@@ -8,6 +13,7 @@
 #include "math.h"
 #include "assert.h"
 #include "string.h" // for memcpy
+#include "../util/instrument.h"
 
 sum init_polynomial(size_t num_terms, int const coeffs[num_terms], int const degs[num_terms]) {
     sum p = {
@@ -24,14 +30,18 @@ sum init_polynomial(size_t num_terms, int const coeffs[num_terms], int const deg
 }
 
 sum zero_polynomial() {
-    sum out;
-    out.terms = calloc(1, sizeof(term));
-    out.n = 0;
+    sum out = {
+        .n = 0,
+        .capacity = 1,
+        .terms = calloc(1, sizeof(term))
+    };
+    if (!out.terms) perror("Could not allocate memory: ");
     return out;
 }
 
 /* Assumes that the terms are sorted. */
 sum add(const sum* const p1, const sum* const p2) {
+    INSTR_OP(ADD, p1->n + p2->n);
     size_t max_terms = p1->n + p2->n;
     term* terms = calloc(max_terms, sizeof(term));
 
@@ -68,6 +78,11 @@ sum add(const sum* const p1, const sum* const p2) {
         terms[k].exp = p2->terms[j].exp;
         j++; k++;
     }
+    // handle the exceptional case where all terms cancel
+    if (!k) {
+        free(terms);
+        return zero_polynomial();
+    }
     term* temp = realloc(terms, k * sizeof(term));
     if(!temp) {
         perror("Error reallocating in add");
@@ -77,15 +92,191 @@ sum add(const sum* const p1, const sum* const p2) {
         .n = k,
         .terms = temp
     };
+    return p;
+}
 
-    // handle the exceptional case where all terms cancel
-    if (!k) {
+/* Allocation helpers for the operations that take an optional scratch arena. With a null arena they go to the
+ * C allocator; memory from an arena is never freed individually. */
+static term* alloc_terms(arena* a, size_t n) {
+    if (a) {
+        return arena_alloc(a, n * sizeof(term));
+    }
+    term* out = malloc(n * sizeof(term));
+    if (!out) {
+        perror("Could not allocate memory for terms");
+        exit(EXIT_FAILURE);
+    }
+    return out;
+}
+
+static term* resize_terms(arena* a, term* t, size_t old_n, size_t n) {
+    if (a) {
+        return arena_realloc(a, t, old_n * sizeof(term), n * sizeof(term));
+    }
+    term* temp = reallocarray(t, n, sizeof(term));
+    if (!temp) {
+        perror("Error reallocating terms");
+        exit(EXIT_FAILURE);
+    }
+    return temp;
+}
+
+static void free_terms(arena* a, term* t) {
+    if (!a) {
+        free(t);
+    }
+}
+
+static sum zero_polynomial_a(arena* a) {
+    if (!a) {
         return zero_polynomial();
     }
-    return p;
+    sum out = {
+        .n = 0,
+        .capacity = 1,
+        .terms = arena_alloc(a, sizeof(term))
+    };
+    out.terms[0].exp = 0;
+    out.terms[0].coeff = 0;
+    return out;
+}
+
+/* Makes sure that p has room for at least n terms, keeping its current terms. */
+static void reserve_terms(arena* a, sum* const p, size_t n) {
+    size_t have = p->capacity > p->n ? p->capacity : p->n;
+    if (have >= n && p->terms) {
+        return;
+    }
+    if (n < 2 * have) {
+        n = 2 * have;
+    }
+    p->terms = resize_terms(a, p->terms, p->terms ? have : 0, n);
+    p->capacity = n;
+}
+
+void push_term(sum* const p, term t) {
+    reserve_terms(0, p, p->n + 1);
+    p->terms[p->n++] = t;
+}
+
+sum finish_terms(sum* const p) {
+    if (!p->n) {
+        free(p->terms);
+        return zero_polynomial();
+    }
+    term* tmp = realloc(p->terms, p->n * sizeof(term));
+    if (tmp) p->terms = tmp;
+    p->capacity = 0;
+    return *p;
+}
+
+/* Sets the number of terms of p to k. If no terms are left, keeps the zeroed leading term that lc and deg
+ * read for the zero polynomial. */
+static void set_num_terms(sum* const p, size_t k) {
+    p->n = k;
+    if (!k) {
+        p->terms[0].exp = 0;
+        p->terms[0].coeff = 0;
+    }
+}
+
+int add_inplace(sum* const p1, const sum* const p2) {
+    INSTR_OP(ADD_INPLACE, p1->n + p2->n);
+    if (!p2->n) {
+        return 0;
+    }
+    if (p1->terms == p2->terms) {
+        // the merge below would overwrite p2 while reading it
+        scalar_prod_in_place(2, p1);
+        return 0;
+    }
+    size_t n1 = p1->n;
+    reserve_terms(0, p1, n1 + p2->n);
+
+    // Move the terms of p1 to the back of the array and merge towards the front. The write position never
+    // passes the read position, since k <= i + j <= i + p2->n.
+    term* terms = p1->terms;
+    memmove(terms + p2->n, terms, n1 * sizeof(term));
+    size_t i = p2->n, j = 0, k = 0;
+    size_t end = p2->n + n1;
+    while (i < end && j < p2->n) {
+        if (terms[i].exp == p2->terms[j].exp) {
+            long c = terms[i].coeff + p2->terms[j].coeff;
+            if (c) {
+                terms[k].exp = terms[i].exp;
+                terms[k].coeff = c;
+                k++;
+            }
+            i++; j++;
+        }
+        else if (terms[i].exp < p2->terms[j].exp) {
+            terms[k++] = p2->terms[j++];
+        }
+        else {
+            terms[k++] = terms[i++];
+        }
+    }
+    while (i < end) {
+        terms[k++] = terms[i++];
+    }
+    while (j < p2->n) {
+        terms[k++] = p2->terms[j++];
+    }
+    set_num_terms(p1, k);
+    return 0;
+}
+
+static void sub_mul_a(sum* const p, long c, int e, const sum* const q, sum* const buf, arena* a) {
+    INSTR_OP(SUB_MUL, p->n + q->n);
+    if (!c) {
+        // the merge would otherwise copy in the terms of q with zero coefficients
+        return;
+    }
+    reserve_terms(a, buf, p->n + q->n);
+    term* terms = buf->terms;
+
+    size_t i = 0, j = 0, k = 0;
+    while (i < p->n && j < q->n) {
+        int qe = q->terms[j].exp + e;
+        if (p->terms[i].exp == qe) {
+            long d = p->terms[i].coeff - c * q->terms[j].coeff;
+            if (d) {
+                terms[k].exp = qe;
+                terms[k].coeff = d;
+                k++;
+            }
+            i++; j++;
+        }
+        else if (p->terms[i].exp < qe) {
+            terms[k].exp = qe;
+            terms[k].coeff = -c * q->terms[j].coeff;
+            j++; k++;
+        }
+        else {
+            terms[k++] = p->terms[i++];
+        }
+    }
+    while (i < p->n) {
+        terms[k++] = p->terms[i++];
+    }
+    while (j < q->n) {
+        terms[k].exp = q->terms[j].exp + e;
+        terms[k].coeff = -c * q->terms[j].coeff;
+        j++; k++;
+    }
+    set_num_terms(buf, k);
+
+    sum t = *p;
+    *p = *buf;
+    *buf = t;
+}
+
+void sub_mul_inplace(sum* const p, long c, int e, const sum* const q, sum* const buf) {
+    sub_mul_a(p, c, e, q, buf, 0);
 }
 
 sum scalar_prod(long s, const sum* const p) {
+    INSTR_OP(SCALAR_PROD, p->n);
     sum g = {
         .n = p->n,
         .terms = malloc(p->n * sizeof(term))
@@ -98,12 +289,14 @@ sum scalar_prod(long s, const sum* const p) {
 }
 
 void scalar_prod_in_place(long s, sum* const p) {
+    INSTR_OP(SCALAR_PROD, p->n);
     for (size_t i = 0; i < p->n; i++) {
         p->terms[i].coeff *= s;
     }
 }
 
 sum negate(const sum* const p) {
+    INSTR_OP(NEGATE, p->n);
     term* terms = calloc(p->n, sizeof(term));
     for (size_t i = 0; i < p->n; i++) {
         terms[i].coeff = -p->terms[i].coeff;
@@ -118,22 +311,18 @@ sum negate(const sum* const p) {
 }
 
 void negate_in_place(sum* const p) {
+    INSTR_OP(NEGATE, p->n);
     for (size_t i = 0; i < p->n; i++) {
         p->terms[i].coeff = -p->terms[i].coeff;
     }
 }
 
 void display(const sum* const p) {
-    for (size_t i = 0; i < p->n; i++) {
-        printf("%ld", p->terms[i].coeff);
-        if (p->terms[i].exp > 0) {
-            printf("x^%d", p->terms[i].exp);
-        }
-        if (i < p->n - 1) {
-            printf(" + ");
-        }
-    }
-    printf("\n");
+    outbuf ob;
+    outbuf_file(&ob, stdout);
+    format_sum(&ob, p, FORMAT_TEXT);
+    outbuf_putc(&ob, '\n');
+    outbuf_flush(&ob);
 }
 
 void free_polynomial(sum* p) {
@@ -145,20 +334,19 @@ void free_polynomial(sum* p) {
     p->terms = 0;
 }
 
-/* Computes the content of a polynomial p */
+/* Computes the content of a polynomial p. Stops as soon as the running gcd reaches 1, which for most polynomials
+ * happens within the first few coefficients. */
 long cont(const sum* const p) {
-    if (p->n == 1) {
-        return p->terms[0].coeff;
-    }
-    long curr_gcd = p->terms[0].coeff;
-    for (int i = 1; i < p->n; i++) {
+    INSTR_OP(CONT, p->n);
+    long curr_gcd = 0;
+    for (size_t i = 0; i < p->n && curr_gcd != 1; i++) {
         curr_gcd = gcd(curr_gcd, p->terms[i].coeff);
     }
-    if (curr_gcd < 0) return -curr_gcd;
     return curr_gcd;
 }
 
 sum prim(const sum* const p) {
+    INSTR_OP(PRIM, p->n);
     long c = cont(p);
     term* terms = calloc(p->n, sizeof(term));
 
@@ -174,6 +362,7 @@ sum prim(const sum* const p) {
 }
 
 void prim_in_place(sum* const p) {
+    INSTR_OP(PRIM, p->n);
     long c = cont(p);
     for (int i = 0; i < p->n; i++) {
         // each coefficient is divisible by the content, so integer divison makes sense
@@ -182,51 +371,31 @@ void prim_in_place(sum* const p) {
 }
 
 sum prod(const sum* const p, const sum* const q) {
+    return prod_a(p, q, 0);
+}
+
+sum prod_a(const sum* const p, const sum* const q, arena* a) {
+    INSTR_OP(PROD, p->n * q->n);
     if (!p->n || !q->n) {
-        sum g = {
-            .terms = malloc(0),
-            .n = 0
-        };
-        return g;
+        return zero_polynomial_a(a);
     }
 
-    term* out = calloc(p->n * q->n, sizeof(term));
+    term* out = alloc_terms(a, p->n * q->n);
     for (size_t i = 0; i < p->n; i++) {
+        if (a) arena_check(a);
         for (size_t j = 0; j < q->n; j++) {
             out[q->n * i + j].coeff = p->terms[i].coeff * q->terms[j].coeff;
             out[q->n * i + j].exp = p->terms[i].exp + q->terms[j].exp;
         }
     }
-    // sort array
-    out = heap_sort(p->n * q->n, out);
-    // collect like terms
-    int last_exp = out[0].exp;
-    long last_coeff = 0;
-    size_t curr_index = 0;
-    size_t new_index = 0;
-    while (curr_index < p->n * q->n) {
-        if (out[curr_index].exp < last_exp) {
-            out[new_index].coeff = last_coeff;
-            out[new_index].exp = last_exp;
-            // reset the coefficient sum
-            last_coeff = 0;
-            new_index++; 
-        }
-        last_exp = out[curr_index].exp;
-        last_coeff += out[curr_index].coeff;
-        curr_index++;
-    }
-    // add the lowest degree term (wasn't added in the while loop)
-    out[new_index].coeff = last_coeff;
-    out[new_index].exp = last_exp;
-    new_index++;
-    // avoid wasting memory
-    term* temp = realloc(out, new_index * sizeof(term)); 
-    if (!temp) {
-        perror("Error reallocating in prod");
-        exit(EXIT_FAILURE);
+    // sort array and collect like terms in the same pass
+    size_t new_index = sort_collect_terms(p->n * q->n, out);
+    if (!new_index) {
+        free_terms(a, out);
+        return zero_polynomial_a(a);
     }
-    out = temp;
+    // avoid wasting memory
+    out = resize_terms(a, out, p->n * q->n, new_index);
 
     sum g = {
         .n = new_index,
@@ -235,134 +404,235 @@ sum prod(const sum* const p, const sum* const q) {
     return g;
 } 
 
+/* Sparse dividends and sparse divisors go to heap division, which does not touch the gaps between the terms and
+ * merges one row per quotient term instead of rewriting the whole remainder at every step. */
+static int use_heap_division(const sum* const p, const sum* const q) {
+    return p->n && q->n > 1 && (!is_dense(p) || !is_dense(q));
+}
+
+/* Large dense divisions by a dense divisor with a unit leading coefficient go to Newton division. Newton division
+ * works on the full dense length of both operands, so a sparse divisor, even of a dense dividend, is left to heap
+ * division, whose work grows with the number of terms of the divisor instead. */
+static int use_newton_division(const sum* const p, const sum* const q) {
+    return p->n && p->terms[p->n - 1].exp >= 0 && newton_applicable(q)
+        && deg(q) + 1 >= NEWTON_MIN_DIVISOR && deg(p) - deg(q) + 1 >= NEWTON_MIN_QUOTIENT && is_dense(p)
+        && is_dense(q);
+}
+
+/* Copies p into a new sum with room for growth, for use as the running remainder of a division. */
+static sum copy_for_division(const sum* const p, arena* a) {
+    sum r = {
+        .n = 0,
+        .capacity = 0,
+        .terms = 0
+    };
+    reserve_terms(a, &r, p->n ? p->n : 1);
+    memcpy(r.terms, p->terms, (p->n ? p->n : 1) * sizeof(term));
+    r.n = p->n;
+    return r;
+}
+
+/* Divides the running remainder r by q in-place, stopping when the degree of r drops below deg(q), when lc(q)
+ * does not divide lc(r) or when lc(r) is zero, which happens only if a coefficient overflowed. The quotient terms
+ * are written to quot if it is not null. Uses one scratch buffer for the whole division. */
+static void divide_in_place(sum* const r, const sum* const q, sum* const quot, arena* a) {
+    int d = deg(q);
+    long c = lc(q);
+    sum buf = {
+        .n = 0,
+        .capacity = 0,
+        .terms = 0
+    };
+
+    term t;
+    while (r->n) {
+        t.exp = deg(r);
+        t.coeff = lc(r);
+
+        // if remainder has degree less than q or if 
+        // the leading coefficient of q doesn't divide the leading coefficient of the remainder.
+        // A zero leading coefficient is only left by an overflow, and would never be cancelled.
+        if (t.exp < d || !t.coeff || (t.coeff % c) ) {
+            break;
+        }
+        t.exp -= d;
+        t.coeff /= c;
+        if (quot) {
+            quot->terms[quot->n++] = t;
+        }
+        // a step rewrites the remainder without allocating once buf has grown
+        if (a) arena_check(a);
+        sub_mul_a(r, t.coeff, t.exp, q, &buf, a);
+    }
+    free_terms(a, buf.terms);
+}
+
 sum pquo(const sum* const p, const sum* const q) {
+    return pquo_a(p, q, 0);
+}
+
+sum pquo_a(const sum* const p, const sum* const q, arena* a) {
+    INSTR_OP(PQUO, p->n + q->n);
     if (deg(p) < deg(q)) {
-        return zero_polynomial();
+        return zero_polynomial_a(a);
     }
 
     long b = lc(q);
     b = long_pow(b, deg(p) - deg(q) + 1);
-    sum g = scalar_prod(b, p);
-    return quo(&g, q);
+    sum g = copy_for_division(p, a);
+    scalar_prod_in_place(b, &g);
+    sum out = quo_a(&g, q, a);
+    free_terms(a, g.terms);
+    return out;
 }
 
 sum prem(const sum* const p, const sum* const q) {
-    sum g = pquo(p, q);
-    negate_in_place(&g);
-    sum gq = prod(&g, q);
+    return prem_a(p, q, 0);
+}
 
-    free(g.terms);
+sum prem_a(const sum* const p, const sum* const q, arena* a) {
+    INSTR_OP(PREM, p->n + q->n);
+    sum r = copy_for_division(p, a);
+    if (deg(p) < deg(q)) {
+        return r;
+    }
 
     long b = lc(q);
     b = long_pow(b, deg(p) - deg(q) + 1);
-    sum sp = scalar_prod(b, p);
-    sum out = add(&sp, &gq);
-    free(gq.terms);
-    free(sp.terms);
-    return out;
+    scalar_prod_in_place(b, &r);
+    divide_in_place(&r, q, 0, a);
+    return r;
 }
 
 /* Requires that deg(p) >= deg(q). Returns p/q. */
 sum quo(const sum* const p, const sum* const q) {
+    return quo_a(p, q, 0);
+}
+
+sum quo_a(const sum* const p, const sum* const q, arena* a) {
+    INSTR_OP(QUO, p->n + q->n);
     assert(deg(p) >= deg(q));
+    if (!a && use_newton_division(p, q)) {
+        return newton_quo(p, q);
+    }
+    if (!a && use_heap_division(p, q)) {
+        return heap_quo(p, q);
+    }
 
-    term* terms = calloc(deg(p) - deg(q) + 1, sizeof(term));
     size_t n = deg(p) - deg(q) + 1;
-
     sum g = {
-        .terms = terms,
+        .terms = alloc_terms(a, n),
         .n = 0
     };
 
-    int d = deg(q);
-    long c = lc(q);
-
-    sum curr_rem = {
-        .terms = malloc(p->n * sizeof(term)),
-        .n = p->n
-    };
-
-    sum curr_prod = {
-        .terms = malloc(q->n * sizeof(term)),
-        .n = q->n
-    };
-
-    memcpy(curr_rem.terms, p->terms, p->n * sizeof(term));
+    sum curr_rem = copy_for_division(p, a);
+    divide_in_place(&curr_rem, q, &g, a);
+    free_terms(a, curr_rem.terms);
 
-    term t;
-    size_t i = 0;
-    while (i < n) {
-        t.exp = deg(&curr_rem);
-        t.coeff = lc(&curr_rem);
-
-        // if remainder has degree less than q or if 
-        // the leading coefficient of q doesn't divide the leading coefficient of the remainder.
-        if (t.exp < d || (t.coeff % c) ) {
-            break;
-        }
-
-        g.terms[i].exp = t.exp - d;
-        g.terms[i].coeff = t.coeff / c;
-        g.n += 1;
+    if (!g.n) {
+        free_terms(a, g.terms);
+        return zero_polynomial_a(a);
+    }
+    // avoid wasting memory
+    g.terms = resize_terms(a, g.terms, n, g.n);
+    return g;
+}
 
-        for (size_t j = 0; j < q->n; j++) {
-            curr_prod.terms[j].exp = q->terms[j].exp + g.terms[i].exp;
-            curr_prod.terms[j].coeff = q->terms[j].coeff * g.terms[i].coeff;
-        }
+sum rem(const sum* const p, const sum* const q) {
+    return rem_a(p, q, 0);
+}
 
-        negate_in_place(&curr_prod);
-        curr_rem = add(&curr_rem, &curr_prod);
-        i++;
+sum rem_a(const sum* const p, const sum* const q, arena* a) {
+    INSTR_OP(REM, p->n + q->n);
+    if (!a && use_newton_division(p, q)) {
+        return newton_rem(p, q);
     }
-    // avoid memory leak
-    term* temp = realloc(g.terms, i * sizeof(term)); 
-    if (!temp) {
-        perror("Error reallocating in quo");
-        exit(EXIT_FAILURE);
+    if (!a && use_heap_division(p, q)) {
+        return heap_rem(p, q);
     }
-    g.terms = temp; 
-    free(curr_prod.terms);
-    curr_prod.terms = 0;
-    free(curr_rem.terms);
-    curr_rem.terms = 0;
-    return g;
+    sum r = copy_for_division(p, a);
+    divide_in_place(&r, q, 0, a);
+    return r;
 }
 
-sum rem(const sum* const p, const sum* const q) {
-    sum g = quo(p, q);
-    negate_in_place(&g);
-    sum gq = prod(&g, q);
-    free(g.terms);
-    sum out = add(p, &gq);
-    free(gq.terms);
+/* Copies p to the next free space of the arena. The source may overlap the destination, which is what lets
+ * prim_gcd_a slide its live polynomials back down to its mark after every step. */
+static sum relocate(const sum* const p, arena* a) {
+    size_t n = p->n ? p->n : 1;
+    sum out = {
+        .n = p->n,
+        .capacity = n,
+        .terms = arena_alloc(a, n * sizeof(term))
+    };
+    memmove(out.terms, p->terms, n * sizeof(term));
     return out;
 }
 
+#ifdef HYPERGEOM_INSTRUMENT
+static int max_coeff_bits(const sum* const p) {
+    int bits = 0;
+    for (size_t i = 0; i < p->n; i++) {
+        long c = p->terms[i].coeff;
+        unsigned long m = c < 0 ? 0 - (unsigned long) c : (unsigned long) c;
+        int b = m ? 64 - __builtin_clzl(m) : 0;
+        if (b > bits) bits = b;
+    }
+    return bits;
+}
+#endif
+
 sum prim_gcd(const sum* const p, const sum* const q) {
+    arena* a = arena_create((p->n + q->n) * 4 * sizeof(term));
+    sum out = prim_gcd_a(p, q, a);
+    arena_free(a);
+    return out;
+}
+
+sum prim_gcd_a(const sum* const p, const sum* const q, arena* a) {
     if (deg(p) < deg(q)) {
-        return prim_gcd(q, p);
+        return prim_gcd_a(q, p, a);
     }
+    INSTR_OP(PRIM_GCD, p->n + q->n);
 
-    long a = cont(p);
-    long b = cont(q);
-    long c = gcd(a, b);
+    long b1 = cont(p);
+    long b2 = cont(q);
+    long c = gcd(b1, b2);
 
-    sum p1 = prim(p);
-    sum q1 = prim(q);
+    arena_mark m = arena_get_mark(a);
+    sum p1 = copy_for_division(p, a);
+    prim_in_place(&p1);
+    sum q1 = copy_for_division(q, a);
+    prim_in_place(&q1);
     sum r;
+#ifdef HYPERGEOM_INSTRUMENT
+    size_t step = 0;
+#endif
 
     // while q1 is not zero
     while(lc(&q1)) {
-        r = prem(&p1, &q1);
-
-        free(p1.terms);
-        p1 = q1;
+        r = prem_a(&p1, &q1, a);
+        INSTR_GCD_STEP(step++, deg(&r), max_coeff_bits(&r));
         prim_in_place(&r);
-        q1 = r;
+
+        // p1 is no longer needed: drop every temporary of this step and slide q1 and r down to the mark,
+        // in allocation order so that neither overwrites the other before it is moved
+        arena_release(a, m);
+        p1 = relocate(&q1, a);
+        q1 = relocate(&r, a);
     }
-    free(r.terms);
     scalar_prod_in_place(c, &p1);
-    return p1;
+
+    sum out = {
+        .n = p1.n,
+        .terms = malloc((p1.n ? p1.n : 1) * sizeof(term))
+    };
+    if (!out.terms) {
+        perror("Could not allocate memory in prim_gcd");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(out.terms, p1.terms, (p1.n ? p1.n : 1) * sizeof(term));
+    arena_release(a, m);
+    return out;
 }
 
 /* Assumes that the terms of the polynomials are sorted by exponent!  */
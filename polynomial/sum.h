@@ -2,6 +2,7 @@
 #define SUM_H_INCLUDED
 
 #include <stddef.h>
+#include "../util/arena.h"
 
 typedef struct term term;
 
@@ -12,8 +13,11 @@ struct term {
     long coeff;
 };
 
+/* capacity is the number of terms allocated in terms. It is only tracked by the in-place operations; 0 means
+ * that exactly n terms are allocated. */
 struct sum {
     size_t n;
+    size_t capacity;
     struct term* terms;
 };
 
@@ -27,13 +31,25 @@ sum scalar_prod(long s, const sum* const p);
 
 void scalar_prod_in_place(long s, sum* const p);
 
-// /* Adds p2 to p1 and returns p1. */
-// int add_inplace(polynomial* p1, polynomial* const p2);
+/* Adds p2 to p1 in-place, growing the terms of p1 if needed. p2 may be p1. Returns 0 on success. */
+int add_inplace(sum* const p1, const sum* const p2);
+
+/* Sets p to p - c * x^e * q. The result is merged into the terms of buf, which are then swapped with those of p,
+ * so that repeated calls with the same buf allocate only when the terms outgrow both arrays. buf may start out
+ * as a zero-initialized sum and must be freed by the caller. q may be p, but buf must be distinct from both. */
+void sub_mul_inplace(sum* const p, long c, int e, const sum* const q, sum* const buf);
+
+/* Appends t to p, growing its terms geometrically. p may start out as a zero-initialized sum. */
+void push_term(sum* const p, term t);
+
+/* Shrinks the terms of p to its n terms, or replaces it by the zero polynomial if it has none. */
+sum finish_terms(sum* const p);
 
 sum negate(const sum* const p);
 
 void negate_in_place(sum* const p);
 
+/* Prints p to stdout in the text format of polynomial/format.h, followed by a newline. */
 void display(const sum*const p);
 
 void free_polynomial(sum* p);
@@ -56,6 +72,24 @@ sum prod(const sum* const p, const sum* const q);
 
 sum prim_gcd(const sum* const p, const sum* const q);
 
+/* Versions of the operations above that take their memory from an arena (see util/arena.h). Temporaries and the
+ * result are allocated from a, so the result must not be passed to free_polynomial; it is released along with
+ * everything else by arena_release or arena_reset. With a null arena they behave like the plain versions. */
+sum pquo_a(const sum* const p, const sum* const q, arena* a);
+
+sum prem_a(const sum* const p, const sum* const q, arena* a);
+
+sum quo_a(const sum* const p, const sum* const q, arena* a);
+
+sum rem_a(const sum* const p, const sum* const q, arena* a);
+
+sum prod_a(const sum* const p, const sum* const q, arena* a);
+
+/* Unlike the other arena versions, a (which must not be null) is only used for scratch: every step of the
+ * pseudo-remainder sequence is released in bulk, a is left as it was on entry, and the result is allocated with
+ * malloc. prim_gcd runs this with an arena of its own. */
+sum prim_gcd_a(const sum* const p, const sum* const q, arena* a);
+
 long leval(sum* const p, long x);
 int ieval(sum* const p, int x);
 float feval(sum* const p, float x);
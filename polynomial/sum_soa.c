@@ -0,0 +1,135 @@
+#include "./sum_soa.h"
+#include "../numeric/coeff_vec.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdint.h"
+#include "../util/instrument.h"
+
+#define SOA_ALIGN 64
+
+/* aligned_alloc requires the size to be a multiple of the alignment. */
+static void* soa_alloc(size_t n, size_t size) {
+    size_t bytes = (n * size + SOA_ALIGN - 1) / SOA_ALIGN * SOA_ALIGN;
+    if (!bytes) bytes = SOA_ALIGN;
+    void* out = aligned_alloc(SOA_ALIGN, bytes);
+    if (!out) {
+        perror("Could not allocate memory in soa_alloc");
+        exit(EXIT_FAILURE);
+    }
+    return out;
+}
+
+sum_soa init_sum_soa(size_t n) {
+    sum_soa p = {
+        .n = n,
+        .exps = soa_alloc(n, sizeof(int)),
+        .coeffs = soa_alloc(n, sizeof(long))
+    };
+    return p;
+}
+
+sum_soa sum_to_soa(const sum* const p) {
+    sum_soa g = init_sum_soa(p->n);
+    for (size_t i = 0; i < p->n; i++) {
+        g.exps[i] = p->terms[i].exp;
+        g.coeffs[i] = p->terms[i].coeff;
+    }
+    return g;
+}
+
+sum soa_to_sum(const sum_soa* const p) {
+    if (!p->n) {
+        return zero_polynomial();
+    }
+    sum g = {
+        .n = p->n,
+        .terms = malloc(p->n * sizeof(term))
+    };
+    if (!g.terms) {
+        perror("Could not allocate memory in soa_to_sum");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < p->n; i++) {
+        g.terms[i].exp = p->exps[i];
+        g.terms[i].coeff = p->coeffs[i];
+    }
+    return g;
+}
+
+void free_sum_soa(sum_soa* p) {
+    if (!p) {
+        return;
+    }
+    p->n = 0;
+    free(p->exps);
+    free(p->coeffs);
+    p->exps = 0;
+    p->coeffs = 0;
+}
+
+void soa_scalar_prod_in_place(long s, sum_soa* const p) {
+    cvec_scale(p->n, p->coeffs, s);
+}
+
+void soa_negate_in_place(sum_soa* const p) {
+    cvec_negate(p->n, p->coeffs);
+}
+
+long soa_cont(const sum_soa* const p) {
+    return cvec_content(p->n, p->coeffs);
+}
+
+void soa_prim_in_place(sum_soa* const p) {
+    long c = soa_cont(p);
+    if (c > 1) {
+        cvec_divexact(p->n, p->coeffs, c);
+    }
+}
+
+/* y + a x, wrapping like the vector kernels. */
+static long wrap_addmul(long y, long a, long x) {
+    return (long) ((uint64_t) y + (uint64_t) a * (uint64_t) x);
+}
+
+void soa_addmul(sum_soa* const p, long a, const sum_soa* const q) {
+    if (p->n == q->n && !memcmp(p->exps, q->exps, p->n * sizeof(int))) {
+        cvec_addmul(p->n, p->coeffs, a, q->coeffs);
+    } else {
+        sum_soa g = init_sum_soa(p->n + q->n);
+        size_t i = 0, j = 0, k = 0;
+        while (i < p->n && j < q->n) {
+            if (p->exps[i] == q->exps[j]) {
+                g.exps[k] = p->exps[i];
+                g.coeffs[k++] = wrap_addmul(p->coeffs[i++], a, q->coeffs[j++]);
+            } else if (p->exps[i] > q->exps[j]) {
+                g.exps[k] = p->exps[i];
+                g.coeffs[k++] = p->coeffs[i++];
+            } else {
+                g.exps[k] = q->exps[j];
+                g.coeffs[k++] = wrap_addmul(0, a, q->coeffs[j++]);
+            }
+        }
+        while (i < p->n) {
+            g.exps[k] = p->exps[i];
+            g.coeffs[k++] = p->coeffs[i++];
+        }
+        while (j < q->n) {
+            g.exps[k] = q->exps[j];
+            g.coeffs[k++] = wrap_addmul(0, a, q->coeffs[j++]);
+        }
+        g.n = k;
+        free_sum_soa(p);
+        *p = g;
+    }
+    // drop the coefficients that cancelled
+    size_t k = 0;
+    for (size_t i = 0; i < p->n; i++) {
+        if (p->coeffs[i]) {
+            p->exps[k] = p->exps[i];
+            p->coeffs[k++] = p->coeffs[i];
+        }
+    }
+    p->n = k;
+}
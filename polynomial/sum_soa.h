@@ -0,0 +1,39 @@
+/** Structure-of-arrays layout for sums. Exponents and coefficients live in separate 64-byte aligned arrays, so
+ * that operations touching only the coefficients stream through contiguous memory and run on the vector kernels
+ * of numeric/coeff_vec.h. Terms are sorted by decreasing exponent, as in sum. */
+#ifndef SUM_SOA_H_INCLUDED
+#define SUM_SOA_H_INCLUDED
+
+#include <stddef.h>
+#include "./sum.h"
+
+typedef struct sum_soa sum_soa;
+
+struct sum_soa {
+    size_t n;
+    int* exps;
+    long* coeffs;
+};
+
+/* Allocates room for n terms (uninitialized) and sets the number of terms to n. */
+sum_soa init_sum_soa(size_t n);
+
+sum_soa sum_to_soa(const sum* const p);
+
+sum soa_to_sum(const sum_soa* const p);
+
+void free_sum_soa(sum_soa* p);
+
+void soa_scalar_prod_in_place(long s, sum_soa* const p);
+
+void soa_negate_in_place(sum_soa* const p);
+
+long soa_cont(const sum_soa* const p);
+
+void soa_prim_in_place(sum_soa* const p);
+
+/* p += a * q. When p and q have the same exponents this is a single vector multiply-accumulate; otherwise the
+ * terms are merged into new arrays. Coefficients that cancel are dropped. */
+void soa_addmul(sum_soa* const p, long a, const sum_soa* const q);
+
+#endif
@@ -0,0 +1,272 @@
+#include "./wz.h"
+#include "./bsplit.h"
+#include "./multimod.h"
+#include "../numeric/modular.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "math.h"
+#include "../util/instrument.h"
+
+/* Primes are drawn from [2^WZ_PRIME_BITS, 2^(WZ_PRIME_BITS + 1)). */
+#define WZ_PRIME_BITS 61
+
+typedef struct bideg bideg;
+
+/* Degrees in n and in k. */
+struct bideg {
+    long n;
+    long k;
+};
+
+static bideg deg_add(bideg a, bideg b) {
+    return (bideg){a.n + b.n, a.k + b.k};
+}
+
+static bideg deg_max(bideg a, bideg b) {
+    return (bideg){a.n > b.n ? a.n : b.n, a.k > b.k ? a.k : b.k};
+}
+
+static bideg deg_scale(long s, bideg a) {
+    return (bideg){s * a.n, s * a.k};
+}
+
+static bideg bipoly_deg(const bipoly* const P) {
+    bideg d = {0, 0};
+    for (size_t i = 0; i < P->n; i++) {
+        if (!P->p[i].n) continue;
+        d.n = (long) i;
+        if (P->p[i].terms[0].exp > d.k) d.k = P->p[i].terms[0].exp;
+    }
+    return d;
+}
+
+/* A bound on the degrees of the cleared identity (see wz.h). */
+static bideg identity_deg(const hyper_term* F, const sum* c, size_t order, const bipoly* rn, const bipoly* rd) {
+    bideg a = bipoly_deg(&F->num_n), b = bipoly_deg(&F->den_n);
+    bideg cd = bipoly_deg(&F->num_k), dd = bipoly_deg(&F->den_k);
+    bideg r1 = bipoly_deg(rn), r2 = bipoly_deg(rd);
+    bideg lhs_num = {0, 0};
+    for (size_t i = 0; i <= order; i++) {
+        bideg t = {c[i].n ? c[i].terms[0].exp : 0, 0};
+        t = deg_add(t, deg_add(deg_scale((long) i, a), deg_scale((long) (order - i), b)));
+        lhs_num = deg_max(lhs_num, t);
+    }
+    bideg lhs_den = deg_scale((long) order, b);
+    bideg rhs_num = deg_max(deg_add(r1, deg_add(cd, r2)), deg_add(r1, deg_add(r2, dd)));
+    bideg rhs_den = deg_add(r2, deg_add(dd, r2));
+    return deg_max(deg_add(lhs_num, rhs_den), deg_add(rhs_num, lhs_den));
+}
+
+/* The sums of P have no negative exponents. */
+static bool bipoly_polynomial(const bipoly* const P) {
+    for (size_t i = 0; i < P->n; i++) {
+        if (P->p[i].n && P->p[i].terms[P->p[i].n - 1].exp < 0) return false;
+    }
+    return true;
+}
+
+static void* wz_alloc(size_t n, size_t size) {
+    void* ptr = calloc(n ? n : 1, size);
+    if (!ptr) {
+        perror("Could not allocate memory in wz");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+/* ---------------- modular ---------------- */
+
+static uint64_t next_random(uint64_t* s) {
+    uint64_t z = (*s += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t random_prime(uint64_t* s) {
+    uint64_t c = ((uint64_t) 1 << WZ_PRIME_BITS) | (next_random(s) >> (64 - WZ_PRIME_BITS)) | 1;
+    while (!is_prime_u64(c)) c += 2;
+    return c;
+}
+
+/* The coefficients p[i](k) of P at the nk points ks, with vals[i nk + t] = p[i](ks[t]). */
+static uint64_t* bipoly_at_k(const bipoly* const P, const uint64_t* ks, size_t nk, uint64_t q) {
+    uint64_t* vals = wz_alloc(P->n * nk, sizeof(uint64_t));
+    for (size_t i = 0; i < P->n; i++) sum_eval_mod_batch(&P->p[i], ks, nk, q, vals + i * nk);
+    return vals;
+}
+
+/* Horner's rule in n over the coefficients at point t of bipoly_at_k. */
+static uint64_t horner_n(const uint64_t* vals, size_t n, size_t nk, size_t t, uint64_t x, uint64_t q) {
+    uint64_t acc = 0;
+    for (size_t i = n; i-- > 0;) acc = mod_add(mod_mul(acc, x, q), vals[i * nk + t], q);
+    return acc;
+}
+
+static uint64_t cleared_mod(const hyper_term* F, const sum* c, size_t order, const bipoly* rn, const bipoly* rd,
+                            uint64_t n, uint64_t k, uint64_t q) {
+    uint64_t ks[] = {k, mod_add(k, 1, q)};
+    uint64_t* va = bipoly_at_k(&F->num_n, ks, 1, q);
+    uint64_t* vb = bipoly_at_k(&F->den_n, ks, 1, q);
+    uint64_t* vc = bipoly_at_k(&F->num_k, ks, 1, q);
+    uint64_t* vd = bipoly_at_k(&F->den_k, ks, 1, q);
+    uint64_t* vrn = bipoly_at_k(rn, ks, 2, q);
+    uint64_t* vrd = bipoly_at_k(rd, ks, 2, q);
+
+    // prefix products of a(n + j) and suffix products of b(n + j)
+    uint64_t* pre = wz_alloc(order + 1, sizeof(uint64_t));
+    uint64_t* suf = wz_alloc(order + 1, sizeof(uint64_t));
+    pre[0] = suf[order] = 1;
+    for (size_t j = 0; j < order; j++) {
+        uint64_t x = mod_add(n, j % q, q);
+        pre[j + 1] = mod_mul(pre[j], horner_n(va, F->num_n.n, 1, 0, x, q), q);
+    }
+    for (size_t j = order; j-- > 0;) {
+        uint64_t x = mod_add(n, j % q, q);
+        suf[j] = mod_mul(suf[j + 1], horner_n(vb, F->den_n.n, 1, 0, x, q), q);
+    }
+    uint64_t lhs_num = 0;
+    for (size_t i = 0; i <= order; i++) {
+        uint64_t ci;
+        sum_eval_mod_batch(&c[i], &n, 1, q, &ci);
+        lhs_num = mod_add(lhs_num, mod_mul(ci, mod_mul(pre[i], suf[i], q), q), q);
+    }
+    uint64_t lhs_den = suf[0];
+
+    uint64_t cv = horner_n(vc, F->num_k.n, 1, 0, n, q);
+    uint64_t dv = horner_n(vd, F->den_k.n, 1, 0, n, q);
+    uint64_t r0n = horner_n(vrn, rn->n, 2, 0, n, q), r1n = horner_n(vrn, rn->n, 2, 1, n, q);
+    uint64_t r0d = horner_n(vrd, rd->n, 2, 0, n, q), r1d = horner_n(vrd, rd->n, 2, 1, n, q);
+    uint64_t rhs_num = mod_sub(mod_mul(mod_mul(r1n, cv, q), r0d, q), mod_mul(mod_mul(r0n, r1d, q), dv, q), q);
+    uint64_t rhs_den = mod_mul(mod_mul(r1d, dv, q), r0d, q);
+
+    free(va);
+    free(vb);
+    free(vc);
+    free(vd);
+    free(vrn);
+    free(vrd);
+    free(pre);
+    free(suf);
+    return mod_sub(mod_mul(lhs_num, rhs_den, q), mod_mul(rhs_num, lhs_den, q), q);
+}
+
+/* ---------------- exact ---------------- */
+
+/* a b, freeing a. */
+static mp_int mul_take(mp_int a, const mp_int* const b) {
+    mp_int r = mpint_prod(&a, b);
+    mpint_free(&a);
+    return r;
+}
+
+static mp_int bipoly_eval(const bipoly* const P, long n, long k) {
+    mp_int acc = mpint_from_long(0);
+    mp_int x = mpint_from_long(n);
+    for (size_t i = P->n; i-- > 0;) {
+        // wz_verify_recurrence checked the exponents
+        mp_int v;
+        mpint_eval_sum(&P->p[i], k, &v);
+        acc = mul_take(acc, &x);
+        mp_int s = mpint_add(&acc, &v);
+        mpint_free(&acc);
+        mpint_free(&v);
+        acc = s;
+    }
+    mpint_free(&x);
+    return acc;
+}
+
+static bool cleared_zero(const hyper_term* F, const sum* c, size_t order, const bipoly* rn, const bipoly* rd,
+                         long n, long k) {
+    mp_int* pre = wz_alloc(order + 1, sizeof(mp_int));
+    mp_int* suf = wz_alloc(order + 1, sizeof(mp_int));
+    pre[0] = mpint_from_long(1);
+    suf[order] = mpint_from_long(1);
+    for (size_t j = 0; j < order; j++) {
+        mp_int a = bipoly_eval(&F->num_n, n + (long) j, k);
+        pre[j + 1] = mpint_prod(&pre[j], &a);
+        mpint_free(&a);
+    }
+    for (size_t j = order; j-- > 0;) {
+        mp_int b = bipoly_eval(&F->den_n, n + (long) j, k);
+        suf[j] = mpint_prod(&suf[j + 1], &b);
+        mpint_free(&b);
+    }
+    mp_int lhs_num = mpint_from_long(0);
+    for (size_t i = 0; i <= order; i++) {
+        mp_int t;
+        mpint_eval_sum(&c[i], n, &t);
+        t = mul_take(t, &pre[i]);
+        t = mul_take(t, &suf[i]);
+        mp_int s = mpint_add(&lhs_num, &t);
+        mpint_free(&lhs_num);
+        mpint_free(&t);
+        lhs_num = s;
+    }
+
+    mp_int cv = bipoly_eval(&F->num_k, n, k), dv = bipoly_eval(&F->den_k, n, k);
+    mp_int r0n = bipoly_eval(rn, n, k), r1n = bipoly_eval(rn, n, k + 1);
+    mp_int r0d = bipoly_eval(rd, n, k), r1d = bipoly_eval(rd, n, k + 1);
+    mp_int x = mul_take(mpint_prod(&r1n, &cv), &r0d);
+    mp_int y = mul_take(mpint_prod(&r0n, &r1d), &dv);
+    mp_int rhs_num = mpint_sub(&x, &y);
+    mp_int rhs_den = mul_take(mpint_prod(&r1d, &dv), &r0d);
+    mp_int u = mpint_prod(&lhs_num, &rhs_den);
+    mp_int v = mpint_prod(&rhs_num, &suf[0]);
+    bool zero = mpint_eq(&u, &v);
+
+    mp_int* tmp[] = {&lhs_num, &cv, &dv, &r0n, &r1n, &r0d, &r1d, &x, &y, &rhs_num, &rhs_den, &u, &v};
+    for (size_t i = 0; i < sizeof(tmp) / sizeof(tmp[0]); i++) mpint_free(tmp[i]);
+    for (size_t i = 0; i <= order; i++) {
+        mpint_free(&pre[i]);
+        mpint_free(&suf[i]);
+    }
+    free(pre);
+    free(suf);
+    return zero;
+}
+
+/* ---------------- checks ---------------- */
+
+bool wz_verify_recurrence(const hyper_term* F, const sum* c, size_t order, const bipoly* r_num, const bipoly* r_den,
+                          const wz_opts* opts) {
+    const bipoly coeffs = {.n = order + 1, .p = c};
+    const bipoly* all[] = {&F->num_n, &F->den_n, &F->num_k, &F->den_k, r_num, r_den, &coeffs};
+    for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+        if (!bipoly_polynomial(all[i])) return false;
+    }
+    wz_opts o = opts ? *opts : (wz_opts){0};
+    bideg d = identity_deg(F, c, order, r_num, r_den);
+    if (o.exact) {
+        // a polynomial that vanishes on a grid larger than its degrees in each variable is zero
+        for (long n = 0; n <= d.n; n++) {
+            for (long k = 0; k <= d.k; k++) {
+                if (!cleared_zero(F, c, order, r_num, r_den, n, k)) return false;
+            }
+        }
+        return true;
+    }
+    double max_error = o.max_error > 0 ? o.max_error : ldexp(1, -100);
+    double per_trial = (double) (d.n + d.k > 0 ? d.n + d.k : 1) / ldexp(1, WZ_PRIME_BITS);
+    long trials = per_trial < 1 ? (long) ceil(log(max_error) / log(per_trial)) : 1;
+    if (trials < 1) trials = 1;
+    uint64_t s = o.seed;
+    for (long t = 0; t < trials; t++) {
+        uint64_t q = random_prime(&s);
+        uint64_t n = next_random(&s) % q, k = next_random(&s) % q;
+        if (cleared_mod(F, c, order, r_num, r_den, n, k, q)) return false;
+    }
+    return true;
+}
+
+bool wz_verify_pair(const hyper_term* F, const bipoly* r_num, const bipoly* r_den, const wz_opts* opts) {
+    // F(n + 1, k) - F(n, k) is the recurrence with coefficients -1 and 1
+    term minus_one = {.exp = 0, .coeff = -1}, one = {.exp = 0, .coeff = 1};
+    sum c[] = {
+        {.n = 1, .capacity = 0, .terms = &minus_one},
+        {.n = 1, .capacity = 0, .terms = &one}
+    };
+    return wz_verify_recurrence(F, c, 1, r_num, r_den, opts);
+}
@@ -0,0 +1,55 @@
+/** Verification of WZ pairs and creative-telescoping recurrences by evaluation instead of symbolic normalization.
+ * A hypergeometric term F(n, k) is given by its two shift quotients, and a certificate by a rational function R, so
+ * that G = R F. Dividing the identity to check by F(n, k) leaves a rational function identity in n and k, and
+ * clearing its denominators leaves a polynomial N(n, k) that must vanish. The modular check evaluates N at random
+ * points modulo random primes near 2^62: if N is not zero, each trial wrongly passes with probability at most
+ * deg(N) / 2^61 (Schwartz-Zippel). The exact check evaluates N over the integers on a grid larger than its degrees
+ * in n and in k, which proves that it vanishes. */
+#ifndef WZ_H_INCLUDED
+#define WZ_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "./sum.h"
+
+/* A polynomial in n and k, as the sum over i < n of n^i p[i](k). */
+typedef struct bipoly bipoly;
+
+struct bipoly {
+    size_t n;
+    const sum* p;
+};
+
+/* F(n + 1, k) / F(n, k) = num_n / den_n and F(n, k + 1) / F(n, k) = num_k / den_k. */
+typedef struct hyper_term hyper_term;
+
+struct hyper_term {
+    bipoly num_n;
+    bipoly den_n;
+    bipoly num_k;
+    bipoly den_k;
+};
+
+typedef struct wz_opts wz_opts;
+
+struct wz_opts {
+    // bound on the probability of accepting a false identity; 0 means 2^-100
+    double max_error;
+    // seed of the random points and primes; runs with the same seed draw the same ones
+    uint64_t seed;
+    // check exactly on a grid instead of at random points
+    bool exact;
+};
+
+/* Checks F(n + 1, k) - F(n, k) = G(n, k + 1) - G(n, k) for G = (r_num / r_den) F. Returns true if the identity
+ * holds, up to the error bound of opts unless opts->exact is set. opts may be null for the defaults. All the
+ * polynomials must have nonnegative exponents; false is returned otherwise. */
+bool wz_verify_pair(const hyper_term* F, const bipoly* r_num, const bipoly* r_den, const wz_opts* opts);
+
+/* Checks the telescoping relation c[0](n) F(n, k) + ... + c[order](n) F(n + order, k) = G(n, k + 1) - G(n, k) for
+ * G = (r_num / r_den) F, with coefficients c in n alone. */
+bool wz_verify_recurrence(const hyper_term* F, const sum* c, size_t order, const bipoly* r_num, const bipoly* r_den,
+                          const wz_opts* opts);
+
+#endif
@@ -0,0 +1,73 @@
+/** Helpers shared by the tests. Unlike assert, CHECK always evaluates its condition, so a call whose effects the
+ * test relies on goes in CHECK, and a test built with NDEBUG still runs it. */
+#ifndef TEST_HELPERS_H_INCLUDED
+#define TEST_HELPERS_H_INCLUDED
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../polynomial/sum.h"
+#include "../polynomial/parse.h"
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            abort(); \
+        } \
+    } while (0)
+
+/* The polynomial s, which must parse. */
+static inline sum text_sum(const char* s) {
+    sum p;
+    parse_error err;
+    if (parse_sum(s, strlen(s), &p, &err) != PARSE_OK) {
+        fprintf(stderr, "could not parse \"%s\": %s at %zu\n", s, parse_strerror(err.status), err.pos);
+        abort();
+    }
+    return p;
+}
+
+/* a and b have the same terms. */
+static inline bool same_sum(const sum* const a, const sum* const b) {
+    if (a->n != b->n) return false;
+    for (size_t i = 0; i < a->n; i++) {
+        if (a->terms[i].exp != b->terms[i].exp || a->terms[i].coeff != b->terms[i].coeff) return false;
+    }
+    return true;
+}
+
+/* A sparse polynomial with up to n terms of degree below maxdeg and coefficients between -9 and 9. */
+static inline sum random_sum(size_t n, int maxdeg) {
+    char* text = malloc(n * 32 + 2);
+    CHECK(text);
+    size_t len = 0;
+    for (size_t i = 0; i < n; i++) {
+        len += (size_t) sprintf(text + len, "%+dx^%d", rand() % 19 - 9, rand() % maxdeg);
+    }
+    // parse_sum sorts the terms and combines like ones
+    if (!len) len = (size_t) sprintf(text, "0");
+    sum out = text_sum(text);
+    free(text);
+    return out;
+}
+
+/* A polynomial of degree n - 1 whose coefficients are drawn from -bound, ..., bound, so that about one in
+ * 2 bound + 1 of them is zero; the leading one is made nonzero. */
+static inline sum random_dense_sum(size_t n, long bound) {
+    sum out = {.n = 0, .capacity = 0, .terms = malloc((n ? n : 1) * sizeof(term))};
+    CHECK(out.terms);
+    for (size_t i = 0; i < n; i++) {
+        long c = rand() % (2 * bound + 1) - bound;
+        if (!i && !c) c = bound;
+        if (c) out.terms[out.n++] = (term) {.exp = (int) (n - 1 - i), .coeff = c};
+    }
+    if (!out.n) {
+        free(out.terms);
+        return zero_polynomial();
+    }
+    return out;
+}
+
+#endif
@@ -0,0 +1,57 @@
+#include "../../numeric/coeff_vec.h"
+#include "../../numeric/euclid.h"
+#include "limits.h"
+#include "assert.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+#define N 37
+
+int main(int argc, char* argv[argc]) {
+    const char* names[] = {"scalar", "avx2", "avx512"};
+    long x[N], y[N], z[N], w[N];
+    srand(1);
+    for (size_t i = 0; i < N; i++) {
+        x[i] = (i % 2 ? -1 : 1) * (long) (rand() % 1000) * 12;
+        z[i] = rand() % 100 - 50;
+    }
+
+    // every instruction set the CPU supports must agree with plain arithmetic
+    for (int isa = CVEC_SCALAR; isa <= CVEC_AVX512; isa++) {
+        cvec_isa used = cvec_set_isa(isa);
+        for (size_t i = 0; i < N; i++) {
+            y[i] = x[i];
+            w[i] = z[i];
+        }
+        cvec_scale(N, y, -3);
+        for (size_t i = 0; i < N; i++) assert(y[i] == -3 * x[i]);
+        cvec_divexact(N, y, -36);
+        for (size_t i = 0; i < N; i++) assert(y[i] == x[i] / 12);
+        cvec_negate(N, y);
+        for (size_t i = 0; i < N; i++) assert(y[i] == -x[i] / 12);
+        cvec_addmul(N, w, 7, x);
+        for (size_t i = 0; i < N; i++) assert(w[i] == z[i] + 7 * x[i]);
+
+        // the content against gcds taken one entry at a time, with the content dropping at every position
+        long c[N];
+        for (size_t drop = 0; drop <= N; drop++) {
+            for (long d = 1; d <= 96; d += 19) {
+                for (size_t i = 0; i < N; i++) {
+                    c[i] = i == drop ? 7 * d + 1 : (i % 3 ? -1 : 1) * d * (long) (rand() % 50);
+                }
+                assert(cvec_content(N, c) == list_gcd(N, c));
+            }
+        }
+        assert(cvec_content(N, x) == 12);
+        for (size_t i = 0; i < N; i++) c[i] = i % 4 ? 0 : LONG_MIN;
+        c[N - 1] = 3L << 40;
+        assert(cvec_content(N, c) == 1L << 40);
+        c[N - 1] = 0;
+        c[5] = -6;
+        assert(cvec_content(N, c) == 2);
+        for (size_t i = 0; i < N; i++) c[i] = 0;
+        assert(cvec_content(N, c) == 0);
+        printf("%s kernels agree with scalar arithmetic\n", names[used]);
+    }
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include "../../numeric/euclid.h"
 #include "assert.h"
+#include "limits.h"
 #include "stdio.h"
 
 int main(int argc, char* argv[argc]) {
@@ -19,7 +20,19 @@ int main(int argc, char* argv[argc]) {
     printf("The gcd of %ld and %ld is %ld, with %ld, %ld being Bezout coefficients\n", 
             a, b, r.gcd, r.a, r.b);
     
-    //assert(a * r.a + b * r.b == 1);
+    assert(a * r.a + b * r.b == 1);
+
+    a = -12; b = 18;
+    printf("the gcd of %ld and %ld is %ld\n", a, b, gcd(a, b));
+    assert(gcd(a, b) == 6);
+
+    // the magnitudes are taken without overflow
+    assert(gcd(LONG_MIN, 6) == 2);
+    assert(gcd(LONG_MIN, LONG_MAX) == 1);
+    assert(gcd(LONG_MIN, -(1L << 40)) == 1L << 40);
+    assert(ugcd(1UL << 63, 1UL << 63) == 1UL << 63);
+    long mins[3] = {LONG_MIN, 0, 12};
+    assert(list_gcd(3, mins) == 4);
 
     return 0;
 }
\ No newline at end of file
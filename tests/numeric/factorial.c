@@ -0,0 +1,142 @@
+#include "../../numeric/factorial.h"
+#include "../../numeric/modular.h"
+#include "../../util/thread_pool.h"
+#include "assert.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+static void expect(const mp_int* v, const char* s) {
+    char* got = mpint_to_string(v, NULL);
+    printf("%s\n", got);
+    assert(!strcmp(got, s));
+    free(got);
+}
+
+/* 1 2 ... n, one multiplication at a time. */
+static mp_int slow_fact(size_t n) {
+    mp_int r = mpint_from_long(1);
+    for (size_t i = 2; i <= n; i++) {
+        mp_int m = mpint_from_long((long) i);
+        mp_int t = mpint_prod(&r, &m);
+        mpint_free(&r);
+        mpint_free(&m);
+        r = t;
+    }
+    return r;
+}
+
+static uint64_t to_mod(const mp_int* v, uint64_t p) {
+    mp_int mp = mpint_from_long((long) p);
+    mp_int r = mpint_mod(v, &mp);
+    uint64_t out = mpint_size(&r) ? mpint_limbs(&r)[0] : 0;
+    if (r.sgn && out) out = p - out;
+    mpint_free(&mp);
+    mpint_free(&r);
+    return out;
+}
+
+static void lookup_task(void* arg) {
+    size_t n = (size_t) arg;
+    mp_int expected = slow_fact(n);
+    assert(mpint_eq(fact_table_get(n), &expected));
+    mpint_free(&expected);
+}
+
+int main(int argc, char* argv[argc]) {
+    expect(fact_table_get(0), "1");
+    expect(fact_table_get(20), "2432902008176640000");
+    mp_int f = mpint_fact(25);
+    expect(&f, "15511210043330985984000000");
+    mpint_free(&f);
+
+    // concurrent lookups extend the table and read it at the same time
+    fact_table_clear();
+    tpool* pool = tpool_create(4);
+    for (size_t n = 0; n < 600; n += 7) tpool_submit(pool, lookup_task, (void*) (600 - n));
+    tpool_wait(pool);
+    tpool_free(pool);
+
+    // the prime swing beyond the table agrees with the plain product
+    for (size_t n = FACT_TABLE_MAX; n <= FACT_TABLE_MAX + 3; n++) {
+        mp_int a = mpint_fact(n);
+        mp_int b = slow_fact(n);
+        assert(mpint_eq(&a, &b));
+        mpint_free(&a);
+        mpint_free(&b);
+    }
+    printf("%d! has %zu bits\n", FACT_TABLE_MAX - 1, mpint_bits(fact_table_get(FACT_TABLE_MAX - 1)));
+
+    mp_int c = mpint_binom(100, 3);
+    expect(&c, "161700");
+    mpint_free(&c);
+    c = mpint_binom(3, 5);
+    expect(&c, "0");
+    mpint_free(&c);
+    c = mpint_binom(100, 50);
+    expect(&c, "100891344545564193334812497256");
+    mpint_free(&c);
+    // both ways of computing binomials against n! / (k! (n - k)!)
+    size_t ks[] = {0, 7, 32, 33, 200, 999, 1000};
+    for (size_t i = 0; i < sizeof(ks) / sizeof(ks[0]); i++) {
+        mp_int b = mpint_binom(1000, ks[i]);
+        mp_int d = mpint_prod(fact_table_get(ks[i]), fact_table_get(1000 - ks[i]));
+        mp_int q = mpint_div(fact_table_get(1000), &d);
+        assert(mpint_eq(&b, &q));
+        mpint_free(&b);
+        mpint_free(&d);
+        mpint_free(&q);
+    }
+
+    mp_int r = mpint_rising(5, 3);
+    expect(&r, "210");
+    mpint_free(&r);
+    r = mpint_rising(-3, 3);
+    expect(&r, "-6");
+    mpint_free(&r);
+    r = mpint_rising(-4, 2);
+    expect(&r, "12");
+    mpint_free(&r);
+    r = mpint_rising(-3, 4);
+    expect(&r, "0");
+    mpint_free(&r);
+    r = mpint_rising(1, 30);
+    mp_int f30 = mpint_fact(30);
+    assert(mpint_eq(&r, &f30));
+    mpint_free(&r);
+    mpint_free(&f30);
+
+    // modular variants against the exact values
+    uint64_t p = mod_prime(0);
+    for (size_t n = 0; n < 300; n += 37) {
+        assert(fact_mod(n, p) == to_mod(fact_table_get(n), p));
+        for (size_t k = 0; k <= n; k += 11) {
+            mp_int b = mpint_binom(n, k);
+            assert(binom_mod(n, k, p) == to_mod(&b, p));
+            mpint_free(&b);
+        }
+        mp_int ri = mpint_rising(-150, n);
+        assert(rising_mod(-150, n, p) == to_mod(&ri, p));
+        mpint_free(&ri);
+    }
+    assert(fact_mod(13, 13) == 0 && fact_mod(12, 13) == 12);
+    // Lucas' theorem for n >= p
+    for (uint64_t n = 0; n < 60; n++) {
+        for (uint64_t k = 0; k <= n; k++) {
+            mp_int b = mpint_binom(n, k);
+            assert(binom_mod(n, k, 7) == to_mod(&b, 7));
+            mpint_free(&b);
+        }
+    }
+    assert(rising_mod(3, 7, 7) == 0);
+
+    mod_fact_table t = mod_fact_table_init(1000, p);
+    for (size_t n = 0; n <= 1000; n += 97) {
+        for (size_t k = 0; k <= n + 1; k += 13) assert(mod_fact_table_binom(&t, n, k) == binom_mod(n, k, p));
+    }
+    mod_fact_table_free(&t);
+    printf("modular factorials agree\n");
+
+    fact_table_clear();
+    return 0;
+}
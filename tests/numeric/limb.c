@@ -0,0 +1,95 @@
+#include "../../numeric/limb.h"
+#include "../../numeric/mp_int.h"
+#include "assert.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define N 37
+
+typedef unsigned __int128 uint128_t;
+
+static uint64_t rand_limb(int i) {
+    // runs of all-ones limbs make carries ripple through whole vectors
+    if (i % 5 < 2) return ~(uint64_t) 0;
+    return ((uint64_t) rand() << 40) ^ ((uint64_t) rand() << 20) ^ (uint64_t) rand();
+}
+
+/* a * m + c, limb by limb, as a reference. */
+static uint64_t ref_mul_1(uint64_t* r, const uint64_t* a, size_t n, uint64_t m, const uint64_t* c, int sign) {
+    uint128_t carry = 0;
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint128_t p = (uint128_t) a[i] * m + carry;
+        carry = p >> 64;
+        uint64_t lo = (uint64_t) p;
+        if (sign >= 0) {
+            uint128_t s = (uint128_t) lo + (c ? c[i] : 0) + borrow;
+            r[i] = (uint64_t) s;
+            borrow = (uint64_t) (s >> 64);
+        } else {
+            uint128_t d = (uint128_t) c[i] - lo - borrow;
+            r[i] = (uint64_t) d;
+            borrow = (uint64_t) (d >> 64) & 1;
+        }
+    }
+    return (uint64_t) carry + borrow;
+}
+
+int main(int argc, char* argv[argc]) {
+    const char* names[] = {"scalar", "adx"};
+    uint64_t a[N], b[N], r[N], s[N];
+    srand(3);
+    for (int i = 0; i < N; i++) {
+        a[i] = rand_limb(i);
+        b[i] = rand_limb(i + 2);
+    }
+    uint64_t ms[] = {0, 1, 3, ~(uint64_t) 0, 0x9e3779b97f4a7c15};
+
+    // every instruction set the CPU supports must agree with the reference
+    for (int isa = LIMB_SCALAR; isa <= LIMB_ADX; isa++) {
+        limb_isa used = limb_set_isa(isa);
+        for (size_t n = 0; n <= N; n += 6) {
+            uint64_t c = limb_add_n(r, a, b, n);
+            uint64_t d = limb_sub_n(s, r, b, n);
+            assert(!memcmp(s, a, n * sizeof(uint64_t)) && c == d);
+            for (size_t k = 0; k < sizeof(ms) / sizeof(ms[0]); k++) {
+                uint64_t m = ms[k];
+                c = limb_mul_1(r, a, n, m);
+                assert(c == ref_mul_1(s, a, n, m, NULL, 1) && !memcmp(r, s, n * sizeof(uint64_t)));
+                memcpy(r, b, sizeof(b));
+                c = limb_addmul_1(r, a, n, m);
+                assert(c == ref_mul_1(s, a, n, m, b, 1) && !memcmp(r, s, n * sizeof(uint64_t)));
+                memcpy(r, b, sizeof(b));
+                c = limb_submul_1(r, a, n, m);
+                assert(c == ref_mul_1(s, a, n, m, b, -1) && !memcmp(r, s, n * sizeof(uint64_t)));
+            }
+        }
+        printf("%s kernels agree with the reference\n", names[used]);
+    }
+    limb_set_isa(LIMB_ADX);
+
+    // the single-limb carries, in place and not
+    uint64_t ones[3] = {~(uint64_t) 0, ~(uint64_t) 0, 5};
+    assert(limb_add_1(r, ones, 3, 1) == 0 && r[0] == 0 && r[1] == 0 && r[2] == 6);
+    assert(limb_sub_1(r, r, 3, 1) == 0 && !memcmp(r, ones, sizeof(ones)));
+    assert(limb_add_1(r, ones, 2, 1) == 1);
+    uint64_t zero[2] = {0, 0};
+    assert(limb_sub_1(r, zero, 2, 1) == 1 && r[0] == ~(uint64_t) 0 && r[1] == ~(uint64_t) 0);
+
+    // mp_int runs on the kernels: (10^40 + 1)^2 - 10^80 = 2 10^40 + 1
+    mp_int x = mpint_init("10000000000000000000000000000000000000001");
+    mp_int y = mpint_prod(&x, &x);
+    mp_int z = mpint_init("1" "0000000000" "0000000000" "0000000000" "0000000000"
+                          "0000000000" "0000000000" "0000000000" "0000000000");
+    mp_int w = mpint_sub(&y, &z);
+    mpint_display(&w);
+    mp_int q = mpint_div(&y, &x);
+    assert(mpint_eq(&q, &x));
+    mpint_free(&x);
+    mpint_free(&y);
+    mpint_free(&z);
+    mpint_free(&w);
+    mpint_free(&q);
+    return 0;
+}
@@ -0,0 +1,31 @@
+#include "../../numeric/modular.h"
+#include "assert.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+static uint64_t random_word(void) {
+    return ((uint64_t) rand() << 42) ^ ((uint64_t) rand() << 21) ^ (uint64_t) rand();
+}
+
+int main(int argc, char* argv[argc]) {
+    srand(1);
+    // table primes, a small prime and primes close to 2^63
+    uint64_t primes[] = {mod_prime(0), mod_prime(5), 1000003, 9223372036854775783UL, 9223372036854775643UL};
+    for (size_t k = 0; k < sizeof(primes) / sizeof(primes[0]); k++) {
+        uint64_t p = primes[k];
+        assert(is_prime_u64(p));
+        mod_mont m = mod_mont_init(p);
+        mod_barrett b = mod_barrett_init(p);
+        for (int i = 0; i < 20000; i++) {
+            uint64_t x = random_word() % p, y = random_word() % p;
+            uint64_t e = mod_mul(x, y, p);
+            assert(mod_mont_from(&m, mod_mont_mul(&m, mod_mont_to(&m, x), mod_mont_to(&m, y))) == e);
+            assert(mod_barrett_mul(&b, x, y) == e);
+            assert(mod_shoup_mul(x, y, mod_shoup_precomp(y, p), p) == e);
+        }
+        uint64_t x = random_word() % p;
+        assert(mod_mont_pow(&m, x, p - 1) == 1 && mod_mont_pow(&m, x, 12345) == mod_pow(x, 12345, p));
+        printf("%lu ok\n", p);
+    }
+    return 0;
+}
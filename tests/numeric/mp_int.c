@@ -0,0 +1,34 @@
+#include "../../numeric/mp_int.h"
+#include "assert.h"
+#include "stdio.h"
+
+int main(int argc, char* argv[argc]) {
+    mp_int a = mpint_init("123456789012345678901234567890123456789");
+    mp_int b = mpint_init("-98765432109876543210987654321");
+
+    mp_int s = mpint_add(&a, &b);
+    mp_int p = mpint_prod(&a, &b);
+    printf("sum: ");
+    mpint_display(&s);
+    printf("product: ");
+    mpint_display(&p);
+
+    mp_int q, r;
+    mpint_divmod(&p, &b, &q, &r);
+    assert(mpint_eq(&q, &a) && !mpint_nz(&r));
+
+    // gcd(a * c, b * c) = c * gcd(a, b), and gcd(a, b) = 9 here
+    mp_int c = mpint_init("1000000000000000000000000000057");
+    mp_int ac = mpint_prod(&a, &c);
+    mp_int bc = mpint_prod(&b, &c);
+    mp_int g = mpint_gcd(&ac, &bc);
+    printf("gcd: ");
+    mpint_display(&g);
+    mp_int nine = mpint_from_long(9);
+    mp_int c9 = mpint_prod(&c, &nine);
+    assert(mpint_eq(&g, &c9));
+
+    mpint_free(&a); mpint_free(&b); mpint_free(&s); mpint_free(&p); mpint_free(&q); mpint_free(&r);
+    mpint_free(&c); mpint_free(&ac); mpint_free(&bc); mpint_free(&g); mpint_free(&nine); mpint_free(&c9);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "../../numeric/mp_rat.h"
+#include "assert.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+static void expect(mp_rat* r, const char* s) {
+    char* got = mprat_to_string(r, NULL);
+    printf("%s\n", got);
+    assert(!strcmp(got, s));
+    free(got);
+}
+
+int main(int argc, char* argv[argc]) {
+    // word-sized fractions
+    mp_rat a = mprat_from_long(6, -4);
+    mp_rat b = mprat_from_long(5, 6);
+    expect(&a, "-3/2");
+    mp_rat s = mprat_add(&a, &b);
+    expect(&s, "-2/3");
+    mp_rat d = mprat_sub(&a, &a);
+    expect(&d, "0");
+    mp_rat p = mprat_mul(&a, &b);
+    expect(&p, "-5/4");
+    mp_rat q = mprat_div(&p, &a);
+    assert(mprat_eq(&q, &b));
+    assert(mprat_cmp(&a, &b) < 0 && mprat_cmp(&b, &a) > 0 && mprat_cmp(&q, &b) == 0);
+    assert(mprat_sgn(&a) == -1 && mprat_sgn(&d) == 0 && mprat_sgn(&b) == 1);
+    mprat_free(&s);
+    mprat_free(&d);
+    mprat_free(&p);
+    mprat_free(&q);
+
+    // the harmonic number H(100) outgrows a word and is reduced lazily along the way
+    mp_rat h = mprat_from_long(0, 1);
+    for (long k = 1; k <= 100; k++) {
+        mp_rat t = mprat_from_long(1, k);
+        mp_rat n = mprat_add(&h, &t);
+        mprat_free(&h);
+        mprat_free(&t);
+        h = n;
+    }
+    expect(&h, "14466636279520351160221518043104131447711/2788815009188499086581352357412492142272");
+    mp_rat hi = mprat_inv(&h);
+    mp_rat one = mprat_mul(&h, &hi);
+    assert(mprat_is_int(&one) && mprat_cmp(&one, &b) > 0);
+    mp_rat neg = mprat_neg(&h);
+    assert(mprat_cmp(&neg, &a) < 0 && mprat_cmp(&a, &h) < 0);
+    mprat_free(&hi);
+    mprat_free(&one);
+    mprat_free(&neg);
+
+    // unreduced parts are reduced before comparison
+    mp_int x = mpint_init("340282366920938463463374607431768211456");
+    mp_int y = mpint_init("-680564733841876926926749214863536422912");
+    mp_rat half = mprat_from_mpint(&x, &y);
+    mp_rat mhalf = mprat_from_long(-1, 2);
+    assert(mprat_eq(&half, &mhalf));
+    expect(&half, "-1/2");
+    mpint_free(&x);
+    mpint_free(&y);
+
+    // vectors over a shared denominator
+    mprat_vec v = mprat_vec_zero(3);
+    mprat_vec_set(&v, 0, &a);
+    mprat_vec_set(&v, 2, &b);
+    mprat_vec w = mprat_vec_copy(&v);
+    mprat_vec_set(&w, 1, &h);
+    // v - 2 w leaves -w except in entry 1
+    mp_rat two = mprat_from_long(-2, 1);
+    mprat_vec_axpy(&v, &two, &w);
+    mprat_vec_canonicalize(&v);
+    for (size_t i = 0; i < 3; i++) {
+        mp_rat e = mprat_vec_get(&v, i);
+        mp_rat f = mprat_vec_get(&w, i);
+        mp_rat g = i == 1 ? mprat_mul(&f, &two) : mprat_neg(&f);
+        assert(mprat_eq(&e, &g));
+        mprat_free(&e);
+        mprat_free(&f);
+        mprat_free(&g);
+    }
+    mprat_vec_scale(&v, &mhalf);
+    mp_rat e = mprat_vec_get(&v, 0);
+    expect(&e, "-3/4");
+    mprat_free(&e);
+    mprat_vec_free(&v);
+    mprat_vec_free(&w);
+
+    mprat_free(&two);
+    mprat_free(&half);
+    mprat_free(&mhalf);
+    mprat_free(&h);
+    mprat_free(&a);
+    mprat_free(&b);
+    return 0;
+}
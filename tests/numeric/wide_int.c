@@ -0,0 +1,64 @@
+#include "../../numeric/wide_int.h"
+#include "../helpers.h"
+#include "assert.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+/* A 256-bit value from a signed 128-bit high half and an unsigned low half. */
+static i256 make(i128 hi, u128 lo) {
+    i256 r = i256_from_i128(hi);
+    r.w[3] = r.w[1];
+    r.w[2] = r.w[0];
+    r.w[1] = (uint64_t) (lo >> 64);
+    r.w[0] = (uint64_t) lo;
+    return r;
+}
+
+int main(int argc, char* argv[argc]) {
+    srand(1);
+    // agreement with the compiler's 128-bit arithmetic on values that fit
+    for (int i = 0; i < 10000; i++) {
+        int64_t x = (int64_t) (((uint64_t) rand() << 33) ^ ((uint64_t) rand() << 2) ^ rand());
+        int64_t y = (int64_t) (((uint64_t) rand() << 31) ^ rand());
+        if (rand() % 2) x = -x;
+        if (rand() % 2) y = -y;
+        if (!y) y = 7;
+        i256 a = i256_from_i64(x), b = i256_from_i64(y), r, q;
+        CHECK(!i256_mul(&r, a, b));
+        i256 e = i256_from_i128((i128) x * y);
+        assert(!i256_cmp(r, e));
+        CHECK(!i256_add(&r, a, b) && !i256_cmp(r, i256_from_i128((i128) x + y)));
+        CHECK(!i256_sub(&r, a, b) && !i256_cmp(r, i256_from_i128((i128) x - y)));
+        i256_divmod(e, b, &q, &r);
+        assert(!i256_cmp(q, a) && !i256_cmp(r, i256_from_i64(0)));
+        i256_divmod(a, b, &q, &r);
+        assert(i256_fits_i64(q) && (int64_t) q.w[0] == x / y && (int64_t) r.w[0] == x % y);
+        assert(i256_cmp(a, b) == (x > y) - (x < y));
+    }
+
+    // (2^128 + 1)^2 = 2^256 + 2^129 + 1 overflows 256 bits unsigned, but not 512
+    u256 a = {{1, 0, 1, 0}}, r, q, m;
+    CHECK(u256_mul(&r, a, a) && r.w[0] == 1 && r.w[2] == 2 && !r.w[3]);
+    u512 a5 = u512_from_u256(a), r5, q5, m5;
+    CHECK(!u512_mul(&r5, a5, a5) && r5.w[0] == 1 && r5.w[2] == 2 && r5.w[4] == 1);
+    u512_divmod(r5, a5, &q5, &m5);
+    assert(!u512_cmp(q5, a5) && !m5.w[0] && !m5.w[1]);
+    // a multi-word divisor
+    u256 big = {{5, 7, 11, 13}};
+    u256 d = {{3, 2, 0, 0}};
+    u256_divmod(big, d, &q, &m);
+    u256 back;
+    CHECK(!u256_mul(&back, q, d) && !u256_add(&back, back, m) && !u256_cmp(back, big) && u256_cmp(m, d) < 0);
+    CHECK(u256_sub(&r, d, big));
+
+    // signed overflow at the edges
+    i256 min = make((i128) ((u128) 1 << 127), 0), one = i256_from_i64(1), minus_one = i256_from_i64(-1), s;
+    CHECK(i256_is_neg(min) && i256_sub(&s, min, one) && !i256_add(&s, min, one));
+    CHECK(i256_mul(&s, min, minus_one) && !i256_mul(&s, min, one) && !i256_cmp(s, min));
+    i256 half = make((i128) 1 << 126, 0), two = i256_from_i64(2), mtwo = i256_from_i64(-2);
+    CHECK(i256_mul(&s, half, two) && !i256_mul(&s, half, mtwo) && !i256_cmp(s, min));
+    i512 w = i512_from_i256(min), w2;
+    CHECK(!i512_mul(&w2, w, w) && !i512_is_neg(w2) && w2.w[7] == (uint64_t) 1 << 62);
+    assert(i512_cmp(i512_neg(w), w) > 0 && !i512_fits_i64(w) && i512_fits_i64(i512_from_i64(-5)));
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <limits.h>
+#include "../../polynomial/bsplit.h"
+#include "../../polynomial/parse.h"
+#include "../helpers.h"
+
+static void check(tpool* pool, const char* a, const char* b, long start, size_t count, const char* num,
+                  const char* den) {
+    sum pa = text_sum(a);
+    sum pb = text_sum(b);
+    mp_int n, d;
+    CHECK(bsplit_sum(pool, &pa, &pb, start, count, &n, &d) == 0);
+    printf("ratio (%s) / (%s):\n", a, b);
+    mpint_display(&n);
+    mpint_display(&d);
+    mp_int en = mpint_init(num);
+    mp_int ed = mpint_init(den);
+    assert(mpint_eq(&n, &en) && mpint_eq(&d, &ed));
+    mpint_free(&n);
+    mpint_free(&d);
+    mpint_free(&en);
+    mpint_free(&ed);
+    free_polynomial(&pa);
+    free_polynomial(&pb);
+}
+
+int main() {
+    sum p = text_sum("2x^3 - x + 5");
+    mp_int v;
+    CHECK(!mpint_eval_sum(&p, -3, &v));
+    assert(mpint_to_long(&v) == -46);
+    mpint_free(&v);
+    free_polynomial(&p);
+    p = text_sum("x + x^-1");
+    CHECK(mpint_eval_sum(&p, 2, &v) == -1);
+
+    tpool* pool = tpool_create(4);
+    for (int i = 0; i < 2; i++) {
+        tpool* pl = i ? pool : NULL;
+        // sum of 1/k! for k < 20
+        check(pl, "1", "x + 1", 0, 20, "82666416490601", "30411275102208");
+        // sum of 2^-k for k < 64
+        check(pl, "1", "2", 0, 64, "18446744073709551615", "9223372036854775808");
+        // the terms cancel
+        check(pl, "-1", "1", 0, 2, "0", "1");
+        // alternating harmonic-like ratio -k / (k + 1) from k = 1: 1 - 1/2 + 1/3 - ...
+        check(pl, "-x", "x + 1", 1, 4, "7", "12");
+        // long enough to be split into tasks: sum of k^2 / start^2 over 1 <= k <= 4096
+        check(pl, "x^2 + 2x + 1", "x^2", 1, 4096, "22914881536", "1");
+        // b vanishes at the last k only, whose ratio does not enter the sum: 1 + 1 / (0 - 1)
+        check(pl, "1", "x - 1", 0, 2, "0", "1");
+    }
+
+    sum a = text_sum("1");
+    sum b = text_sum("x - 700");
+    mp_int n, d;
+    CHECK(bsplit_sum(NULL, &a, &b, 0, 1000, &n, &d) == -1);
+    CHECK(bsplit_sum(pool, &a, &b, 0, 1000, &n, &d) == -1);
+    CHECK(bsplit_sum(pool, &a, &b, 701, 1000, &n, &d) == 0);
+    mpint_free(&n);
+    mpint_free(&d);
+    CHECK(bsplit_sum(pool, &a, &b, 0, 701, &n, &d) == 0);
+    mpint_free(&n);
+    mpint_free(&d);
+    CHECK(bsplit_sum(pool, &a, &b, 0, 702, &n, &d) == -1);
+    CHECK(bsplit_sum(NULL, &p, &b, 0, 10, &n, &d) == -1 && bsplit_sum(NULL, &b, &p, 0, 10, &n, &d) == -1);
+    // the range must end at or below LONG_MAX
+    CHECK(bsplit_sum(NULL, &a, &a, LONG_MAX, 5, &n, &d) == -1);
+    CHECK(bsplit_sum(NULL, &a, &a, 0, (size_t) LONG_MAX + 1, &n, &d) == -1);
+    CHECK(bsplit_sum(NULL, &a, &a, LONG_MAX - 2, 2, &n, &d) == 0);
+    assert(mpint_to_long(&n) == 2 && mpint_to_long(&d) == 1);
+    mpint_free(&n);
+    mpint_free(&d);
+    free_polynomial(&p);
+    free_polynomial(&a);
+    free_polynomial(&b);
+    tpool_free(pool);
+    return 0;
+}
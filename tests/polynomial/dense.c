@@ -0,0 +1,79 @@
+#include "../../polynomial/dense.h"
+#include "../helpers.h"
+#include "assert.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+/* out = a * b by the definition, wrapping modulo 2^64. */
+static void naive_mul(const long* a, size_t na, const long* b, size_t nb, long* out) {
+    for (size_t k = 0; k < na + nb - 1; k++) out[k] = 0;
+    for (size_t i = 0; i < na; i++) {
+        for (size_t j = 0; j < nb; j++) {
+            out[i + j] = (long) ((uint64_t) out[i + j] + (uint64_t) a[i] * (uint64_t) b[j]);
+        }
+    }
+}
+
+/* Full-width words, with a zero about one time in eight. */
+static long random_word() {
+    if (!(rand() % 8)) return 0;
+    return (long) ((uint64_t) rand() << 42 ^ (uint64_t) rand() << 21 ^ (uint64_t) rand());
+}
+
+int main() {
+    srand(11);
+    // around the Karatsuba cutoff, balanced and not, with odd splits and a long operand cut into pieces
+    size_t sizes[] = {1, 2, KARATSUBA_THRESHOLD - 1, KARATSUBA_THRESHOLD, KARATSUBA_THRESHOLD + 1,
+                      2 * KARATSUBA_THRESHOLD - 1, 2 * KARATSUBA_THRESHOLD + 1, 100, 257};
+    size_t ns = sizeof(sizes) / sizeof(sizes[0]);
+    for (size_t s = 0; s < ns; s++) {
+        for (size_t t = 0; t < ns; t++) {
+            size_t na = sizes[s], nb = sizes[t];
+            long* a = malloc(na * sizeof(long));
+            long* b = malloc(nb * sizeof(long));
+            long* got = malloc((na + nb - 1) * sizeof(long));
+            long* want = malloc((na + nb - 1) * sizeof(long));
+            CHECK(a && b && got && want);
+            for (size_t i = 0; i < na; i++) a[i] = random_word();
+            for (size_t i = 0; i < nb; i++) b[i] = random_word();
+            dense_mul(a, na, b, nb, got);
+            naive_mul(a, na, b, nb, want);
+            for (size_t i = 0; i < na + nb - 1; i++) assert(got[i] == want[i]);
+            free(a);
+            free(b);
+            free(got);
+            free(want);
+        }
+    }
+
+    // through sums, against prod, with small coefficients of both signs and zeros in between
+    for (int round = 0; round < 20; round++) {
+        sum p = random_dense_sum(1 + rand() % 150, 5);
+        sum q = random_dense_sum(1 + rand() % 150, 5);
+        size_t np, nq;
+        long* a = dense_from_sum(&p, &np);
+        long* b = dense_from_sum(&q, &nq);
+        long* c = malloc((np + nq - 1) * sizeof(long));
+        CHECK(c);
+        dense_mul(a, np, b, nq, c);
+        sum got = dense_to_sum(c, np + nq - 1);
+        sum want = prod(&p, &q);
+        assert(same_sum(&got, &want));
+        free(a);
+        free(b);
+        free(c);
+        free_polynomial(&got);
+        free_polynomial(&want);
+        free_polynomial(&p);
+        free_polynomial(&q);
+    }
+
+    sum sparse = text_sum("x^100 + x^50 + 1");
+    sum full = text_sum("x^3 - x + 1");
+    assert(!is_dense(&sparse) && is_dense(&full));
+    free_polynomial(&sparse);
+    free_polynomial(&full);
+    printf("dense products agree with schoolbook multiplication\n");
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../../polynomial/dense_mod.h"
+#include "../../polynomial/dense.h"
+#include "../../numeric/modular.h"
+#include "../../numeric/coeff_vec.h"
+
+#define N 45
+
+static int same(const uint64_t* a, size_t na, const uint64_t* b, size_t nb) {
+    return na == nb && !memcmp(a, b, na * sizeof(uint64_t));
+}
+
+int main(int argc, char* argv[argc]) {
+    srand(1);
+    uint64_t primes[] = {mod_prime(0), 9223372036854775783UL, 7};
+    for (size_t k = 0; k < sizeof(primes) / sizeof(primes[0]); k++) {
+        uint64_t p = primes[k];
+        for (int isa = CVEC_SCALAR; isa <= CVEC_AVX2; isa++) {
+            cvec_set_isa(isa);
+            uint64_t a[N], b[N - 7], s[N], d[N], back[N], q[N], r[2 * N], ab[2 * N], g[N];
+            for (size_t i = 0; i < N; i++) a[i] = ((uint64_t) rand() << 33 ^ rand()) % p;
+            for (size_t i = 0; i < N - 7; i++) b[i] = ((uint64_t) rand() << 33 ^ rand()) % p;
+            a[N - 1] = b[N - 8] = 1;
+
+            // a + b - b = a
+            size_t ns = dmod_add(a, N, b, N - 7, s, p);
+            size_t nd = dmod_sub(s, ns, b, N - 7, d, p);
+            assert(same(d, nd, a, N));
+            // a - a = 0
+            assert(!dmod_sub(a, N, a, N, d, p));
+
+            // (a b) / b = a with no remainder, and a = q b + r
+            size_t nab = dmod_prod(a, N, b, N - 7, ab, p);
+            assert(nab == 2 * N - 8);
+            size_t nr, nq = dmod_divrem(ab, nab, b, N - 7, q, r, &nr, p);
+            assert(same(q, nq, a, N) && !nr);
+            nq = dmod_divrem(a, N, b, N - 7, q, r, &nr, p);
+            size_t nqb = dmod_prod(q, nq, b, N - 7, ab, p);
+            size_t nback = dmod_add(ab, nqb, r, nr, back, p);
+            assert(same(back, nback, a, N) && nr < N - 7);
+
+            // gcd(a c, b c) = c for c = x^2 + 3x + 5, as long as gcd(a, b) = 1, which is likely for the large primes
+            uint64_t c[] = {5, 3, 1}, ac[N + 2], bc[N];
+            size_t nac = dmod_prod(a, N, c, 3, ac, p);
+            size_t nbc = dmod_prod(b, N - 7, c, 3, bc, p);
+            size_t ng = dmod_gcd(ac, nac, bc, nbc, g, p);
+            if (p > 7) assert(same(g, ng, c, 3));
+            assert(dmod_gcd(a, N, a, 0, g, p) == N && g[N - 1] == 1);
+        }
+        printf("%lu ok\n", p);
+    }
+
+    // agreement with the integer product for small coefficients
+    long x[] = {3, 0, 2, 1}, y[] = {1, 4, 0, 0, 6}, xy[8];
+    uint64_t ux[] = {3, 0, 2, 1}, uy[] = {1, 4, 0, 0, 6}, uxy[8];
+    dense_mul(x, 4, y, 5, xy);
+    assert(dmod_prod(ux, 4, uy, 5, uxy, 1000003) == 8);
+    for (size_t i = 0; i < 8; i++) assert((uint64_t) xy[i] == uxy[i]);
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <limits.h>
+#include <unistd.h>
+#include "../../polynomial/format.h"
+#include "../../polynomial/parse.h"
+#include "../helpers.h"
+
+int main() {
+    const char* s = "-x^12 + 3x^5 - 2x + 9223372036854775807";
+    sum p = text_sum(s);
+
+    // the text format reads back to the same polynomial
+    size_t len;
+    char* text = format_sum_string(&p, FORMAT_TEXT, &len);
+    printf("text:    %s\n", text);
+    assert(!strcmp(text, s) && len == strlen(s));
+    free(text);
+
+    char* machine = format_sum_string(&p, FORMAT_MACHINE, NULL);
+    printf("machine: %s\n", machine);
+    assert(!strcmp(machine, "4 12 -1 5 3 1 -2 0 9223372036854775807"));
+    free(machine);
+
+    // negative exponents, down to INT_MIN, read back as well
+    int c2[] = {4, -1, 7, 1, -2}, e2[] = {3, 0, -1, -12, INT_MIN};
+    sum laurent = init_polynomial(5, c2, e2);
+    text = format_sum_string(&laurent, FORMAT_TEXT, &len);
+    printf("text:    %s\n", text);
+    assert(!strcmp(text, "4x^3 - 1 + 7x^-1 + x^-12 - 2x^-2147483648"));
+    sum back = text_sum(text);
+    assert(same_sum(&back, &laurent));
+    free_polynomial(&back);
+    free(text);
+    back = text_sum("x^ - 3 - x^-1 + 2x ^-3");
+    assert(back.n == 2 && back.terms[0].exp == -1 && back.terms[1].exp == -3 && back.terms[1].coeff == 3);
+    free_polynomial(&back);
+    free_polynomial(&laurent);
+    sum bad;
+    CHECK(parse_sum("x^-", 3, &bad, NULL) == PARSE_SYNTAX);
+    CHECK(parse_sum("x^-2147483649", 13, &bad, NULL) == PARSE_EXPONENT);
+
+    sum zero = zero_polynomial();
+    text = format_sum_string(&zero, FORMAT_TEXT, NULL);
+    assert(!strcmp(text, "0"));
+    free(text);
+
+    // a caller buffer that is too small keeps what fits
+    char small[8];
+    outbuf ob;
+    outbuf_fixed(&ob, small, sizeof(small));
+    format_sum(&ob, &p, FORMAT_TEXT);
+    assert(ob.truncated && ob.len == sizeof(small) && !memcmp(small, s, sizeof(small)));
+
+    // many terms through a descriptor, more than fit in one chunk
+    fflush(stdout);
+    outbuf_fd(&ob, STDOUT_FILENO);
+    for (int i = 0; i < 1000; i++) {
+        outbuf_long(&ob, -i);
+        outbuf_putc(&ob, i % 20 == 19 ? '\n' : ' ');
+    }
+    CHECK(!outbuf_flush(&ob));
+
+    display(&p);
+    free_polynomial(&p);
+    free_polynomial(&zero);
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "../../polynomial/memo.h"
+#include "../../polynomial/parse.h"
+#include "../helpers.h"
+
+int main() {
+    sum p = text_sum("x^3 - x");
+    sum q = text_sum("x^4 + 2x^3 - x - 2");
+    sum p2 = text_sum("-x + x^3");
+
+    // equal sums hash and intern alike
+    assert(sum_equal(&p, &p2) && sum_hash(&p) == sum_hash(&p2) && sum_hash(&p) != sum_hash(&q));
+    sum_pool* pool = sum_pool_create();
+    CHECK(sum_pool_intern(pool, &p) == sum_pool_intern(pool, &p2));
+    CHECK(sum_pool_intern(pool, &q) != sum_pool_intern(pool, &p) && sum_pool_size(pool) == 2);
+    sum_pool_free(pool);
+
+    memo_cache* c = memo_create(1 << 20);
+    for (int i = 0; i < 3; i++) {
+        sum g = memo_prim_gcd(c, i == 1 ? &p2 : &p, &q);
+        printf("gcd: ");
+        display(&g);
+        free_polynomial(&g);
+    }
+    CHECK(memo_cont(c, &q) == 1 && memo_cont(c, &q) == 1);
+    memo_stats s = memo_get_stats(c);
+    printf("%zu hits, %zu misses, %zu entries, %zu bytes\n", s.hits, s.misses, s.entries, s.bytes);
+    assert(s.hits == 3 && s.misses == 2 && s.entries == 2);
+    memo_free(c);
+
+    // a cap with room for one entry keeps only the most recent
+    c = memo_create(400);
+    sum g = memo_prim_gcd(c, &p, &q);
+    free_polynomial(&g);
+    CHECK(memo_cont(c, &p) == 1);
+    g = memo_prim_gcd(c, &p, &q);
+    free_polynomial(&g);
+    s = memo_get_stats(c);
+    assert(s.hits == 0 && s.evictions >= 1 && s.bytes <= 400);
+    memo_free(c);
+
+    free_polynomial(&p);
+    free_polynomial(&q);
+    free_polynomial(&p2);
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <limits.h>
+#include "../../polynomial/mp_sum.h"
+#include "../../polynomial/parse.h"
+#include "../helpers.h"
+
+int main() {
+    // small products agree with prod
+    sum p = text_sum("3x^5 - 2x + 7");
+    sum q = text_sum("x^2 + 2x - 1");
+    sum r = prod(&p, &q);
+    mp_sum m = mp_sum_prod(&p, &q);
+    sum back;
+    CHECK(mp_sum_to_sum(&m, &back) && back.n == r.n);
+    for (size_t i = 0; i < r.n; i++) {
+        assert(back.terms[i].exp == r.terms[i].exp && back.terms[i].coeff == r.terms[i].coeff);
+    }
+    mp_sum_free(&m);
+    free_polynomial(&back);
+    free_polynomial(&r);
+    free_polynomial(&p);
+    free_polynomial(&q);
+
+    // random sparse products, with like terms and cancellations, agree with prod
+    srand(7);
+    for (int round = 0; round < 100; round++) {
+        p = random_sum((size_t) (rand() % 40), 60);
+        q = random_sum((size_t) (rand() % 40), 60);
+        r = prod(&p, &q);
+        m = mp_sum_prod(&p, &q);
+        CHECK(mp_sum_to_sum(&m, &back));
+        assert(same_sum(&back, &r));
+        mp_sum_free(&m);
+        free_polynomial(&back);
+        free_polynomial(&r);
+        free_polynomial(&p);
+        free_polynomial(&q);
+    }
+
+    // (L x + L)(L x - L) = L^2 x^2 - L^2 for L = LONG_MAX, where the middle terms cancel in 256 bits
+    p = text_sum("9223372036854775807x + 9223372036854775807");
+    q = text_sum("9223372036854775807x - 9223372036854775807");
+    m = mp_sum_prod(&p, &q);
+    CHECK(m.n == 2 && m.exps[0] == 2 && m.exps[1] == 0 && !mp_sum_to_sum(&m, &back));
+    mp_int sq = mpint_init("85070591730234615847396907784232501249");
+    mp_int msq = mpint_init("-85070591730234615847396907784232501249");
+    mpint_display(&m.coeffs[0]);
+    mpint_display(&m.coeffs[1]);
+    assert(mpint_eq(&m.coeffs[0], &sq) && mpint_eq(&m.coeffs[1], &msq));
+    mpint_free(&sq);
+    mpint_free(&msq);
+    mp_sum_free(&m);
+    free_polynomial(&p);
+    free_polynomial(&q);
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../../polynomial/multimod.h"
+#include "../../numeric/modular.h"
+#include "../helpers.h"
+
+/* The product of the two inputs modulo prime. */
+static int prod_kernel(uint64_t prime, const sum* images, size_t nimages, sum* out, void* ctx) {
+    const sum* p = &images[0];
+    const sum* q = &images[1];
+    if (!p->n || !q->n) {
+        *out = zero_polynomial();
+        return MULTIMOD_OK;
+    }
+    int top = p->terms[0].exp + q->terms[0].exp;
+    uint64_t* c = calloc(top + 1, sizeof(uint64_t));
+    for (size_t i = 0; i < p->n; i++) {
+        for (size_t j = 0; j < q->n; j++) {
+            int e = p->terms[i].exp + q->terms[j].exp;
+            c[e] = mod_add(c[e], mod_mul(p->terms[i].coeff, q->terms[j].coeff, prime), prime);
+        }
+    }
+    out->n = 0;
+    out->capacity = 0;
+    out->terms = malloc((top + 1) * sizeof(term));
+    for (int e = top; e >= 0; e--) {
+        if (c[e]) out->terms[out->n++] = (term){.exp = e, .coeff = (long) c[e]};
+    }
+    free(c);
+    return MULTIMOD_OK;
+}
+
+/* The first input divided by the constant in ctx. */
+static int div_kernel(uint64_t prime, const sum* images, size_t nimages, sum* out, void* ctx) {
+    uint64_t inv = mod_inv(mod_reduce(*(long*) ctx, prime), prime);
+    const sum* p = &images[0];
+    out->n = p->n;
+    out->capacity = 0;
+    out->terms = malloc((p->n ? p->n : 1) * sizeof(term));
+    for (size_t i = 0; i < p->n; i++) {
+        out->terms[i] = (term){.exp = p->terms[i].exp, .coeff = (long) mod_mul(p->terms[i].coeff, inv, prime)};
+    }
+    return MULTIMOD_OK;
+}
+
+int main() {
+    tpool* pool = tpool_create(4);
+
+    // (2^40 x - 3)^2 has a coefficient of 2^80, which does not fit in a long
+    term t[] = {{.exp = 1, .coeff = 1L << 40}, {.exp = 0, .coeff = -3}};
+    sum inputs[2] = {{.n = 2, .terms = t}, {.n = 2, .terms = t}};
+    multimod_result r;
+    CHECK(multimod_run(pool, inputs, 2, prod_kernel, NULL, NULL, &r) == 0);
+    printf("(2^40 x - 3)^2 used %zu primes:\n", r.primes_used);
+    for (size_t i = 0; i < r.n; i++) {
+        printf("  x^%d: ", r.exps[i]);
+        mpint_display(&r.num[i]);
+    }
+    mp_int top = mpint_init("1208925819614629174706176");
+    assert(r.n == 3 && mpint_eq(&r.num[0], &top) && mpint_to_long(&r.num[1]) == -(6L << 40));
+    sum s;
+    CHECK(!multimod_result_to_sum(&r, &s));
+    mpint_free(&top);
+    multimod_result_free(&r);
+
+    // the same answer without a pool
+    CHECK(multimod_run(NULL, inputs, 2, prod_kernel, NULL, NULL, &r) == 0 && r.n == 3);
+    multimod_result_free(&r);
+
+    // (5x^2 - 7) / 3 by rational reconstruction
+    term u[] = {{.exp = 2, .coeff = 5}, {.exp = 0, .coeff = -7}};
+    sum p = {.n = 2, .terms = u};
+    long three = 3;
+    multimod_opts opts = {.rational = true};
+    CHECK(multimod_run(pool, &p, 1, div_kernel, &three, &opts, &r) == 0);
+    printf("(5x^2 - 7) / 3 used %zu primes\n", r.primes_used);
+    assert(r.n == 2 && mpint_to_long(&r.num[0]) == 5 && mpint_to_long(&r.den[0]) == 3);
+    assert(mpint_to_long(&r.num[1]) == -7 && mpint_to_long(&r.den[1]) == 3);
+    multimod_result_free(&r);
+
+    tpool_free(pool);
+    return 0;
+}
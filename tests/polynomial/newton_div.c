@@ -0,0 +1,119 @@
+#include "../../polynomial/newton_div.h"
+#include "../../polynomial/heap_div.h"
+#include "../../util/arena.h"
+#include "../helpers.h"
+#include "assert.h"
+#include "pthread.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+/* A dense divisor of n coefficients with a unit leading coefficient. */
+static sum random_divisor(size_t n) {
+    sum q = random_dense_sum(n, 9);
+    q.terms[0].coeff = rand() % 2 ? 1 : -1;
+    return q;
+}
+
+/* Divides q c + r by q with Newton division, with a precomputed inverse, through quo and rem, and by the classical
+ * method (the arena versions of quo and rem never take the other paths), and checks that each gives c and r. */
+static void check(const sum* const q, const sum* const c, const sum* const r, newton_inv* inv, arena* a) {
+    sum qc = prod(q, c);
+    sum p = add(&qc, r);
+    sum nq, nr;
+    newton_divrem(&p, q, &nq, &nr);
+    assert(same_sum(&nq, c) && same_sum(&nr, r));
+    free_polynomial(&nq);
+    free_polynomial(&nr);
+
+    newton_divrem_pre(&p, inv, &nq, NULL);
+    newton_divrem_pre(&p, inv, NULL, &nr);
+    assert(same_sum(&nq, c) && same_sum(&nr, r));
+    free_polynomial(&nq);
+    free_polynomial(&nr);
+
+    sum fq = quo(&p, q);
+    sum fr = rem(&p, q);
+    assert(same_sum(&fq, c) && same_sum(&fr, r));
+    free_polynomial(&fq);
+    free_polynomial(&fr);
+
+    arena_mark m = arena_get_mark(a);
+    sum sq = quo_a(&p, q, a);
+    sum sr = rem_a(&p, q, a);
+    assert(same_sum(&sq, c) && same_sum(&sr, r));
+    arena_release(a, m);
+
+    free_polynomial(&qc);
+    free_polynomial(&p);
+}
+
+static void* divide_in_thread(void* arg) {
+    (void) arg;
+    sum q = random_divisor(NEWTON_MIN_DIVISOR);
+    sum c = random_dense_sum(NEWTON_MIN_QUOTIENT, 9);
+    sum p = prod(&q, &c);
+    sum got = newton_quo(&p, &q);
+    assert(same_sum(&got, &c));
+    free_polynomial(&q);
+    free_polynomial(&c);
+    free_polynomial(&p);
+    free_polynomial(&got);
+    // the inverse cached by this thread is freed as it exits
+    return NULL;
+}
+
+int main() {
+    srand(13);
+    arena* a = arena_create(0);
+    // around the sizes at which quo and rem switch to Newton division, and below them
+    size_t divisors[] = {1, 2, 5, NEWTON_MIN_DIVISOR - 1, NEWTON_MIN_DIVISOR, NEWTON_MIN_DIVISOR + 1, 64};
+    size_t quotients[] = {1, 50, NEWTON_MIN_QUOTIENT - 1, NEWTON_MIN_QUOTIENT, NEWTON_MIN_QUOTIENT + 1, 300};
+    for (size_t i = 0; i < sizeof(divisors) / sizeof(divisors[0]); i++) {
+        sum q = random_divisor(divisors[i]);
+        newton_inv* inv = newton_inv_init(&q);
+        for (size_t j = 0; j < sizeof(quotients) / sizeof(quotients[0]); j++) {
+            for (int exact = 0; exact < 2; exact++) {
+                sum c = random_dense_sum(quotients[j], 9);
+                sum r = exact || divisors[i] == 1 ? zero_polynomial() : random_dense_sum(divisors[i] - 1, 9);
+                check(&q, &c, &r, inv, a);
+                free_polynomial(&c);
+                free_polynomial(&r);
+            }
+        }
+        newton_inv_free(inv);
+        free_polynomial(&q);
+    }
+
+    // a dividend below the degree of the divisor is its own remainder
+    sum q = random_divisor(40);
+    sum p = text_sum("-3x^20 + x^2 - 7");
+    sum nq, nr;
+    newton_divrem(&p, &q, &nq, &nr);
+    assert(nq.n == 0 && same_sum(&nr, &p));
+    free_polynomial(&nq);
+    free_polynomial(&nr);
+    free_polynomial(&p);
+    free_polynomial(&q);
+
+    // a dense dividend by a sparse divisor, which quo leaves to heap division
+    q = text_sum("x^1500 - 3x^700 + 2x^9 + 1");
+    sum c = random_dense_sum(400, 9);
+    sum qc = prod(&q, &c);
+    sum fq = quo(&qc, &q);
+    sum hq = heap_quo(&qc, &q);
+    assert(same_sum(&fq, &c) && same_sum(&hq, &c));
+    free_polynomial(&fq);
+    free_polynomial(&hq);
+    free_polynomial(&qc);
+    free_polynomial(&c);
+    free_polynomial(&q);
+
+    pthread_t t;
+    CHECK(!pthread_create(&t, NULL, divide_in_thread, NULL));
+    CHECK(!pthread_join(t, NULL));
+
+    newton_cache_clear();
+    arena_free(a);
+    printf("newton division agrees with classical division\n");
+    return 0;
+}
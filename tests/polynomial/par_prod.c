@@ -0,0 +1,73 @@
+#include "../../polynomial/par_prod.h"
+#include "../helpers.h"
+#include "assert.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+/* par_prod on every pool against prod, for one pair of operands. */
+static void check(tpool* const* pools, size_t npools, const sum* const p, const sum* const q) {
+    sum want = prod(p, q);
+    for (size_t i = 0; i < npools; i++) {
+        sum got = par_prod(pools[i], p, q);
+        assert(same_sum(&got, &want));
+        free_polynomial(&got);
+    }
+    free_polynomial(&want);
+}
+
+int main() {
+    srand(17);
+    // no pool, a single worker, and several, which must all give the same terms
+    tpool* pools[] = {NULL, tpool_create(1), tpool_create(4)};
+    size_t npools = sizeof(pools) / sizeof(pools[0]);
+
+    for (int round = 0; round < 6; round++) {
+        // dense, above PAR_PROD_MIN_WORK, with sizes on both sides of the Karatsuba cutoff in every slice
+        sum p = random_dense_sum(200 + rand() % 400, 9);
+        sum q = random_dense_sum(round % 2 ? 300 + rand() % 300 : 2 + rand() % 40, 9);
+        if (p.n * q.n < PAR_PROD_MIN_WORK) {
+            sum t = random_dense_sum(PAR_PROD_MIN_WORK / (q.n ? q.n : 1) + 50, 9);
+            free_polynomial(&p);
+            p = t;
+        }
+        check(pools, npools, &p, &q);
+        check(pools, npools, &q, &p);
+        free_polynomial(&p);
+        free_polynomial(&q);
+
+        // sparse, with exponents spread far apart
+        p = random_sum(300 + rand() % 300, 100000);
+        q = random_sum(300 + rand() % 300, 100000);
+        check(pools, npools, &p, &q);
+        free_polynomial(&p);
+        free_polynomial(&q);
+    }
+
+    // a product in which everything cancels, and one too small to be split
+    sum a = random_dense_sum(400, 9);
+    sum b = random_dense_sum(400, 9);
+    sum nb = scalar_prod(-1, &b);
+    sum ab = par_prod(pools[2], &a, &b);
+    sum anb = par_prod(pools[2], &a, &nb);
+    sum zero = add(&ab, &anb);
+    assert(zero.n == 0);
+    sum x = text_sum("x + 1");
+    sum y = text_sum("x - 1");
+    sum xy = par_prod(pools[2], &x, &y);
+    sum expect = text_sum("x^2 - 1");
+    assert(same_sum(&xy, &expect));
+
+    free_polynomial(&a);
+    free_polynomial(&b);
+    free_polynomial(&nb);
+    free_polynomial(&ab);
+    free_polynomial(&anb);
+    free_polynomial(&zero);
+    free_polynomial(&x);
+    free_polynomial(&y);
+    free_polynomial(&xy);
+    free_polynomial(&expect);
+    for (size_t i = 1; i < npools; i++) tpool_free(pools[i]);
+    printf("parallel products agree with prod\n");
+    return 0;
+}
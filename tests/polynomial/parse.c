@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "../../polynomial/parse.h"
+#include "../helpers.h"
+
+static sum parse_ok(const char* s) {
+    sum p;
+    parse_error err;
+    CHECK(parse_sum(s, strlen(s), &p, &err) == PARSE_OK);
+    printf("%-36s -> ", s);
+    display(&p);
+    return p;
+}
+
+int main() {
+    sum p = parse_ok("3x^5 - 2x + 7");
+    assert(p.n == 3 && p.terms[0].exp == 5 && p.terms[1].coeff == -2 && p.terms[2].exp == 0);
+    free_polynomial(&p);
+
+    // out of order, with like terms and explicit products
+    p = parse_ok("  -t^2 + 4 * t^2 + 1 + t^10 - 1 ");
+    assert(p.n == 2 && p.terms[0].exp == 10 && p.terms[1].coeff == 3);
+    free_polynomial(&p);
+
+    p = parse_ok("x - x");
+    assert(p.n == 0 && lc(&p) == 0);
+    free_polynomial(&p);
+
+    p = parse_ok("-9223372036854775808");
+    assert(p.n == 1 && p.terms[0].coeff < 0);
+    free_polynomial(&p);
+
+    parse_error err;
+    const char* bad[] = {"", "3x^", "x + y", "2 3", "x^99999999999", "9223372036854775808x"};
+    parse_status expected[] = {PARSE_SYNTAX, PARSE_SYNTAX, PARSE_VARIABLE, PARSE_SYNTAX, PARSE_EXPONENT, PARSE_OVERFLOW};
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        CHECK(parse_sum(bad[i], strlen(bad[i]), &p, &err) == expected[i]);
+        printf("%-36s -> %s at %zu\n", bad[i], parse_strerror(err.status), err.pos);
+    }
+
+    // coefficients of any size through mp_int
+    const char* big = "123456789012345678901234567890 x^3 + x - 123456789012345678901234567890x^3 + 5x";
+    mp_sum m;
+    CHECK(parse_mp_sum(big, strlen(big), &m, &err) == PARSE_OK);
+    assert(m.n == 1 && m.exps[0] == 1 && mpint_to_long(&m.coeffs[0]) == 6);
+    mp_sum_free(&m);
+
+    // a stream of expressions, one with an error
+    char text[] = "# gcd inputs\nx^2 - 1\n\n x + * 1\nx + 1\n";
+    FILE* in = fmemopen(text, strlen(text), "r");
+    parse_reader* r = parse_reader_open(in);
+    int got, count = 0, errors = 0;
+    while ((got = parse_next(r, &p, &err))) {
+        if (got < 0) {
+            printf("line %zu: %s\n", parse_reader_line(r), parse_strerror(err.status));
+            errors++;
+            continue;
+        }
+        count++;
+        free_polynomial(&p);
+    }
+    assert(count == 2 && errors == 1);
+    parse_reader_free(r);
+    fclose(in);
+    return 0;
+}
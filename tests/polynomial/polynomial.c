@@ -1,7 +1,89 @@
 #include "../../polynomial/sum.h"
+#include "../../polynomial/heap_div.h"
+#include "../helpers.h"
+#include "assert.h"
 #include "stdio.h"
 
+/* The in-place operations against the allocating ones, on random sparse sums. */
+static void check_inplace() {
+    srand(3);
+    // one accumulator that starts empty and grows through many calls, and one scratch buffer for all of sub_mul
+    sum acc = {.n = 0, .capacity = 0, .terms = 0};
+    sum expect = zero_polynomial();
+    sum buf = {.n = 0, .capacity = 0, .terms = 0};
+    for (int round = 0; round < 200; round++) {
+        sum p = random_sum(1 + rand() % 30, 100);
+        CHECK(!add_inplace(&acc, &p));
+        sum e = add(&expect, &p);
+        free_polynomial(&expect);
+        expect = e;
+        assert(same_sum(&acc, &expect));
+
+        // acc - c x^e p against acc + (-c x^e) p
+        term t = {.exp = rand() % 20, .coeff = rand() % 7 - 3};
+        sum m = {.n = 1, .capacity = 0, .terms = &t};
+        sub_mul_inplace(&acc, t.coeff, t.exp, &p, &buf);
+        t.coeff = -t.coeff;
+        sum mp = prod(&m, &p);
+        e = add(&expect, &mp);
+        free_polynomial(&expect);
+        free_polynomial(&mp);
+        expect = e;
+        assert(same_sum(&acc, &expect));
+        assert(acc.capacity >= acc.n);
+        free_polynomial(&p);
+    }
+
+    // aliased operands: p + p and p - 3 x^2 p
+    sum p = text_sum("4x^7 - x^3 + 2");
+    sum twice = text_sum("8x^7 - 2x^3 + 4");
+    CHECK(!add_inplace(&p, &p));
+    assert(same_sum(&p, &twice));
+    sub_mul_inplace(&p, 3, 2, &p, &buf);
+    sum diff = text_sum("-24x^9 + 8x^7 + 6x^5 - 2x^3 - 12x^2 + 4");
+    assert(same_sum(&p, &diff));
+    // and down to zero, which leaves a readable zero polynomial
+    sum q = text_sum("x - 1");
+    sum qq = text_sum("x - 1");
+    sub_mul_inplace(&q, 1, 0, &qq, &buf);
+    assert(q.n == 0 && lc(&q) == 0 && deg(&q) == 0);
+
+    free_polynomial(&q);
+    free_polynomial(&qq);
+    free_polynomial(&p);
+    free_polynomial(&twice);
+    free_polynomial(&diff);
+    free_polynomial(&acc);
+    free_polynomial(&expect);
+    free_polynomial(&buf);
+}
+
+/* prem(p, q) = lc(q)^max(deg p - deg q + 1, 0) p mod q; below the degree of q it is p itself. */
+static void check_prem() {
+    sum p = text_sum("3x^2 + x - 5");
+    sum q = text_sum("2x^3 + 1");
+    sum r = prem(&p, &q);
+    assert(same_sum(&r, &p));
+    free_polynomial(&r);
+
+    // lc(q)^2 p = 4x^4 + 8x^2 + 4 = 2x (2x^3 - x) + 10x^2 + 4
+    sum a = text_sum("x^4 + 2x^2 + 1");
+    sum b = text_sum("2x^3 - x");
+    r = prem(&a, &b);
+    sum expect = text_sum("10x^2 + 4");
+    assert(same_sum(&r, &expect));
+    free_polynomial(&r);
+    free_polynomial(&expect);
+    free_polynomial(&a);
+    free_polynomial(&b);
+    free_polynomial(&p);
+    free_polynomial(&q);
+}
+
 int main(int argc, char* argv[argc]) {
+    check_inplace();
+    check_prem();
+
     int c1[] = {[1] = 1, [0] = 2};
     int e1[] = {[1] = 0, [0] = 2};
 
@@ -16,9 +98,15 @@ int main(int argc, char* argv[argc]) {
 
     sum h = add(&p, &g);
     display(&h);
+    sum expect = text_sum("x^3 + 2x^2 + 2");
+    assert(same_sum(&h, &expect));
+    free_polynomial(&expect);
 
     sum h2 = prod(&p, &g);
     display(&h2);
+    expect = text_sum("2x^5 + x^3 + 2x^2 + 1");
+    assert(same_sum(&h2, &expect));
+    free_polynomial(&expect);
 
     int c3[] = {[0] = 1, [1] = -1};
     int e3[] = {[0] = 4, [1] = 0};
@@ -32,12 +120,77 @@ int main(int argc, char* argv[argc]) {
 
     sum z = quo(&x, &y);
     display(&z);
+    expect = text_sum("x^3 + x^2 + x + 1");
+    assert(same_sum(&z, &expect));
+    free_polynomial(&expect);
 
     sum z2 = prod(&p, &y);
     display(&z2);
 
+    // the gcd is x - 1 up to sign
     sum z3 = prim_gcd(&y, &z2);
     display(&z3);
+    assert(z3.n == 2 && z3.terms[0].exp == 1 && z3.terms[0].coeff == -z3.terms[1].coeff);
+    assert(z3.terms[0].coeff == 1 || z3.terms[0].coeff == -1);
+
+    // sparse division: (x^100 - 1) / (x - 1) = x^99 + ... + 1, and x^100 + 1 leaves a remainder of 2
+    int c5[] = {[0] = 1, [1] = -1};
+    int e5[] = {[0] = 100, [1] = 0};
+    sum s = init_polynomial(2, c5, e5);
+    sum sq;
+    CHECK(heap_divides(&s, &y, &sq));
+    assert(sq.n == 100);
+    for (size_t i = 0; i < sq.n; i++) assert(sq.terms[i].exp == 99 - (int) i && sq.terms[i].coeff == 1);
+    s.terms[1].coeff = 1;
+    CHECK(!heap_divides(&s, &y, NULL));
+    sum sr = heap_rem(&s, &y);
+    display(&sr);
+    assert(sr.n == 1 && sr.terms[0].exp == 0 && sr.terms[0].coeff == 2);
+    // a coefficient that does not divide rules out divisibility too
+    sum two = text_sum("2x - 1");
+    CHECK(!heap_divides(&s, &two, NULL));
+
+    // b c + r divided by b gives back c and r, for random sparse b with a unit leading coefficient and deg r < deg b
+    srand(5);
+    for (int round = 0; round < 100; round++) {
+        sum b = random_sum(2 + rand() % 6, 60);
+        b.terms[0].coeff = rand() % 2 ? 1 : -1;
+        sum c = random_sum(1 + rand() % 30, 500);
+        sum r = round % 2 && deg(&b) ? random_sum(1 + rand() % 8, deg(&b)) : zero_polynomial();
+        sum bc = prod(&b, &c);
+        sum a = add(&bc, &r);
+        sum hq, hr;
+        heap_divrem(&a, &b, &hq, &hr);
+        assert(same_sum(&hq, &c) && same_sum(&hr, &r));
+        sum pq;
+        if (!r.n) {
+            CHECK(heap_divides(&a, &b, &pq));
+            assert(same_sum(&pq, &c));
+            free_polynomial(&pq);
+        } else {
+            CHECK(!heap_divides(&a, &b, NULL));
+        }
+        free_polynomial(&hq);
+        free_polynomial(&hr);
+        free_polynomial(&a);
+        free_polynomial(&bc);
+        free_polynomial(&b);
+        free_polynomial(&c);
+        free_polynomial(&r);
+    }
 
+    free_polynomial(&p);
+    free_polynomial(&g);
+    free_polynomial(&h);
+    free_polynomial(&h2);
+    free_polynomial(&x);
+    free_polynomial(&y);
+    free_polynomial(&z);
+    free_polynomial(&z2);
+    free_polynomial(&z3);
+    free_polynomial(&s);
+    free_polynomial(&sq);
+    free_polynomial(&sr);
+    free_polynomial(&two);
     return 0;
-}
\ No newline at end of file
+}
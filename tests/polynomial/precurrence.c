@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../../polynomial/precurrence.h"
+#include "../../polynomial/parse.h"
+#include "../../numeric/modular.h"
+#include "../helpers.h"
+
+/* Evaluates the recurrence with coefficients cs at N, exactly and modulo two primes, and checks the result. */
+static void check(const char* const* cs, size_t order, long n0, const long* init, long N, const char* expect) {
+    sum c[order + 1];
+    for (size_t i = 0; i <= order; i++) c[i] = text_sum(cs[i]);
+    mp_rat start[order];
+    uint64_t mstart[order];
+    for (size_t i = 0; i < order; i++) start[i] = mprat_from_long(init[i], 1);
+
+    mp_rat u;
+    CHECK(!prec_eval(c, order, n0, start, N, &u));
+    char* s = mprat_to_string(&u, NULL);
+    printf("u(%ld) = %s\n", N, s);
+    assert(!strcmp(s, expect));
+    free(s);
+
+    uint64_t primes[] = {mod_prime(0), 1000003};
+    for (size_t k = 0; k < 2; k++) {
+        uint64_t p = primes[k];
+        for (size_t i = 0; i < order; i++) mstart[i] = mod_reduce(init[i], p);
+        uint64_t got;
+        CHECK(!prec_eval_mod(c, order, n0, mstart, N, p, &got));
+        // num / den mod p
+        mp_int mp = mpint_from_long((long) p);
+        mp_int rn = mpint_mod(&u.num, &mp);
+        mp_int rd = mpint_mod(&u.den, &mp);
+        uint64_t want = mod_mul(mod_reduce(mpint_to_long(&rn), p), mod_inv(mod_reduce(mpint_to_long(&rd), p), p), p);
+        assert(got == want);
+        mpint_free(&mp);
+        mpint_free(&rn);
+        mpint_free(&rd);
+    }
+    mprat_free(&u);
+    for (size_t i = 0; i < order; i++) mprat_free(&start[i]);
+    for (size_t i = 0; i <= order; i++) free_polynomial(&c[i]);
+}
+
+int main() {
+    // Fibonacci: u(n) + u(n + 1) - u(n + 2) = 0
+    const char* fib[] = {"1", "1", "-1"};
+    check(fib, 2, 0, (long[]){0, 1}, 100, "354224848179261915075");
+    check(fib, 2, 0, (long[]){0, 1}, 1, "1");
+    // factorials: (n + 1) u(n) - u(n + 1) = 0
+    const char* fact[] = {"n + 1", "-1"};
+    check(fact, 1, 0, (long[]){1}, 25, "15511210043330985984000000");
+    // a rational sequence: n u(n) - (n + 1) u(n + 1) = 0 gives u(n) = 1 / n from u(1) = 1
+    const char* inv[] = {"n", "-n - 1"};
+    check(inv, 1, 1, (long[]){1}, 1000, "1/1000");
+    // Apery numbers for zeta(3)
+    const char* apery[] = {"n^3 + 3n^2 + 3n + 1", "-34n^3 - 153n^2 - 231n - 117", "n^3 + 6n^2 + 12n + 8"};
+    check(apery, 2, 0, (long[]){1, 5}, 10, "13657436403073");
+
+    // the leading coefficient n - 5 vanishes at n = 5
+    sum c[] = {text_sum("1"), text_sum("n - 5")};
+    mp_rat one = mprat_from_long(1, 1), u;
+    uint64_t r;
+    CHECK(prec_eval(c, 1, 0, &one, 10, &u) == -1 && prec_eval_mod(c, 1, 0, (uint64_t[]){1}, 10, 1000003, &r) == -1);
+    CHECK(!prec_eval(c, 1, 6, &one, 10, &u));
+    mprat_free(&u);
+    mprat_free(&one);
+    free_polynomial(&c[0]);
+    free_polynomial(&c[1]);
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "../../polynomial/sum.h"
+#include "../../polynomial/parse.h"
+#include "../../polynomial/prod_iter.h"
+#include "../../polynomial/heap_div.h"
+#include "assert.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "../helpers.h"
+
+/* The first n terms of a and b agree. */
+static int same_terms(const sum* const a, const sum* const b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (a->terms[i].exp != b->terms[i].exp || a->terms[i].coeff != b->terms[i].coeff) return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char* argv[argc]) {
+    // (x^2 + x + 1)(x - 1) = x^3 - 1: the middle terms cancel and are skipped
+    sum a = text_sum("x^2 + x + 1");
+    sum b = text_sum("x - 1");
+    prod_iter it;
+    prod_iter_init(&it, &a, &b);
+    term t;
+    CHECK(prod_iter_next(&it, &t) && t.exp == 3 && t.coeff == 1);
+    CHECK(prod_iter_next(&it, &t) && t.exp == 0 && t.coeff == -1);
+    CHECK(!prod_iter_next(&it, &t));
+    prod_iter_free(&it);
+
+    srand(7);
+    for (int round = 0; round < 50; round++) {
+        sum p = random_sum(1 + rand() % 40, 200);
+        sum q = random_sum(1 + rand() % 40, 200);
+        sum r = random_sum(1 + rand() % 40, 400);
+        sum pq = prod(&p, &q);
+
+        // every term, in order, and the leading ones alone
+        sum all = prod_leading(&p, &q, (size_t) -1);
+        assert(same_sum(&all, &pq));
+        sum lead = prod_leading(&p, &q, 3);
+        assert(lead.n == (pq.n < 3 ? pq.n : 3) && same_terms(&lead, &pq, lead.n));
+
+        sum s1 = add_prod(&r, &p, &q);
+        sum s2 = add(&r, &pq);
+        assert(same_sum(&s1, &s2));
+
+        // dividing the product as a stream gives what dividing the stored product gives
+        if (q.n > 1) {
+            sum q1, r1, q2, r2;
+            heap_divrem(&pq, &q, &q1, &r1);
+            heap_divrem_prod(&p, &q, &q, &q2, &r2);
+            assert(same_sum(&q1, &q2) && same_sum(&r1, &r2));
+            sum exact;
+            CHECK(heap_divides_prod(&p, &q, &q, &exact) && same_sum(&exact, &p));
+            CHECK(heap_divides_prod(&p, &q, &p, NULL));
+            free_polynomial(&q1);
+            free_polynomial(&r1);
+            free_polynomial(&q2);
+            free_polynomial(&r2);
+            free_polynomial(&exact);
+        }
+        free_polynomial(&p);
+        free_polynomial(&q);
+        free_polynomial(&r);
+        free_polynomial(&pq);
+        free_polynomial(&all);
+        free_polynomial(&lead);
+        free_polynomial(&s1);
+        free_polynomial(&s2);
+    }
+
+    // (x^1000 + 1)(x^1000 - 1) is not divisible by 2x^3 + 1, which the first term shows
+    sum u = text_sum("x^1000 + 1");
+    sum v = text_sum("x^1000 - 1");
+    sum w = text_sum("2x^3 + 1");
+    CHECK(!heap_divides_prod(&u, &v, &w, NULL));
+    sum top = prod_leading(&u, &v, 1);
+    display(&top);
+    assert(top.n == 1 && top.terms[0].exp == 2000);
+    printf("lazy products agree with prod\n");
+    free_polynomial(&top);
+    free_polynomial(&u);
+    free_polynomial(&v);
+    free_polynomial(&w);
+    free_polynomial(&a);
+    free_polynomial(&b);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "../../polynomial/wz.h"
+#include "../../polynomial/parse.h"
+#include "../helpers.h"
+
+#define MAX_COEFFS 2
+
+/* A polynomial in n and k from the coefficients of n^0, n^1, ... as polynomials in k. */
+static bipoly make(sum* store, const char* const* ps, size_t n) {
+    for (size_t i = 0; i < n; i++) store[i] = text_sum(ps[i]);
+    return (bipoly){.n = n, .p = store};
+}
+
+static void free_bipoly(bipoly* p) {
+    for (size_t i = 0; i < p->n; i++) free_polynomial((sum*) &p->p[i]);
+}
+
+int main() {
+    sum s[8][MAX_COEFFS];
+    // sum_k binomial(n, k) / 2^n = 1: F(n + 1, k) / F(n, k) = (n + 1) / (2n + 2 - 2k),
+    // F(n, k + 1) / F(n, k) = (n - k) / (k + 1), certificate R = -k / (2n + 2 - 2k)
+    hyper_term F = {
+        .num_n = make(s[0], (const char*[]){"1", "1"}, 2),
+        .den_n = make(s[1], (const char*[]){"-2k + 2", "2"}, 2),
+        .num_k = make(s[2], (const char*[]){"-k", "1"}, 2),
+        .den_k = make(s[3], (const char*[]){"k + 1"}, 1)
+    };
+    bipoly rn = make(s[4], (const char*[]){"-k"}, 1);
+    bipoly rd = make(s[5], (const char*[]){"-2k + 2", "2"}, 2);
+    bipoly wrong = make(s[6], (const char*[]){"k"}, 1);
+
+    assert(wz_verify_pair(&F, &rn, &rd, NULL));
+    assert(!wz_verify_pair(&F, &wrong, &rd, NULL));
+    wz_opts exact = {.exact = true};
+    assert(wz_verify_pair(&F, &rn, &rd, &exact));
+    assert(!wz_verify_pair(&F, &wrong, &rd, &exact));
+    wz_opts loose = {.max_error = 1e-3, .seed = 7};
+    assert(wz_verify_pair(&F, &rn, &rd, &loose) && !wz_verify_pair(&F, &wrong, &rd, &loose));
+
+    // binomial(n, k) itself satisfies 2 F(n, k) - F(n + 1, k) = G(n, k + 1) - G(n, k) with G = k / (n + 1 - k) F
+    hyper_term B = F;
+    B.den_n = make(s[7], (const char*[]){"-k + 1", "1"}, 2);
+    sum c[2];
+    c[0] = text_sum("2");
+    c[1] = text_sum("-1");
+    bipoly gn = wrong;
+    assert(wz_verify_recurrence(&B, c, 1, &gn, &B.den_n, NULL));
+    assert(wz_verify_recurrence(&B, c, 1, &gn, &B.den_n, &exact));
+    // the recurrence with the wrong coefficients fails
+    assert(!wz_verify_recurrence(&F, c, 1, &gn, &B.den_n, NULL));
+    // as does one with a negative exponent, which cannot be evaluated over the integers
+    sum laurent[] = {text_sum("2 + n^-1"), c[1]};
+    assert(!wz_verify_recurrence(&B, laurent, 1, &gn, &B.den_n, &exact));
+    free_polynomial(&laurent[0]);
+    printf("ok\n");
+
+    free_polynomial(&c[0]);
+    free_polynomial(&c[1]);
+    bipoly all[] = {F.num_n, F.den_n, F.num_k, F.den_k, rn, rd, wrong, B.den_n};
+    for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++) free_bipoly(&all[i]);
+    return 0;
+}
@@ -0,0 +1,37 @@
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include "../../util/arena.h"
+#include "../helpers.h"
+
+int main() {
+    arena* a = arena_create(1024);
+
+    // allocations are aligned and do not overlap
+    char* x = arena_alloc(a, 3);
+    long* y = arena_alloc(a, 10 * sizeof(long));
+    assert((size_t) y % _Alignof(long) == 0);
+    memset(x, 1, 3);
+    for (int i = 0; i < 10; i++) y[i] = i;
+    assert(x[2] == 1);
+
+    // the most recent allocation grows in place
+    long* z = arena_realloc(a, y, 10 * sizeof(long), 20 * sizeof(long));
+    assert(z == y && z[9] == 9);
+
+    // releasing to a mark makes the same memory available again
+    arena_mark m = arena_get_mark(a);
+    for (int step = 0; step < 100; step++) {
+        char* big = arena_alloc(a, 4000);
+        memset(big, step, 4000);
+        arena_release(a, m);
+    }
+    printf("Arena holds %zu bytes after 100 released steps\n", arena_capacity(a));
+    assert(arena_capacity(a) < 8192);
+
+    arena_reset(a);
+    CHECK(arena_alloc(a, 3) == x);
+
+    arena_free(a);
+    return 0;
+}
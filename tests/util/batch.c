@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <assert.h>
+#include "../../util/batch.h"
+#include "../../polynomial/job.h"
+#include "../helpers.h"
+
+/* A job whose spec is a number n: it allocates n blocks of 1 KB from the arena and prints n, or fails when n is
+ * negative. */
+static batch_status prepare(const char* spec, size_t len, void** state, outbuf* out) {
+    (void) len;
+    long n = strtol(spec, NULL, 10);
+    if (n < 0) {
+        outbuf_puts(out, "negative");
+        return BATCH_ERROR;
+    }
+    long* s = malloc(sizeof(long));
+    *s = n;
+    *state = s;
+    return BATCH_OK;
+}
+
+static batch_status run(void* state, arena* a, outbuf* out) {
+    long n = *(long*) state;
+    for (long i = 0; i < n; i++) memset(arena_alloc(a, 1024), 0, 1024);
+    outbuf_long(out, n);
+    return BATCH_OK;
+}
+
+static const batch_job count_job = {
+    .prepare = prepare,
+    .run = run,
+    .cleanup = free
+};
+
+/* A job that does not allocate: "spin" loops until it is stopped, calling arena_check at every step, "fault"
+ * raises SIGFPE as a division by zero would, and anything else prints "done". The fault is raised rather than
+ * caused, since the undefined behaviour sanitizer reports a division by zero instead of letting it trap. */
+static batch_status prepare_word(const char* spec, size_t len, void** state, outbuf* out) {
+    (void) out;
+    *state = strndup(spec, len);
+    return BATCH_OK;
+}
+
+static batch_status run_word(void* state, arena* a, outbuf* out) {
+    if (!strcmp(state, "spin")) {
+        for (;;) arena_check(a);
+    }
+    if (!strcmp(state, "fault")) {
+        raise(SIGFPE);
+    }
+    outbuf_puts(out, "done");
+    return BATCH_OK;
+}
+
+static const batch_job word_job = {
+    .prepare = prepare_word,
+    .run = run_word,
+    .cleanup = free
+};
+
+static char* run_batch(const char* input, const batch_job* job, const batch_opts* opts, batch_stats* st) {
+    FILE* in = fmemopen((void*) input, strlen(input), "r");
+    char* text = NULL;
+    size_t len = 0;
+    FILE* out = open_memstream(&text, &len);
+    CHECK(!batch_run(in, out, job, opts, st));
+    fclose(in);
+    fclose(out);
+    return text;
+}
+
+/* The status and result columns of the results, without the timings. */
+static void strip_timings(char* text) {
+    char* w = text;
+    for (char* line = text; *line;) {
+        char* end = strchr(line, '\n');
+        char* tab = strchr(strchr(line, '\t') + 1, '\t');
+        char* time = strchr(tab + 1, '\t');
+        size_t head = (size_t) (tab - line);
+        memmove(w, line, head);
+        w += head;
+        size_t tail = (size_t) (end + 1 - time);
+        memmove(w, time, tail);
+        w += tail;
+        line = end + 1;
+    }
+    *w = '\0';
+}
+
+int main() {
+    // many jobs on few threads and a small window still come out in input order
+    size_t njobs = 5000;
+    char* input = malloc(njobs * 8);
+    char* expected = malloc(njobs * 24);
+    size_t ni = 0, ne = 0;
+    for (size_t i = 0; i < njobs; i++) {
+        ni += (size_t) sprintf(input + ni, "%zu\n", i % 10);
+        ne += (size_t) sprintf(expected + ne, "%zu\tok\t%zu\n", i + 1, i % 10);
+    }
+    batch_opts o = {.threads = 4, .window = 64};
+    batch_stats st;
+    char* text = run_batch(input, &count_job, &o, &st);
+    strip_timings(text);
+    assert(!strcmp(text, expected));
+    assert(st.jobs == njobs && st.status[BATCH_OK] == njobs);
+    printf("%zu jobs ran in input order in %.1f ms\n", st.jobs, st.wall_ms);
+    free(text);
+    free(input);
+    free(expected);
+
+    // blank lines and comments are skipped but still counted in the line numbers
+    o = (batch_opts) {.threads = 2, .memory_limit = 64 * 1024};
+    text = run_batch("1\n\n# comment\n-3\n1000\n2\n", &count_job, &o, &st);
+    strip_timings(text);
+    printf("%s", text);
+    assert(!strcmp(text, "1\tok\t1\n4\terror\tnegative\n5\tmemory\tmemory limit exceeded\n6\tok\t2\n"));
+    assert(st.status[BATCH_OK] == 2 && st.status[BATCH_ERROR] == 1 && st.status[BATCH_MEMORY] == 1);
+    free(text);
+
+    // a job that runs too long is stopped at one of its allocations
+    o = (batch_opts) {.threads = 1, .time_limit_ms = 20};
+    text = run_batch("100000000\n3\n", &count_job, &o, &st);
+    strip_timings(text);
+    printf("%s", text);
+    assert(!strcmp(text, "1\ttimeout\ttime limit exceeded\n2\tok\t3\n"));
+    free(text);
+
+    // as is one that only calls arena_check, and a fault ends the job that raised it but not the others, on
+    // every thread and in every window
+    o = (batch_opts) {.threads = 2, .window = 2, .time_limit_ms = 20};
+    text = run_batch("spin\nfault\nx\nfault\nfault\ny\n", &word_job, &o, &st);
+    strip_timings(text);
+    printf("%s", text);
+    assert(!strcmp(text, "1\ttimeout\ttime limit exceeded\n2\terror\tarithmetic fault, such as a coefficient overflow\n"
+                         "3\tok\tdone\n4\terror\tarithmetic fault, such as a coefficient overflow\n"
+                         "5\terror\tarithmetic fault, such as a coefficient overflow\n6\tok\tdone\n"));
+    assert(st.status[BATCH_ERROR] == 3 && st.status[BATCH_TIMEOUT] == 1);
+    free(text);
+
+    // the polynomial jobs
+    o = (batch_opts) {.threads = 3};
+    text = run_batch("prod x + 1 ; x - 1\nquo x^3 - 1 ; x - 1\nrem x^2 ; 0\nhsum 1 ; k + 1 ; 0 ; 5\nfoo 1\n"
+                     "add 2x ; x ; 1\nquo 1 ; x\nhsum 1 ; 1 ; 9223372036854775807 ; 5\n"
+                     "hsum 1 ; 1 ; 0 ; 100000000000\nhsum 1 ; k^10 + 1 ; 0 ; 100000\n", &sum_job, &o, &st);
+    strip_timings(text);
+    printf("%s", text);
+    assert(!strcmp(text, "1\tok\tx^2 - 1\n2\tok\tx^2 + x + 1\n3\terror\tdivision by zero\n4\tok\t65/24\n"
+                         "5\terror\tunknown operation\n6\terror\twrong number of operands\n7\tok\t0\n"
+                         "8\terror\tbad range\n9\terror\tsum too large\n10\terror\tsum too large\n"));
+    free(text);
+    return 0;
+}
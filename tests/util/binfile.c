@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <assert.h>
+#include "../../util/binfile.h"
+#include "../helpers.h"
+
+int main() {
+    char path[] = "/tmp/binfile_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+
+    int c1[] = {3, -2, 7}, e1[] = {5, 1, 0};
+    sum p = init_polynomial(3, c1, e1);
+    sum zero = zero_polynomial();
+    mp_int m = mpint_init("-123456789012345678901234567890123456789");
+
+    binfile_writer* w = binfile_writer_open(path);
+    assert(w);
+    CHECK(!binfile_write_sum(w, &p));
+    CHECK(!binfile_write_sum(w, &zero));
+    CHECK(!binfile_write_mpint(w, &m));
+    // p again, streamed one term at a time
+    CHECK(!binfile_begin_sum(w));
+    for (size_t i = 0; i < p.n; i++) CHECK(!binfile_write_terms(w, &p.terms[i], 1));
+    CHECK(!binfile_end_sum(w));
+    CHECK(!binfile_writer_close(w));
+
+    binfile* f = binfile_open(path);
+    assert(f && binfile_count(f) == 4);
+    assert(binfile_kind_at(f, 0) == BINFILE_SUM && binfile_kind_at(f, 2) == BINFILE_MPINT);
+
+    // the views are used directly as operands
+    sum v, vz, vs;
+    CHECK(!binfile_sum(f, 0, &v) && !binfile_sum(f, 1, &vz) && !binfile_sum(f, 3, &vs));
+    assert(((size_t) v.terms % BINFILE_ALIGN) == 0);
+    assert(v.n == 3 && !memcmp(v.terms, p.terms, sizeof(term) * 3) && vs.n == 3);
+    assert(vz.n == 0 && lc(&vz) == 0);
+    sum sq = prod(&v, &vs);
+    printf("p^2 from the mapped file: ");
+    display(&sq);
+    free_polynomial(&sq);
+
+    mp_int vm;
+    CHECK(!binfile_mpint(f, 2, &vm));
+    assert(mpint_eq(&vm, &m));
+    mp_int twice = mpint_add(&vm, &vm);
+    printf("2m from the mapped file: ");
+    mpint_display(&twice);
+    mpint_free(&twice);
+    mpint_free(&vm);
+    CHECK(binfile_mpint(f, 0, &vm) == -1);
+    binfile_close(f);
+
+    // a truncated file is rejected, including one cut inside the padding after a record, and a file that opens
+    // still holds all of its records
+    struct stat st;
+    CHECK(!stat(path, &st));
+    for (off_t len = st.st_size; len-- > 0;) {
+        CHECK(!truncate(path, len));
+        errno = 0;
+        f = binfile_open(path);
+        if (!f) {
+            CHECK(errno == EINVAL);
+            continue;
+        }
+        assert(binfile_count(f) == 4);
+        CHECK(!binfile_sum(f, 3, &vs));
+        assert(same_sum(&vs, &p));
+        binfile_close(f);
+    }
+
+    // a payload of 247 terms ends 16 bytes short of a page, so the next record header would be read past the mapping
+    sum long_p = {.n = 247, .capacity = 0, .terms = malloc(247 * sizeof(term))};
+    CHECK(long_p.terms);
+    for (size_t i = 0; i < long_p.n; i++) long_p.terms[i] = (term) {.exp = (int) (long_p.n - i), .coeff = 1};
+    w = binfile_writer_open(path);
+    assert(w);
+    CHECK(!binfile_write_sum(w, &long_p) && !binfile_write_sum(w, &zero) && !binfile_writer_close(w));
+    CHECK(!truncate(path, 2 * BINFILE_ALIGN + 247 * sizeof(term)));
+    errno = 0;
+    CHECK(!binfile_open(path) && errno == EINVAL);
+    free_polynomial(&long_p);
+
+    unlink(path);
+    free_polynomial(&p);
+    free_polynomial(&zero);
+    mpint_free(&m);
+    return 0;
+}
@@ -1,7 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <assert.h>
 #include "../../util/heap.h"
-#include "../../polynomial/polynomial.h"
+#include "../../polynomial/sum.h"
 
 int main() {
     term* terms = calloc(10, sizeof(term));
@@ -11,35 +12,37 @@ int main() {
         terms[i].exp = i;
     }
 
-    heap* h = build_min_heap(10, terms);
-    term t = find_min(h);
-    printf("The minimum term has exponent %d \n", t.exp);
+    heap* h = build_max_heap(10, terms);
+    term t = find_max(h);
+    printf("The maximum term has exponent %d \n", t.exp);
 
     for (int i = 0; i < 10; i++) {
-        t = extract_min(h);
+        t = extract_max(h);
         printf("Extracted term with exponent %d \n", t.exp);    
+        assert(t.exp == 9 - i);
     }
+    assert(is_empty(h));
 
     heap_insert(h, t);
     term t2 = {.coeff = 1, .exp = 5};
     heap_insert(h, t2);
     printf("Inserting monomial %ld x^%d into heap\n", t2.coeff, t2.exp);
     
-    t = find_min(h);
-    printf("Extracted term with exponent %d \n", t.exp);    
+    t = find_max(h);
+    printf("The maximum term has exponent %d \n", t.exp);    
 
     heap_remove(h, 0);
     heap_remove(h, 0);
+    assert(is_empty(h));
 
+    // grows the heap past its original size
     for (size_t i = 6; i < 100; i++) {
         heap_insert(h, (term){.coeff = 1, .exp = i});
-        if (i % 10 == 0) {
-            printf("heap size is %ld, heap max is %ld\n", h->heap_size, h->heap_max);
-        }
     }
-    decrease_key(h, 94, 2);
-    t = extract_min(h);
+    increase_key(h, 93, 200);
+    t = extract_max(h);
     printf("Extracted term with exponent %d \n", t.exp);
+    assert(t.exp == 200);
 
     free_heap(h);
 
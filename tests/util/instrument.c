@@ -0,0 +1,37 @@
+#include <stdio.h>
+#include <assert.h>
+#include "../../polynomial/sum.h"
+#include "../../util/instrument.h"
+
+static size_t steps;
+
+static void count_step(size_t step, int deg, int bits, void* ctx) {
+    printf("prim_gcd step %zu: degree %d, coefficients of up to %d bits\n", step, deg, bits);
+    steps++;
+}
+
+int main() {
+    instr_set_gcd_callback(count_step, NULL);
+
+    // gcd(x^3 - x, (x + 2)(x^3 - 1)) = x - 1
+    int c1[] = {1, -1}, e1[] = {3, 1};
+    int c2[] = {1, 2, -1, -2}, e2[] = {4, 3, 1, 0};
+    sum p = init_polynomial(2, c1, e1);
+    sum q = init_polynomial(4, c2, e2);
+    sum g = prim_gcd(&p, &q);
+    display(&g);
+    free_polynomial(&g);
+    free_polynomial(&p);
+    free_polynomial(&q);
+
+    instr_report(stdout);
+#ifdef HYPERGEOM_INSTRUMENT
+    instr_stats s;
+    instr_snapshot(&s);
+    assert(s.calls[INSTR_PRIM_GCD] == 1 && steps == 3 && s.gcd_step_calls[0] == 1);
+    assert(s.alloc_calls > 0 && s.live_bytes == 0 && s.peak_live_bytes > 0);
+#else
+    assert(steps == 0);
+#endif
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../../util/term_sort.h"
+
+static int is_sorted(size_t n, const term* const arr) {
+    for (size_t i = 1; i < n; i++) {
+        if (arr[i - 1].exp < arr[i].exp) return 0;
+    }
+    return 1;
+}
+
+int main() {
+    // dense exponents take the counting sort path
+    size_t n = 1000;
+    term* terms = calloc(n, sizeof(term));
+    srand(1);
+    for (size_t i = 0; i < n; i++) {
+        terms[i].coeff = (long) i;
+        terms[i].exp = rand() % 500;
+    }
+    sort_terms(n, terms);
+    assert(is_sorted(n, terms));
+    printf("Sorted %zu dense terms, leading exponent %d\n", n, terms[0].exp);
+
+    // sparse exponents (including negative ones) take the radix path
+    for (size_t i = 0; i < n; i++) {
+        terms[i].coeff = (long) i;
+        terms[i].exp = rand() - RAND_MAX / 2;
+    }
+    sort_terms(n, terms);
+    assert(is_sorted(n, terms));
+    printf("Sorted %zu sparse terms, leading exponent %d\n", n, terms[0].exp);
+
+    // stability: equal exponents keep their original order
+    for (size_t i = 0; i < n; i++) {
+        terms[i].coeff = (long) i;
+        terms[i].exp = (int) (i % 3) * 1000000;
+    }
+    sort_terms_with(n, terms, TERM_SORT_RADIX);
+    for (size_t i = 1; i < n; i++) {
+        assert(terms[i - 1].exp != terms[i].exp || terms[i - 1].coeff < terms[i].coeff);
+    }
+
+    // (x + 1)(x - 1) written out term by term; the x terms cancel
+    term t[4] = {{.exp = 1, .coeff = -1}, {.exp = 2, .coeff = 1}, {.exp = 0, .coeff = -1}, {.exp = 1, .coeff = 1}};
+    size_t k = sort_collect_terms(4, t);
+    assert(k == 2);
+    printf("Collected %zu terms: %ldx^%d + %ldx^%d\n", k, t[0].coeff, t[0].exp, t[1].coeff, t[1].exp);
+
+    free(terms);
+    return 0;
+}
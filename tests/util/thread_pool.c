@@ -0,0 +1,28 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include "../../util/thread_pool.h"
+
+static atomic_long total;
+
+static void add_task(void* arg) {
+    atomic_fetch_add(&total, (long) (size_t) arg);
+}
+
+int main() {
+    tpool* pool = tpool_create(4);
+
+    // the pool is reused across several rounds of work
+    for (int round = 1; round <= 3; round++) {
+        atomic_store(&total, 0);
+        for (size_t i = 1; i <= 1000; i++) {
+            tpool_submit(pool, add_task, (void*) i);
+        }
+        tpool_wait(pool);
+        printf("Round %d: the tasks added up to %ld\n", round, atomic_load(&total));
+        assert(atomic_load(&total) == 500500);
+    }
+
+    tpool_free(pool);
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "./arena.h"
+#include "./instrument.h"
+
+#define ARENA_DEFAULT_BLOCK (1 << 16)
+#define ARENA_ALIGN (_Alignof(max_align_t))
+
+struct arena_block {
+    arena_block* next;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+};
+
+struct arena {
+    arena_block* first;
+    arena_block* curr;
+    size_t block_size;
+    /* the most recent allocation, which arena_realloc may resize in place */
+    void* last;
+    arena_guard_fn guard;
+    void* guard_ctx;
+};
+
+static size_t align_up(size_t n) {
+    return (n + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+static arena_block* new_block(size_t size) {
+    arena_block* b = malloc(sizeof(arena_block) + size);
+    if (!b) {
+        perror("Could not allocate memory in arena");
+        exit(EXIT_FAILURE);
+    }
+    b->next = 0;
+    b->size = size;
+    b->used = 0;
+    return b;
+}
+
+arena* arena_create(size_t block_size) {
+    arena* a = malloc(sizeof(arena));
+    if (!a) {
+        perror("Could not allocate memory in arena_create");
+        exit(EXIT_FAILURE);
+    }
+    a->block_size = block_size ? align_up(block_size) : ARENA_DEFAULT_BLOCK;
+    a->first = new_block(a->block_size);
+    a->curr = a->first;
+    a->last = 0;
+    a->guard = 0;
+    a->guard_ctx = 0;
+    return a;
+}
+
+void* arena_alloc(arena* a, size_t size) {
+    if (a->guard) {
+        a->guard(a, size, a->guard_ctx);
+    }
+    size = align_up(size ? size : 1);
+    arena_block* b = a->curr;
+    if (b->size - b->used < size) {
+        // Move on to the next block, reusing the ones left over from a release when they are big enough.
+        // A block that is too small is skipped over by splicing a new one in front of it.
+        if (b->next && b->next->size >= size) {
+            b = b->next;
+        } else {
+            arena_block* n = new_block(size > a->block_size ? size : a->block_size);
+            n->next = b->next;
+            b->next = n;
+            b = n;
+        }
+        b->used = 0;
+        a->curr = b;
+    }
+    void* out = (char*) b->data + b->used;
+    b->used += size;
+    a->last = out;
+    return out;
+}
+
+void* arena_realloc(arena* a, void* ptr, size_t old_size, size_t new_size) {
+    if (!ptr) {
+        return arena_alloc(a, new_size);
+    }
+    if (ptr == a->last) {
+        arena_block* b = a->curr;
+        size_t start = (size_t) ((char*) ptr - (char*) b->data);
+        size_t size = align_up(new_size ? new_size : 1);
+        if (start + size <= b->size) {
+            if (a->guard && new_size > old_size) {
+                a->guard(a, new_size - old_size, a->guard_ctx);
+            }
+            b->used = start + size;
+            return ptr;
+        }
+    }
+    if (new_size <= old_size) {
+        return ptr;
+    }
+    void* out = arena_alloc(a, new_size);
+    memcpy(out, ptr, old_size);
+    return out;
+}
+
+void arena_set_guard(arena* a, arena_guard_fn fn, void* ctx) {
+    a->guard = fn;
+    a->guard_ctx = ctx;
+}
+
+void arena_check(arena* a) {
+    if (a->guard) {
+        a->guard(a, 0, a->guard_ctx);
+    }
+}
+
+arena_mark arena_get_mark(const arena* const a) {
+    arena_mark m = {
+        .block = a->curr,
+        .used = a->curr->used
+    };
+    return m;
+}
+
+void arena_release(arena* a, arena_mark m) {
+    a->curr = m.block;
+    a->curr->used = m.used;
+    a->last = 0;
+}
+
+void arena_reset(arena* a) {
+    a->curr = a->first;
+    a->curr->used = 0;
+    a->last = 0;
+}
+
+size_t arena_capacity(const arena* const a) {
+    size_t total = 0;
+    for (arena_block* b = a->first; b; b = b->next) {
+        total += b->size;
+    }
+    return total;
+}
+
+void arena_free(arena* a) {
+    if (!a) {
+        return;
+    }
+    arena_block* b = a->first;
+    while (b) {
+        arena_block* next = b->next;
+        free(b);
+        b = next;
+    }
+    free(a);
+}
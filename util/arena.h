@@ -0,0 +1,55 @@
+/** A region (bump) allocator for short-lived temporaries. Allocations are carved out of large blocks and are never
+ * freed individually; instead the arena is rolled back to a mark, which releases everything allocated since in
+ * O(1). Blocks are kept and reused after a release, so a loop that marks and releases once per step stops
+ * calling malloc after its first few steps. An arena must not be used from several threads at once. */
+#ifndef _ARENA_H_INCLUDED_
+#define _ARENA_H_INCLUDED_
+
+#include <stddef.h>
+
+typedef struct arena arena;
+typedef struct arena_block arena_block;
+typedef struct arena_mark arena_mark;
+
+/* A position in an arena. Everything allocated after the mark was taken is released by arena_release. */
+struct arena_mark {
+    arena_block* block;
+    size_t used;
+};
+
+/* Creates an arena whose blocks hold at least block_size bytes. Pass 0 for a default size. */
+arena* arena_create(size_t block_size);
+
+/* Returns size bytes aligned for any type. Never returns null; exits if memory runs out. */
+void* arena_alloc(arena* a, size_t size);
+
+/* Resizes an allocation of old_size bytes. If ptr is the most recent allocation it is grown or shrunk in place when
+ * possible; otherwise the contents are copied to a new allocation. ptr may be null. */
+void* arena_realloc(arena* a, void* ptr, size_t old_size, size_t new_size);
+
+/* A hook run by arena_alloc, and by arena_realloc when it grows an allocation, before it hands out size bytes. It
+ * may end the computation early by a longjmp to a point outside the arena's callers; the arena is untouched at
+ * that point, so it can then be released to an earlier mark as usual. */
+typedef void (*arena_guard_fn)(arena* a, size_t size, void* ctx);
+
+/* Installs fn, called with ctx, as the guard of a. A null fn removes the guard. */
+void arena_set_guard(arena* a, arena_guard_fn fn, void* ctx);
+
+/* Runs the guard of a, if it has one, with a size of 0. Loops that run long without allocating call it once per
+ * step, so that a guard which enforces a deadline still gets to stop them. */
+void arena_check(arena* a);
+
+arena_mark arena_get_mark(const arena* const a);
+
+/* Releases everything allocated since m was taken. Marks taken after m become invalid. */
+void arena_release(arena* a, arena_mark m);
+
+/* Releases every allocation, keeping the blocks for reuse. */
+void arena_reset(arena* a);
+
+/* The number of bytes currently reserved from the system by the arena. */
+size_t arena_capacity(const arena* const a);
+
+void arena_free(arena* a);
+
+#endif
@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include "./batch.h"
+#include "./thread_pool.h"
+
+typedef struct batch_ctx batch_ctx;
+typedef struct batch_slot batch_slot;
+typedef struct job_guard job_guard;
+
+struct batch_ctx {
+    const batch_job* job;
+    double time_limit_ns;
+    size_t memory_limit;
+    // tells the arenas of this run from those a thread kept from an earlier one
+    unsigned long run;
+    pthread_mutex_t lock;
+    // every worker arena of the run, freed at the end
+    arena** arenas;
+    size_t n_arenas;
+    size_t cap_arenas;
+};
+
+/* The limits of the job running on an arena, checked on every allocation from it and at every arena_check. */
+struct job_guard {
+    jmp_buf escape;
+    batch_status status;
+    double deadline_ns;
+    size_t memory_limit;
+    size_t used;
+    unsigned long calls;
+};
+
+/* One spec of the current window and, once its job has run, the result. The guard lives here rather than on the
+ * stack of run_slot, which sets it up after setjmp and reads it again after the longjmp. */
+struct batch_slot {
+    batch_ctx* ctx;
+    char* spec;
+    size_t len;
+    size_t line;
+    batch_status status;
+    double ns;
+    char* text;
+    size_t text_len;
+    job_guard guard;
+};
+
+static atomic_ulong next_run = 1;
+
+static _Thread_local arena* worker_arena;
+static _Thread_local unsigned long worker_run;
+// the guard of the job running on this thread, for the SIGFPE handler
+static _Thread_local job_guard* running_guard;
+
+const char* batch_strstatus(batch_status status) {
+    switch (status) {
+        case BATCH_OK: return "ok";
+        case BATCH_ERROR: return "error";
+        case BATCH_TIMEOUT: return "timeout";
+        case BATCH_MEMORY: return "memory";
+    }
+    return "unknown";
+}
+
+static void* batch_alloc(size_t n, size_t size) {
+    void* ptr = malloc((n ? n : 1) * size);
+    if (!ptr) {
+        perror("Could not allocate memory in batch");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+/* The arena of the calling thread, created on its first job of the run. */
+static arena* local_arena(batch_ctx* ctx) {
+    if (worker_run != ctx->run) {
+        worker_arena = arena_create(0);
+        worker_run = ctx->run;
+        pthread_mutex_lock(&ctx->lock);
+        if (ctx->n_arenas == ctx->cap_arenas) {
+            ctx->cap_arenas = ctx->cap_arenas ? 2 * ctx->cap_arenas : 16;
+            arena** arenas = realloc(ctx->arenas, ctx->cap_arenas * sizeof(arena*));
+            if (!arenas) {
+                perror("Could not allocate memory in batch");
+                exit(EXIT_FAILURE);
+            }
+            ctx->arenas = arenas;
+        }
+        ctx->arenas[ctx->n_arenas++] = worker_arena;
+        pthread_mutex_unlock(&ctx->lock);
+    }
+    return worker_arena;
+}
+
+static void guard(arena* a, size_t size, void* ctx) {
+    (void) a;
+    job_guard* g = ctx;
+    g->used += size;
+    if (g->memory_limit && g->used > g->memory_limit) {
+        g->status = BATCH_MEMORY;
+        longjmp(g->escape, 1);
+    }
+    if (g->deadline_ns && ++g->calls % BATCH_CLOCK_INTERVAL == 0 && now_ns() > g->deadline_ns) {
+        g->status = BATCH_TIMEOUT;
+        longjmp(g->escape, 1);
+    }
+}
+
+/* Integer division traps on a zero divisor and on LONG_MIN / -1, which an overflowing job can reach. The fault
+ * ends the job that raised it, which is reported as an error, instead of the whole batch. The handler is installed
+ * with SA_NODEFER, so the signal is not left blocked after the longjmp. */
+static void on_fault(int sig) {
+    job_guard* g = running_guard;
+    if (!g) {
+        signal(sig, SIG_DFL);
+        raise(sig);
+        return;
+    }
+    g->status = BATCH_ERROR;
+    longjmp(g->escape, 1);
+}
+
+static void run_slot(void* arg) {
+    batch_slot* s = arg;
+    batch_ctx* ctx = s->ctx;
+    outbuf ob;
+    outbuf_memory(&ob);
+    double start = now_ns();
+    void* state = NULL;
+    batch_status status = ctx->job->prepare(s->spec, s->len, &state, &ob);
+    if (status == BATCH_OK) {
+        arena* a = local_arena(ctx);
+        arena_mark m = arena_get_mark(a);
+        job_guard* g = &s->guard;
+        *g = (job_guard) {
+            .deadline_ns = ctx->time_limit_ns ? start + ctx->time_limit_ns : 0,
+            .memory_limit = ctx->memory_limit
+        };
+        if (!setjmp(g->escape)) {
+            running_guard = g;
+            if (g->deadline_ns || g->memory_limit) {
+                arena_set_guard(a, guard, g);
+            }
+            status = ctx->job->run(state, a, &ob);
+        } else {
+            status = g->status;
+        }
+        running_guard = NULL;
+        arena_set_guard(a, NULL, NULL);
+        arena_release(a, m);
+        ctx->job->cleanup(state);
+    }
+    s->ns = now_ns() - start;
+    if (status == BATCH_OK && ctx->time_limit_ns && s->ns > ctx->time_limit_ns) {
+        status = BATCH_TIMEOUT;
+    }
+    if (status == BATCH_TIMEOUT || status == BATCH_MEMORY) {
+        // whatever the job wrote before it was stopped is incomplete
+        ob.len = 0;
+        outbuf_puts(&ob, status == BATCH_TIMEOUT ? "time limit exceeded" : "memory limit exceeded");
+    } else if (s->guard.status == BATCH_ERROR) {
+        // only on_fault sets this status on the guard
+        ob.len = 0;
+        outbuf_puts(&ob, "arithmetic fault, such as a coefficient overflow");
+    }
+    s->status = status;
+    s->text = ob.data;
+    s->text_len = ob.len;
+}
+
+static void write_slot(outbuf* ob, const batch_slot* const s) {
+    outbuf_ulong(ob, s->line);
+    outbuf_putc(ob, '\t');
+    outbuf_puts(ob, batch_strstatus(s->status));
+    outbuf_putc(ob, '\t');
+    outbuf_ulong(ob, (unsigned long) (s->ns / 1e3));
+    outbuf_putc(ob, '\t');
+    outbuf_write(ob, s->text, s->text_len);
+    outbuf_putc(ob, '\n');
+}
+
+int batch_run(FILE* in, FILE* out, const batch_job* job, const batch_opts* opts, batch_stats* stats) {
+    batch_opts o = opts ? *opts : (batch_opts) {0};
+    size_t window = o.window ? o.window : BATCH_DEFAULT_WINDOW;
+    batch_ctx ctx = {
+        .job = job,
+        .time_limit_ns = o.time_limit_ms * 1e6,
+        .memory_limit = o.memory_limit,
+        .run = atomic_fetch_add(&next_run, 1)
+    };
+    pthread_mutex_init(&ctx.lock, NULL);
+    struct sigaction fault = {.sa_handler = on_fault, .sa_flags = SA_NODEFER}, old_fault;
+    sigemptyset(&fault.sa_mask);
+    sigaction(SIGFPE, &fault, &old_fault);
+    batch_stats st = {0};
+    double start = now_ns();
+
+    tpool* pool = tpool_create(o.threads);
+    batch_slot* slots = batch_alloc(window, sizeof(batch_slot));
+    outbuf ob;
+    outbuf_file(&ob, out);
+    char* line = NULL;
+    size_t line_cap = 0;
+    size_t line_no = 0;
+    bool eof = false;
+    while (!eof) {
+        size_t n = 0;
+        while (n < window) {
+            ssize_t len = getline(&line, &line_cap, in);
+            if (len < 0) {
+                eof = true;
+                break;
+            }
+            line_no++;
+            while (len && (line[len - 1] == '\n' || line[len - 1] == '\r')) len--;
+            size_t i = 0;
+            while (i < (size_t) len && (line[i] == ' ' || line[i] == '\t')) i++;
+            if (i == (size_t) len || line[i] == '#') continue;
+            batch_slot* s = &slots[n++];
+            *s = (batch_slot) {.ctx = &ctx, .len = (size_t) len, .line = line_no};
+            s->spec = batch_alloc(s->len + 1, 1);
+            memcpy(s->spec, line, s->len);
+            s->spec[s->len] = '\0';
+        }
+        for (size_t i = 0; i < n; i++) tpool_submit(pool, run_slot, &slots[i]);
+        tpool_wait(pool);
+        for (size_t i = 0; i < n; i++) {
+            write_slot(&ob, &slots[i]);
+            st.status[slots[i].status]++;
+            free(slots[i].spec);
+            free(slots[i].text);
+        }
+        st.jobs += n;
+    }
+    int ret = ferror(in) ? -1 : 0;
+    if (outbuf_flush(&ob)) ret = -1;
+
+    free(line);
+    free(slots);
+    tpool_free(pool);
+    for (size_t i = 0; i < ctx.n_arenas; i++) arena_free(ctx.arenas[i]);
+    free(ctx.arenas);
+    pthread_mutex_destroy(&ctx.lock);
+    sigaction(SIGFPE, &old_fault, NULL);
+    st.wall_ms = (now_ns() - start) / 1e6;
+    if (stats) *stats = st;
+    return ret;
+}
@@ -0,0 +1,79 @@
+/** Running many small independent jobs read from a stream, one spec per line. Lines are read in windows; the jobs
+ * of a window run on a thread pool and their results are written out in input order before the next window is
+ * read, so memory stays bounded however long the input is. Every thread of the pool has an arena of its own, so
+ * jobs that take their temporaries from it never contend on the system allocator, and each job's arena memory is
+ * released in O(1) when it finishes.
+ *
+ * Time and memory limits are enforced through an arena guard (see util/arena.h): a job that exceeds them is
+ * abandoned at its next arena allocation or arena_check and reported as such. Memory the job got from malloc is not
+ * tracked, and is leaked if the job is abandoned, so jobs should allocate through the arena whatever can run long,
+ * and call arena_check in loops that do not allocate. A job that overruns its time without touching the arena runs
+ * to the end and is reported as timed out afterwards.
+ *
+ * While batch_run runs, it handles SIGFPE, which integer division raises on a zero divisor or on overflow. A job
+ * that raises it is abandoned in the same way and reported as an error, and the other jobs carry on.
+ *
+ * Each result line is "line<TAB>status<TAB>microseconds<TAB>text", where line is the line number of the spec,
+ * status is one of ok, error, timeout or memory, and text is what the job wrote, or a short reason otherwise.
+ * Blank lines and lines starting with '#' are skipped. */
+#ifndef _BATCH_H_INCLUDED_
+#define _BATCH_H_INCLUDED_
+
+#include <stddef.h>
+#include <stdio.h>
+#include "./arena.h"
+#include "./outbuf.h"
+
+/* Number of specs read at a time when batch_opts.window is 0. */
+#define BATCH_DEFAULT_WINDOW 4096
+
+/* The deadline of a job is checked every this many arena allocations and arena_check calls. */
+#define BATCH_CLOCK_INTERVAL 64
+
+typedef enum {
+    BATCH_OK,
+    BATCH_ERROR,
+    BATCH_TIMEOUT,
+    BATCH_MEMORY
+} batch_status;
+
+const char* batch_strstatus(batch_status status);
+
+/* A kind of job, in three steps. prepare parses the len bytes of a spec, which are not \0-terminated, into *state
+ * and returns BATCH_OK, or writes a message to out and returns BATCH_ERROR. run computes the result from state
+ * and writes it to out, taking its temporaries from a; it is the only step the limits apply to, so it may be
+ * abandoned part way. cleanup is always called after a successful prepare, and frees state. */
+typedef struct batch_job batch_job;
+
+struct batch_job {
+    batch_status (*prepare)(const char* spec, size_t len, void** state, outbuf* out);
+    batch_status (*run)(void* state, arena* a, outbuf* out);
+    void (*cleanup)(void* state);
+};
+
+typedef struct batch_opts batch_opts;
+
+struct batch_opts {
+    // worker threads; 0 means one per online processor
+    size_t threads;
+    // specs read and run at a time; 0 means BATCH_DEFAULT_WINDOW
+    size_t window;
+    // per-job limits; 0 means none
+    double time_limit_ms;
+    size_t memory_limit;
+};
+
+typedef struct batch_stats batch_stats;
+
+struct batch_stats {
+    size_t jobs;
+    // jobs by batch_status
+    size_t status[4];
+    double wall_ms;
+};
+
+/* Runs a job for every spec in in and writes the results to out. opts may be null for the defaults. Returns 0, or
+ * -1 if reading in or writing out failed. */
+int batch_run(FILE* in, FILE* out, const batch_job* job, const batch_opts* opts, batch_stats* stats);
+
+#endif
@@ -0,0 +1,288 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "./binfile.h"
+#include "./instrument.h"
+
+#define BINFILE_MAGIC "HGEOMBIN"
+#define BINFILE_BYTE_ORDER 0x01020304u
+
+typedef struct file_header file_header;
+typedef struct record_header record_header;
+
+struct file_header {
+    char magic[8];
+    uint32_t version;
+    // BINFILE_BYTE_ORDER as written by the writing machine
+    uint32_t byte_order;
+    // sizeof(term) and offsetof(term, coeff), since sums are stored in the native layout
+    uint32_t term_size;
+    uint32_t term_coeff_offset;
+    uint64_t count;
+    uint8_t reserved[32];
+};
+
+struct record_header {
+    uint32_t kind;
+    // bit 0: the mp_int is negative
+    uint32_t flags;
+    // terms of a sum or limbs of an mp_int
+    uint64_t count;
+    uint64_t bytes;
+    uint8_t reserved[40];
+};
+
+_Static_assert(sizeof(file_header) == BINFILE_ALIGN, "the file header fills one aligned block");
+_Static_assert(sizeof(record_header) == BINFILE_ALIGN, "record headers fill one aligned block");
+
+struct binfile {
+    const unsigned char* base;
+    size_t size;
+    size_t count;
+    // offset of each record header
+    size_t* offsets;
+};
+
+struct binfile_writer {
+    FILE* f;
+    uint64_t count;
+    // offset of the header of the sum being streamed, or -1
+    long open_record;
+    uint64_t open_terms;
+    bool failed;
+};
+
+static size_t align_up(size_t n) {
+    return (n + BINFILE_ALIGN - 1) & ~(size_t) (BINFILE_ALIGN - 1);
+}
+
+static const record_header* record_at(const binfile* const f, size_t i) {
+    return (const record_header*) (f->base + f->offsets[i]);
+}
+
+binfile* binfile_open(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t) st.st_size;
+    if (size < sizeof(file_header)) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+    void* base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+
+    const file_header* h = base;
+    if (memcmp(h->magic, BINFILE_MAGIC, sizeof(h->magic)) || h->version != BINFILE_VERSION ||
+        h->byte_order != BINFILE_BYTE_ORDER || h->term_size != sizeof(term) ||
+        h->term_coeff_offset != offsetof(term, coeff) || h->count > size / BINFILE_ALIGN) {
+        munmap(base, size);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    binfile* f = malloc(sizeof(binfile));
+    size_t* offsets = malloc((h->count ? h->count : 1) * sizeof(size_t));
+    if (!f || !offsets) {
+        perror("Could not allocate memory in binfile_open");
+        exit(EXIT_FAILURE);
+    }
+    *f = (binfile){.base = base, .size = size, .count = h->count, .offsets = offsets};
+
+    // only the record headers are read, so opening costs one page fault per record at most
+    size_t off = sizeof(file_header);
+    for (size_t i = 0; i < f->count; i++) {
+        // the last record's padding may be cut off, which leaves off past the end
+        if (off > size || size - off < sizeof(record_header)) goto invalid;
+        const record_header* r = (const record_header*) (f->base + off);
+        uint64_t expected;
+        if (r->kind == BINFILE_SUM) {
+            if (r->count > SIZE_MAX / sizeof(term)) goto invalid;
+            expected = (r->count ? r->count : 1) * sizeof(term);
+        } else if (r->kind == BINFILE_MPINT) {
+            if (r->count > SIZE_MAX / sizeof(uint64_t)) goto invalid;
+            expected = r->count * sizeof(uint64_t);
+        } else {
+            goto invalid;
+        }
+        if (r->bytes != expected || r->bytes > size - off - sizeof(record_header)) goto invalid;
+        offsets[i] = off;
+        off = align_up(off + sizeof(record_header) + r->bytes);
+    }
+    return f;
+
+invalid:
+    binfile_close(f);
+    errno = EINVAL;
+    return NULL;
+}
+
+size_t binfile_count(const binfile* const f) {
+    return f->count;
+}
+
+binfile_kind binfile_kind_at(const binfile* const f, size_t i) {
+    return (binfile_kind) record_at(f, i)->kind;
+}
+
+int binfile_sum(const binfile* const f, size_t i, sum* out) {
+    if (i >= f->count || record_at(f, i)->kind != BINFILE_SUM) {
+        errno = EINVAL;
+        return -1;
+    }
+    const record_header* r = record_at(f, i);
+    *out = (sum){
+        .n = r->count,
+        .capacity = 0,
+        .terms = (term*) (r + 1)
+    };
+    return 0;
+}
+
+int binfile_mpint(const binfile* const f, size_t i, mp_int* out) {
+    if (i >= f->count || record_at(f, i)->kind != BINFILE_MPINT) {
+        errno = EINVAL;
+        return -1;
+    }
+    const record_header* r = record_at(f, i);
+    *out = mpint_view(r->flags & 1, (const uint64_t*) (r + 1), r->count);
+    return 0;
+}
+
+void binfile_close(binfile* f) {
+    if (!f) return;
+    munmap((void*) f->base, f->size);
+    free(f->offsets);
+    free(f);
+}
+
+static void write_bytes(binfile_writer* w, const void* data, size_t n) {
+    if (!w->failed && n && fwrite(data, 1, n, w->f) != n) w->failed = true;
+}
+
+/* Pads the file with zeros up to the next aligned offset. */
+static void pad(binfile_writer* w) {
+    static const unsigned char zeros[BINFILE_ALIGN];
+    long pos = ftell(w->f);
+    if (pos < 0) {
+        w->failed = true;
+        return;
+    }
+    write_bytes(w, zeros, align_up((size_t) pos) - (size_t) pos);
+}
+
+binfile_writer* binfile_writer_open(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return NULL;
+    binfile_writer* w = malloc(sizeof(binfile_writer));
+    if (!w) {
+        perror("Could not allocate memory in binfile_writer_open");
+        exit(EXIT_FAILURE);
+    }
+    *w = (binfile_writer){.f = f, .open_record = -1};
+    // the count is filled in by binfile_writer_close
+    file_header h = {
+        .version = BINFILE_VERSION,
+        .byte_order = BINFILE_BYTE_ORDER,
+        .term_size = sizeof(term),
+        .term_coeff_offset = offsetof(term, coeff)
+    };
+    memcpy(h.magic, BINFILE_MAGIC, sizeof(h.magic));
+    write_bytes(w, &h, sizeof(h));
+    return w;
+}
+
+int binfile_begin_sum(binfile_writer* w) {
+    if (w->open_record >= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    w->open_record = ftell(w->f);
+    w->open_terms = 0;
+    record_header r = {.kind = BINFILE_SUM};
+    write_bytes(w, &r, sizeof(r));
+    return w->failed ? -1 : 0;
+}
+
+int binfile_write_terms(binfile_writer* w, const term* terms, size_t n) {
+    if (w->open_record < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    write_bytes(w, terms, n * sizeof(term));
+    w->open_terms += n;
+    return w->failed ? -1 : 0;
+}
+
+int binfile_end_sum(binfile_writer* w) {
+    if (w->open_record < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!w->open_terms) {
+        term zero = {0};
+        write_bytes(w, &zero, sizeof(zero));
+    }
+    record_header r = {
+        .kind = BINFILE_SUM,
+        .count = w->open_terms,
+        .bytes = (w->open_terms ? w->open_terms : 1) * sizeof(term)
+    };
+    if (!w->failed && fseek(w->f, w->open_record, SEEK_SET)) w->failed = true;
+    write_bytes(w, &r, sizeof(r));
+    if (!w->failed && fseek(w->f, 0, SEEK_END)) w->failed = true;
+    pad(w);
+    w->open_record = -1;
+    w->count++;
+    return w->failed ? -1 : 0;
+}
+
+int binfile_write_sum(binfile_writer* w, const sum* const p) {
+    if (binfile_begin_sum(w) || binfile_write_terms(w, p->terms, p->n)) return -1;
+    return binfile_end_sum(w);
+}
+
+int binfile_write_mpint(binfile_writer* w, const mp_int* const m) {
+    if (w->open_record >= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    size_t n = mpint_size(m);
+    record_header r = {
+        .kind = BINFILE_MPINT,
+        .flags = mpint_lt_i(m, 0) ? 1 : 0,
+        .count = n,
+        .bytes = n * sizeof(uint64_t)
+    };
+    write_bytes(w, &r, sizeof(r));
+    write_bytes(w, mpint_limbs(m), n * sizeof(uint64_t));
+    pad(w);
+    w->count++;
+    return w->failed ? -1 : 0;
+}
+
+int binfile_writer_close(binfile_writer* w) {
+    bool failed = w->failed || w->open_record >= 0;
+    // patch the record count into the header
+    uint64_t count = w->count;
+    if (!failed && (fseek(w->f, offsetof(file_header, count), SEEK_SET) ||
+                    fwrite(&count, sizeof(count), 1, w->f) != 1)) {
+        failed = true;
+    }
+    if (fclose(w->f)) failed = true;
+    free(w);
+    return failed ? -1 : 0;
+}
@@ -0,0 +1,63 @@
+/** A versioned binary file format for polynomials and multiprecision integers, designed to be memory-mapped and
+ * used in place. A file is a 64-byte header followed by records, each made of a 64-byte record header and its payload,
+ * padded to a multiple of 64 bytes so that every payload is 64-byte aligned:
+ *   - a sum is stored as its array of terms in the native layout of struct term, so that a mapped record can be
+ *     passed to the polynomial operations as it is. The zero polynomial stores one zeroed term, as in memory.
+ *   - an mp_int is stored as its limbs, least significant first, with the sign in the record flags.
+ * The header records the byte order and the size and layout of a term, and files written on a machine with a
+ * different layout are rejected on open. Payloads are not validated on open, which would touch every page;
+ * files are trusted to come from binfile_writer. */
+#ifndef _BINFILE_H_INCLUDED_
+#define _BINFILE_H_INCLUDED_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../polynomial/sum.h"
+#include "../numeric/mp_int.h"
+
+#define BINFILE_VERSION 1
+#define BINFILE_ALIGN 64
+
+typedef enum {
+    BINFILE_SUM = 1,
+    BINFILE_MPINT = 2
+} binfile_kind;
+
+typedef struct binfile binfile;
+typedef struct binfile_writer binfile_writer;
+
+/* Maps path read-only and indexes its records. Returns null with errno set on failure; errno is EINVAL when the
+ * file is not in this format, has another version, or was written with a different term layout. */
+binfile* binfile_open(const char* path);
+
+size_t binfile_count(const binfile* const f);
+
+binfile_kind binfile_kind_at(const binfile* const f, size_t i);
+
+/* A zero-copy view of record i, which must be a sum. The terms point into the mapping: the view must not be
+ * modified or passed to free_polynomial, and is valid until binfile_close. Returns 0 on success. */
+int binfile_sum(const binfile* const f, size_t i, sum* out);
+
+/* A zero-copy view of record i, which must be an mp_int (see mpint_view). Release it with mpint_free before
+ * binfile_close. Returns 0 on success. */
+int binfile_mpint(const binfile* const f, size_t i, mp_int* out);
+
+void binfile_close(binfile* f);
+
+/* Starts a new file at path, replacing any existing file. Returns null with errno set on failure. */
+binfile_writer* binfile_writer_open(const char* path);
+
+int binfile_write_sum(binfile_writer* w, const sum* const p);
+
+int binfile_write_mpint(binfile_writer* w, const mp_int* const m);
+
+/* Writes a sum in pieces, for polynomials produced a chunk of terms at a time: binfile_begin_sum, any number of
+ * binfile_write_terms with terms in decreasing order of exponent, then binfile_end_sum. */
+int binfile_begin_sum(binfile_writer* w);
+int binfile_write_terms(binfile_writer* w, const term* terms, size_t n);
+int binfile_end_sum(binfile_writer* w);
+
+/* Completes the header and closes the file. Returns 0 if every write succeeded; the writer is freed either way. */
+int binfile_writer_close(binfile_writer* w);
+
+#endif
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "./heap.h"
+#include "./instrument.h"
 
 struct heap {
     size_t heap_size;
@@ -9,6 +10,20 @@ struct heap {
     term* arr;
 };
 
+static inline size_t left(size_t i) {
+    return 2 * i + 1;
+}
+
+static inline size_t right(size_t i) {
+    return 2 * i + 2;
+}
+
+/* If i = 0, returns 0. i.e. parent of the root is the root. */
+static inline size_t parent(size_t i) {
+    if (i == 0) return 0;
+    return (i - 1) / 2;
+}
+
 int increase_key(heap* h, size_t elem, int new_key) {
     h->arr[elem].exp = new_key;
     return up_heap(h, elem);
@@ -48,7 +63,7 @@ int heap_remove(heap* h, size_t elem) {
     /* Except in the case when heap_size is very small, when it is not worth it. */
     if (h->heap_size > 20 && h->heap_size < (int) (0.25 * h->heap_max)) {
         h->heap_max = (int) (0.5 * h-> heap_max);
-        term* tmp = realloc(h->arr, h->heap_max); 
+        term* tmp = reallocarray(h->arr, h->heap_max, sizeof(term)); 
         if (!tmp) {
             perror("Error in realloc in heap_remove");
             exit(EXIT_FAILURE);
@@ -69,7 +84,7 @@ term extract_max(heap* h) {
     /* In order to avoid wasting memory, make sure that heap is always 1/4 full */
     if (h->heap_size > 20 && h->heap_size < (int) (0.25 * h->heap_max)) {
         h->heap_max = (int) (0.5 * h-> heap_max);
-        term* tmp = realloc(h->arr, h->heap_max);
+        term* tmp = reallocarray(h->arr, h->heap_max, sizeof(term));
         if (!tmp) {
             perror("Could not resize exponent heap after removal");
             exit(EXIT_FAILURE);
@@ -101,6 +116,7 @@ int heapify(heap* h, size_t root) {
         term t = h->arr[root];
         h->arr[root] = h->arr[largest];
         h->arr[largest] = t;
+        INSTR_SIFTS(1);
         return heapify(h, largest);
     }
     return 0;
@@ -118,6 +134,7 @@ int up_heap(heap* h, size_t elem) {
         h->arr[curr] = h->arr[p];
         curr = p;
         p = parent(curr);
+        INSTR_SIFTS(1);
     }
     h->arr[curr] = t;
     return 0;
@@ -138,19 +155,26 @@ heap* build_max_heap(size_t n, term* arr) {
     return h;
 }
 
+/* Sorts arr in-place by decreasing exponent and returns it. The caller keeps ownership of arr. */
 term* heap_sort(size_t n, term* arr) {
+    if (n < 2) return arr;
     heap* h = build_max_heap(n, arr);
-    term* out = malloc(n * sizeof(term));
-    size_t i = 0;
     term t;
-    while(!is_empty(h)) {
-        t = extract_max(h);
-        out[i].coeff = t.coeff;
-        out[i].exp = t.exp;
-        i++;
+    // repeatedly move the max to the end of the array, which leaves it in increasing order
+    while (h->heap_size > 1) {
+        t = h->arr[0];
+        h->arr[0] = h->arr[h->heap_size - 1];
+        h->arr[h->heap_size - 1] = t;
+        h->heap_size -= 1;
+        heapify(h, 0);
+    }
+    free(h);
+    for (size_t i = 0, j = n - 1; i < j; i++, j--) {
+        t = arr[i];
+        arr[i] = arr[j];
+        arr[j] = t;
     }
-    free_heap(h);
-    return out;
+    return arr;
 }
 
 void free_heap(heap* h) {
@@ -160,20 +184,6 @@ void free_heap(heap* h) {
     h = 0;
 }
 
-inline size_t left(size_t i) {
-    return 2 * i + 1;
-}
-
-inline size_t right(size_t i) {
-    return 2 * i + 2;
-}
-
-/* If i = 0, returns 0. i.e. parent of the root is the root. */
-inline size_t parent(size_t i) {
-    if (i == 0) return 0;
-    return (i - 1) / 2;
-}
-
-inline int is_empty(const heap* const h) {
+int is_empty(const heap* const h) {
     return (h->heap_size == 0);
-}
\ No newline at end of file
+}
@@ -41,10 +41,12 @@ int up_heap(heap* h, size_t elem);
 /* Builds a min-heap of the n elements in arr. Reorders arr in-place and continues to modify it afterwards. */
 heap* build_max_heap(size_t n, term* arr);
 
+/* Sorts arr in-place by decreasing exponent and returns it. See util/term_sort.h for the linear-time sorts
+ * used by polynomial arithmetic. */
 term* heap_sort(size_t n, term* arr);
 
 void free_heap(heap* h);
 
-inline int is_empty(const heap* const h);
+int is_empty(const heap* const h);
 
 #endif
@@ -0,0 +1,178 @@
+#define INSTRUMENT_IMPL
+#include "./instrument.h"
+
+#include <malloc.h>
+#include <stdatomic.h>
+
+static atomic_size_t op_calls[INSTR_NUM_OPS];
+static atomic_size_t op_terms[INSTR_NUM_OPS];
+static atomic_size_t alloc_calls;
+static atomic_size_t alloc_bytes;
+// signed, since memory allocated outside the library may be freed inside it
+static atomic_long live_bytes;
+static atomic_long peak_live_bytes;
+static atomic_size_t heap_sifts;
+static atomic_size_t gcd_step_calls[INSTR_GCD_STEPS];
+static atomic_int gcd_step_max_bits[INSTR_GCD_STEPS];
+
+static _Atomic(instr_gcd_callback) gcd_callback;
+static void* _Atomic gcd_callback_ctx;
+
+static const char* const op_names[INSTR_NUM_OPS] = {
+    [INSTR_ADD] = "add",
+    [INSTR_ADD_INPLACE] = "add_inplace",
+    [INSTR_SUB_MUL] = "sub_mul_inplace",
+    [INSTR_SCALAR_PROD] = "scalar_prod",
+    [INSTR_NEGATE] = "negate",
+    [INSTR_CONT] = "cont",
+    [INSTR_PRIM] = "prim",
+    [INSTR_PROD] = "prod",
+    [INSTR_PQUO] = "pquo",
+    [INSTR_PREM] = "prem",
+    [INSTR_QUO] = "quo",
+    [INSTR_REM] = "rem",
+    [INSTR_PRIM_GCD] = "prim_gcd"
+};
+
+const char* instr_op_name(instr_op op) {
+    return op < INSTR_NUM_OPS ? op_names[op] : "?";
+}
+
+void instr_record_op(instr_op op, size_t terms) {
+    atomic_fetch_add_explicit(&op_calls[op], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&op_terms[op], terms, memory_order_relaxed);
+}
+
+void instr_record_sifts(size_t n) {
+    atomic_fetch_add_explicit(&heap_sifts, n, memory_order_relaxed);
+}
+
+void instr_record_gcd_step(size_t step, int deg, int bits) {
+    size_t slot = step < INSTR_GCD_STEPS ? step : INSTR_GCD_STEPS - 1;
+    atomic_fetch_add_explicit(&gcd_step_calls[slot], 1, memory_order_relaxed);
+    int seen = atomic_load_explicit(&gcd_step_max_bits[slot], memory_order_relaxed);
+    while (bits > seen &&
+           !atomic_compare_exchange_weak_explicit(&gcd_step_max_bits[slot], &seen, bits,
+                                                  memory_order_relaxed, memory_order_relaxed)) {}
+    instr_gcd_callback fn = atomic_load_explicit(&gcd_callback, memory_order_acquire);
+    if (fn) fn(step, deg, bits, atomic_load_explicit(&gcd_callback_ctx, memory_order_relaxed));
+}
+
+void instr_set_gcd_callback(instr_gcd_callback fn, void* ctx) {
+    atomic_store_explicit(&gcd_callback_ctx, ctx, memory_order_relaxed);
+    atomic_store_explicit(&gcd_callback, fn, memory_order_release);
+}
+
+static void track_alloc(void* ptr) {
+    if (!ptr) return;
+    size_t n = malloc_usable_size(ptr);
+    atomic_fetch_add_explicit(&alloc_calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&alloc_bytes, n, memory_order_relaxed);
+    long live = atomic_fetch_add_explicit(&live_bytes, (long) n, memory_order_relaxed) + (long) n;
+    long peak = atomic_load_explicit(&peak_live_bytes, memory_order_relaxed);
+    while (live > peak &&
+           !atomic_compare_exchange_weak_explicit(&peak_live_bytes, &peak, live,
+                                                  memory_order_relaxed, memory_order_relaxed)) {}
+}
+
+static void track_free(void* ptr) {
+    if (!ptr) return;
+    atomic_fetch_sub_explicit(&live_bytes, (long) malloc_usable_size(ptr), memory_order_relaxed);
+}
+
+void* instr_malloc(size_t size) {
+    void* ptr = malloc(size);
+    track_alloc(ptr);
+    return ptr;
+}
+
+void* instr_calloc(size_t n, size_t size) {
+    void* ptr = calloc(n, size);
+    track_alloc(ptr);
+    return ptr;
+}
+
+void* instr_realloc(void* ptr, size_t size) {
+    size_t old = ptr ? malloc_usable_size(ptr) : 0;
+    void* out = realloc(ptr, size);
+    // on failure the old block is still live
+    if (!out && size) return out;
+    atomic_fetch_sub_explicit(&live_bytes, (long) old, memory_order_relaxed);
+    track_alloc(out);
+    return out;
+}
+
+void* instr_reallocarray(void* ptr, size_t n, size_t size) {
+    size_t old = ptr ? malloc_usable_size(ptr) : 0;
+    void* out = reallocarray(ptr, n, size);
+    if (!out && n && size) return out;
+    atomic_fetch_sub_explicit(&live_bytes, (long) old, memory_order_relaxed);
+    track_alloc(out);
+    return out;
+}
+
+void* instr_aligned_alloc(size_t align, size_t size) {
+    void* ptr = aligned_alloc(align, size);
+    track_alloc(ptr);
+    return ptr;
+}
+
+void instr_free(void* ptr) {
+    track_free(ptr);
+    free(ptr);
+}
+
+void instr_snapshot(instr_stats* out) {
+    for (size_t i = 0; i < INSTR_NUM_OPS; i++) {
+        out->calls[i] = atomic_load_explicit(&op_calls[i], memory_order_relaxed);
+        out->terms[i] = atomic_load_explicit(&op_terms[i], memory_order_relaxed);
+    }
+    out->alloc_calls = atomic_load_explicit(&alloc_calls, memory_order_relaxed);
+    out->alloc_bytes = atomic_load_explicit(&alloc_bytes, memory_order_relaxed);
+    long live = atomic_load_explicit(&live_bytes, memory_order_relaxed);
+    long peak = atomic_load_explicit(&peak_live_bytes, memory_order_relaxed);
+    out->live_bytes = live > 0 ? (size_t) live : 0;
+    out->peak_live_bytes = peak > 0 ? (size_t) peak : 0;
+    out->heap_sifts = atomic_load_explicit(&heap_sifts, memory_order_relaxed);
+    for (size_t i = 0; i < INSTR_GCD_STEPS; i++) {
+        out->gcd_step_calls[i] = atomic_load_explicit(&gcd_step_calls[i], memory_order_relaxed);
+        out->gcd_step_max_bits[i] = atomic_load_explicit(&gcd_step_max_bits[i], memory_order_relaxed);
+    }
+}
+
+void instr_reset() {
+    for (size_t i = 0; i < INSTR_NUM_OPS; i++) {
+        atomic_store_explicit(&op_calls[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&op_terms[i], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&alloc_calls, 0, memory_order_relaxed);
+    atomic_store_explicit(&alloc_bytes, 0, memory_order_relaxed);
+    atomic_store_explicit(&peak_live_bytes, atomic_load_explicit(&live_bytes, memory_order_relaxed),
+                          memory_order_relaxed);
+    atomic_store_explicit(&heap_sifts, 0, memory_order_relaxed);
+    for (size_t i = 0; i < INSTR_GCD_STEPS; i++) {
+        atomic_store_explicit(&gcd_step_calls[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&gcd_step_max_bits[i], 0, memory_order_relaxed);
+    }
+}
+
+void instr_report(FILE* out) {
+#ifndef HYPERGEOM_INSTRUMENT
+    fprintf(out, "instrumentation is disabled; build with -DHYPERGEOM_INSTRUMENT\n");
+#endif
+    instr_stats s;
+    instr_snapshot(&s);
+    fprintf(out, "%-16s %12s %16s\n", "operation", "calls", "terms");
+    for (size_t i = 0; i < INSTR_NUM_OPS; i++) {
+        if (s.calls[i]) fprintf(out, "%-16s %12zu %16zu\n", op_names[i], s.calls[i], s.terms[i]);
+    }
+    fprintf(out, "allocations: %zu, %zu bytes; live %zu bytes, peak %zu bytes\n",
+            s.alloc_calls, s.alloc_bytes, s.live_bytes, s.peak_live_bytes);
+    fprintf(out, "heap sift steps: %zu\n", s.heap_sifts);
+    for (size_t i = 0; i < INSTR_GCD_STEPS; i++) {
+        if (s.gcd_step_calls[i]) {
+            fprintf(out, "prim_gcd step %2zu%s: %zu calls, max coefficient %d bits\n", i,
+                    i == INSTR_GCD_STEPS - 1 ? "+" : "", s.gcd_step_calls[i], s.gcd_step_max_bits[i]);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/** Opt-in instrumentation of the hot paths. Everything below the macros is compiled to nothing unless the library
+ * is built with -DHYPERGEOM_INSTRUMENT, in which case it records:
+ *   - calls and terms processed per polynomial operation (nested calls count too, so pquo also counts a quo),
+ *   - bytes allocated and peak live bytes, by routing the allocation functions of every file that includes this
+ *     header through counting wrappers,
+ *   - the largest coefficient bit-length of the pseudo-remainder at each step of prim_gcd,
+ *   - sift steps of util/heap.c and of the division heap in polynomial/heap_div.c.
+ * The counters are atomic, so they stay exact under the thread pool. Memory that the library frees but did not
+ * allocate, such as an array handed to build_max_heap, makes the live count an underestimate. */
+#ifndef _INSTRUMENT_H_INCLUDED_
+#define _INSTRUMENT_H_INCLUDED_
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef enum {
+    INSTR_ADD,
+    INSTR_ADD_INPLACE,
+    INSTR_SUB_MUL,
+    INSTR_SCALAR_PROD,
+    INSTR_NEGATE,
+    INSTR_CONT,
+    INSTR_PRIM,
+    INSTR_PROD,
+    INSTR_PQUO,
+    INSTR_PREM,
+    INSTR_QUO,
+    INSTR_REM,
+    INSTR_PRIM_GCD,
+    INSTR_NUM_OPS
+} instr_op;
+
+/* Steps of prim_gcd beyond this are folded into the last slot. */
+#define INSTR_GCD_STEPS 64
+
+typedef struct instr_stats instr_stats;
+
+struct instr_stats {
+    size_t calls[INSTR_NUM_OPS];
+    // input terms, except for prod, which counts term-by-term products
+    size_t terms[INSTR_NUM_OPS];
+    size_t alloc_calls;
+    size_t alloc_bytes;
+    size_t live_bytes;
+    size_t peak_live_bytes;
+    size_t heap_sifts;
+    // for each step of prim_gcd: how many calls reached it and the largest coefficient bit-length seen there
+    size_t gcd_step_calls[INSTR_GCD_STEPS];
+    int gcd_step_max_bits[INSTR_GCD_STEPS];
+};
+
+/* Called at every step of prim_gcd with the step number, the degree of the pseudo-remainder and the bit-length of
+ * its largest coefficient, before its content is removed. */
+typedef void (*instr_gcd_callback)(size_t step, int deg, int bits, void* ctx);
+
+const char* instr_op_name(instr_op op);
+
+void instr_snapshot(instr_stats* out);
+
+/* Clears every counter except live_bytes, and restarts peak_live_bytes from the current live_bytes. */
+void instr_reset();
+
+/* Prints the counters to out in a human-readable table. */
+void instr_report(FILE* out);
+
+void instr_set_gcd_callback(instr_gcd_callback fn, void* ctx);
+
+/* Recording functions behind the macros. */
+void instr_record_op(instr_op op, size_t terms);
+void instr_record_sifts(size_t n);
+void instr_record_gcd_step(size_t step, int deg, int bits);
+void* instr_malloc(size_t size);
+void* instr_calloc(size_t n, size_t size);
+void* instr_realloc(void* ptr, size_t size);
+void* instr_reallocarray(void* ptr, size_t n, size_t size);
+void* instr_aligned_alloc(size_t align, size_t size);
+void instr_free(void* ptr);
+
+#if defined(HYPERGEOM_INSTRUMENT) && !defined(INSTRUMENT_IMPL)
+#define INSTR_OP(op, terms) instr_record_op(INSTR_##op, (terms))
+#define INSTR_SIFTS(n) instr_record_sifts(n)
+#define INSTR_GCD_STEP(step, deg, bits) instr_record_gcd_step((step), (deg), (bits))
+#define malloc(size) instr_malloc(size)
+#define calloc(n, size) instr_calloc((n), (size))
+#define realloc(ptr, size) instr_realloc((ptr), (size))
+#define reallocarray(ptr, n, size) instr_reallocarray((ptr), (n), (size))
+#define aligned_alloc(align, size) instr_aligned_alloc((align), (size))
+#define free(ptr) instr_free(ptr)
+#else
+#define INSTR_OP(op, terms) ((void) 0)
+#define INSTR_SIFTS(n) ((void) 0)
+#define INSTR_GCD_STEP(step, deg, bits) ((void) 0)
+#endif
+
+#endif
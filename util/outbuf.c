@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "./outbuf.h"
+#include "./instrument.h"
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+char* outbuf_format_ulong(char* end, unsigned long v) {
+    char* p = end;
+    while (v >= 100) {
+        unsigned long r = v % 100;
+        v /= 100;
+        p -= 2;
+        memcpy(p, digit_pairs + 2 * r, 2);
+    }
+    if (v >= 10) {
+        p -= 2;
+        memcpy(p, digit_pairs + 2 * v, 2);
+    } else {
+        *--p = (char) ('0' + v);
+    }
+    return p;
+}
+
+void outbuf_memory(outbuf* ob) {
+    ob->kind = OUTBUF_MEMORY;
+    ob->data = NULL;
+    ob->len = ob->cap = 0;
+    ob->truncated = ob->failed = false;
+}
+
+void outbuf_fixed(outbuf* ob, char* buf, size_t cap) {
+    ob->kind = OUTBUF_FIXED;
+    ob->data = buf;
+    ob->len = 0;
+    ob->cap = cap;
+    ob->truncated = ob->failed = false;
+}
+
+void outbuf_file(outbuf* ob, FILE* f) {
+    ob->kind = OUTBUF_FILE;
+    ob->file = f;
+    ob->data = ob->chunk;
+    ob->len = 0;
+    ob->cap = OUTBUF_CHUNK;
+    ob->truncated = ob->failed = false;
+}
+
+void outbuf_fd(outbuf* ob, int fd) {
+    ob->kind = OUTBUF_FD;
+    ob->fd = fd;
+    ob->data = ob->chunk;
+    ob->len = 0;
+    ob->cap = OUTBUF_CHUNK;
+    ob->truncated = ob->failed = false;
+}
+
+/* Hands n bytes to a FILE* or descriptor sink. */
+static void sink_write(outbuf* ob, const char* s, size_t n) {
+    if (ob->failed) return;
+    if (ob->kind == OUTBUF_FILE) {
+        if (fwrite(s, 1, n, ob->file) != n) ob->failed = true;
+        return;
+    }
+    while (n) {
+        ssize_t w = write(ob->fd, s, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            ob->failed = true;
+            return;
+        }
+        s += w;
+        n -= (size_t) w;
+    }
+}
+
+void outbuf_write(outbuf* ob, const char* s, size_t n) {
+    if (n <= ob->cap - ob->len) {
+        memcpy(ob->data + ob->len, s, n);
+        ob->len += n;
+        return;
+    }
+    switch (ob->kind) {
+    case OUTBUF_MEMORY: {
+        size_t cap = ob->cap ? ob->cap : 256;
+        while (cap - ob->len < n) cap *= 2;
+        char* tmp = realloc(ob->data, cap);
+        if (!tmp) {
+            perror("Could not allocate memory in outbuf_write");
+            exit(EXIT_FAILURE);
+        }
+        ob->data = tmp;
+        ob->cap = cap;
+        memcpy(ob->data + ob->len, s, n);
+        ob->len += n;
+        return;
+    }
+    case OUTBUF_FIXED: {
+        size_t fit = ob->cap - ob->len;
+        memcpy(ob->data + ob->len, s, fit);
+        ob->len += fit;
+        ob->truncated = true;
+        return;
+    }
+    default:
+        sink_write(ob, ob->data, ob->len);
+        ob->len = 0;
+        // large pieces go straight through
+        if (n >= ob->cap) {
+            sink_write(ob, s, n);
+        } else {
+            memcpy(ob->data, s, n);
+            ob->len = n;
+        }
+    }
+}
+
+void outbuf_putc(outbuf* ob, char c) {
+    if (ob->len < ob->cap) {
+        ob->data[ob->len++] = c;
+    } else {
+        outbuf_write(ob, &c, 1);
+    }
+}
+
+void outbuf_puts(outbuf* ob, const char* s) {
+    outbuf_write(ob, s, strlen(s));
+}
+
+void outbuf_ulong(outbuf* ob, unsigned long v) {
+    char buf[OUTBUF_MAX_DIGITS];
+    char* p = outbuf_format_ulong(buf + sizeof(buf), v);
+    outbuf_write(ob, p, (size_t) (buf + sizeof(buf) - p));
+}
+
+void outbuf_long(outbuf* ob, long v) {
+    char buf[OUTBUF_MAX_DIGITS + 1];
+    char* p = outbuf_format_ulong(buf + sizeof(buf), v < 0 ? 0 - (unsigned long) v : (unsigned long) v);
+    if (v < 0) *--p = '-';
+    outbuf_write(ob, p, (size_t) (buf + sizeof(buf) - p));
+}
+
+int outbuf_flush(outbuf* ob) {
+    if (ob->kind == OUTBUF_FILE || ob->kind == OUTBUF_FD) {
+        sink_write(ob, ob->data, ob->len);
+        ob->len = 0;
+        if (ob->kind == OUTBUF_FILE && !ob->failed && fflush(ob->file)) ob->failed = true;
+    }
+    return ob->failed ? -1 : 0;
+}
+
+void outbuf_free(outbuf* ob) {
+    if (ob->kind == OUTBUF_MEMORY) {
+        free(ob->data);
+        ob->data = NULL;
+        ob->len = ob->cap = 0;
+    }
+}
@@ -0,0 +1,64 @@
+/** Buffered output to memory, a FILE* or a file descriptor. Text is gathered in a buffer and handed to the sink in
+ * large writes, so formatting many small pieces costs little more than copying them. Integers are converted by
+ * hand, two digits at a time, rather than through printf. */
+#ifndef _OUTBUF_H_INCLUDED_
+#define _OUTBUF_H_INCLUDED_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* Size of the buffer embedded in FILE* and descriptor sinks. */
+#define OUTBUF_CHUNK 8192
+
+/* Longest output of outbuf_long and outbuf_ulong. */
+#define OUTBUF_MAX_DIGITS 20
+
+typedef enum {
+    // a buffer that grows as needed; the text is the len bytes at data, without a terminating \0
+    OUTBUF_MEMORY,
+    // a caller-supplied buffer of fixed size; output that does not fit is dropped and truncated is set
+    OUTBUF_FIXED,
+    OUTBUF_FILE,
+    OUTBUF_FD
+} outbuf_kind;
+
+typedef struct outbuf outbuf;
+
+struct outbuf {
+    outbuf_kind kind;
+    char* data;
+    size_t len;
+    size_t cap;
+    FILE* file;
+    int fd;
+    bool truncated;
+    // a write to the sink failed
+    bool failed;
+    char chunk[OUTBUF_CHUNK];
+};
+
+/* The sinks need not be freed, except for outbuf_memory; the FILE* and descriptor sinks must be flushed. */
+void outbuf_memory(outbuf* ob);
+void outbuf_fixed(outbuf* ob, char* buf, size_t cap);
+void outbuf_file(outbuf* ob, FILE* f);
+void outbuf_fd(outbuf* ob, int fd);
+
+void outbuf_write(outbuf* ob, const char* s, size_t n);
+void outbuf_putc(outbuf* ob, char c);
+void outbuf_puts(outbuf* ob, const char* s);
+void outbuf_long(outbuf* ob, long v);
+void outbuf_ulong(outbuf* ob, unsigned long v);
+
+/* Writes the decimal digits of v so that they end just before end, with room for OUTBUF_MAX_DIGITS characters
+ * before it, and returns a pointer to the first digit. No terminating \0 is written. */
+char* outbuf_format_ulong(char* end, unsigned long v);
+
+/* Hands buffered output to a FILE* or descriptor sink; for FILE* sinks, also flushes the stream. Returns 0 if
+ * every write so far succeeded. */
+int outbuf_flush(outbuf* ob);
+
+/* Releases the buffer of a memory sink. */
+void outbuf_free(outbuf* ob);
+
+#endif
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "./term_sort.h"
+#include "./instrument.h"
+
+/* Counting sort and bucket accumulation are used whenever the exponent span is at most
+ * SPAN_FACTOR * n + SPAN_SLACK. Beyond that the auxiliary arrays cost more than radix passes. */
+#define SPAN_FACTOR 4
+#define SPAN_SLACK 256
+
+/* Below this many terms insertion sort beats the setup cost of the other methods. */
+#define SMALL_SORT 16
+
+static void exp_range(size_t n, const term* const arr, int* lo, int* hi) {
+    int mn = arr[0].exp, mx = arr[0].exp;
+    for (size_t i = 1; i < n; i++) {
+        if (arr[i].exp < mn) mn = arr[i].exp;
+        if (arr[i].exp > mx) mx = arr[i].exp;
+    }
+    *lo = mn;
+    *hi = mx;
+}
+
+static int span_is_small(size_t n, uint64_t span) {
+    return span <= (uint64_t) SPAN_FACTOR * n + SPAN_SLACK;
+}
+
+static void insertion_sort(size_t n, term* arr) {
+    for (size_t i = 1; i < n; i++) {
+        term t = arr[i];
+        size_t j = i;
+        while (j > 0 && arr[j - 1].exp < t.exp) {
+            arr[j] = arr[j - 1];
+            j--;
+        }
+        arr[j] = t;
+    }
+}
+
+/* Keys are hi - exp, so that sorting keys in increasing order sorts exponents in decreasing order. */
+static void counting_sort(size_t n, term* arr, int hi, uint64_t span) {
+    size_t* counts = calloc(span + 1, sizeof(size_t));
+    term* out = malloc(n * sizeof(term));
+    if (!counts || !out) {
+        perror("Could not allocate memory in counting_sort");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < n; i++) {
+        counts[(uint64_t) ((int64_t) hi - arr[i].exp) + 1]++;
+    }
+    for (uint64_t k = 1; k <= span; k++) {
+        counts[k] += counts[k - 1];
+    }
+    for (size_t i = 0; i < n; i++) {
+        out[counts[(uint64_t) ((int64_t) hi - arr[i].exp)]++] = arr[i];
+    }
+    memcpy(arr, out, n * sizeof(term));
+    free(out);
+    free(counts);
+}
+
+static void radix_sort(size_t n, term* arr, int hi, uint64_t span) {
+    term* buf = malloc(n * sizeof(term));
+    if (!buf) {
+        perror("Could not allocate memory in radix_sort");
+        exit(EXIT_FAILURE);
+    }
+    term* src = arr;
+    term* dst = buf;
+    size_t counts[256];
+
+    for (unsigned shift = 0; shift < 64 && (span - 1) >> shift; shift += 8) {
+        memset(counts, 0, sizeof(counts));
+        for (size_t i = 0; i < n; i++) {
+            counts[(((uint64_t) ((int64_t) hi - src[i].exp)) >> shift) & 0xff]++;
+        }
+        // a pass where every key shares the same digit would only copy the array
+        if (counts[(((uint64_t) ((int64_t) hi - src[0].exp)) >> shift) & 0xff] == n) {
+            continue;
+        }
+        size_t total = 0;
+        for (size_t d = 0; d < 256; d++) {
+            size_t c = counts[d];
+            counts[d] = total;
+            total += c;
+        }
+        for (size_t i = 0; i < n; i++) {
+            dst[counts[(((uint64_t) ((int64_t) hi - src[i].exp)) >> shift) & 0xff]++] = src[i];
+        }
+        term* t = src;
+        src = dst;
+        dst = t;
+    }
+    if (src != arr) {
+        memcpy(arr, src, n * sizeof(term));
+    }
+    free(buf);
+}
+
+void sort_terms_with(size_t n, term* arr, term_sort_method method) {
+    if (n < 2) return;
+
+    int lo, hi;
+    exp_range(n, arr, &lo, &hi);
+    uint64_t span = (uint64_t) ((int64_t) hi - lo) + 1;
+    if (span == 1) return;
+
+    if (method == TERM_SORT_AUTO) {
+        if (n < SMALL_SORT) {
+            insertion_sort(n, arr);
+            return;
+        }
+        method = span_is_small(n, span) ? TERM_SORT_COUNTING : TERM_SORT_RADIX;
+    }
+    if (method == TERM_SORT_COUNTING) {
+        counting_sort(n, arr, hi, span);
+    } else {
+        radix_sort(n, arr, hi, span);
+    }
+}
+
+void sort_terms(size_t n, term* arr) {
+    sort_terms_with(n, arr, TERM_SORT_AUTO);
+}
+
+/* Combines adjacent terms with equal exponents of an array sorted by exponent, dropping zero coefficients. */
+static size_t collect_sorted(size_t n, term* arr) {
+    size_t k = 0;
+    size_t i = 0;
+    while (i < n) {
+        int e = arr[i].exp;
+        long c = 0;
+        while (i < n && arr[i].exp == e) {
+            c += arr[i].coeff;
+            i++;
+        }
+        if (c) {
+            arr[k].exp = e;
+            arr[k].coeff = c;
+            k++;
+        }
+    }
+    return k;
+}
+
+size_t sort_collect_terms(size_t n, term* arr) {
+    if (n == 0) return 0;
+
+    int lo, hi;
+    exp_range(n, arr, &lo, &hi);
+    uint64_t span = (uint64_t) ((int64_t) hi - lo) + 1;
+
+    if (n < SMALL_SORT || !span_is_small(n, span)) {
+        sort_terms(n, arr);
+        return collect_sorted(n, arr);
+    }
+
+    // accumulate by bucket: one pass to add up coefficients, one pass over the span to write them out
+    long* buckets = calloc(span, sizeof(long));
+    if (!buckets) {
+        perror("Could not allocate memory in sort_collect_terms");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < n; i++) {
+        buckets[(uint64_t) ((int64_t) hi - arr[i].exp)] += arr[i].coeff;
+    }
+    size_t k = 0;
+    for (uint64_t b = 0; b < span; b++) {
+        if (buckets[b]) {
+            arr[k].exp = (int) ((int64_t) hi - (int64_t) b);
+            arr[k].coeff = buckets[b];
+            k++;
+        }
+    }
+    free(buckets);
+    return k;
+}
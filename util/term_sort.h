@@ -0,0 +1,30 @@
+/** Linear-time sorting of monomial terms by exponent, used when assembling polynomials from unsorted terms. */
+#ifndef _TERM_SORT_H_INCLUDED_
+#define _TERM_SORT_H_INCLUDED_
+
+#include <stddef.h>
+#include "../polynomial/sum.h"
+
+/* Strategies available to sort_terms. TERM_SORT_AUTO picks one from the exponent span of the input. */
+typedef enum term_sort_method term_sort_method;
+
+enum term_sort_method {
+    TERM_SORT_AUTO,
+    /* Counting sort over the exponent range. Used when the span is at most a small multiple of n. */
+    TERM_SORT_COUNTING,
+    /* LSD radix sort on the exponent, one byte per pass. Used for sparse inputs with a wide span. */
+    TERM_SORT_RADIX,
+};
+
+/* Sorts the n terms of arr in-place by decreasing exponent. The sort is stable. */
+void sort_terms(size_t n, term* arr);
+
+/* As sort_terms, but with an explicit choice of method. */
+void sort_terms_with(size_t n, term* arr, term_sort_method method);
+
+/* Sorts the n terms of arr by decreasing exponent, combines terms with equal exponents and drops terms whose
+ * coefficients cancel. When the exponent span is small the terms are accumulated directly into buckets instead
+ * of being sorted. Returns the number of terms left at the front of arr. */
+size_t sort_collect_terms(size_t n, term* arr);
+
+#endif
@@ -0,0 +1,242 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "./thread_pool.h"
+
+typedef struct task task;
+typedef struct deque deque;
+typedef struct worker worker;
+
+struct task {
+    tpool_fn fn;
+    void* arg;
+};
+
+/* A ring buffer of tasks. The owner works at the back, thieves take from the front. */
+struct deque {
+    pthread_mutex_t lock;
+    size_t head;
+    size_t n;
+    size_t capacity;
+    task* arr;
+};
+
+struct worker {
+    tpool* pool;
+    size_t id;
+    pthread_t thread;
+};
+
+struct tpool {
+    size_t nthreads;
+    deque* deques;
+    worker* workers;
+    /* tasks submitted and not yet finished */
+    atomic_size_t pending;
+    /* tasks sitting in deques; sleeping workers wait for it to become nonzero */
+    atomic_size_t queued;
+    atomic_size_t next_deque;
+    bool shutdown;
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+};
+
+/* The pool and worker index of the current thread, if it is a worker. */
+static _Thread_local tpool* current_pool;
+static _Thread_local size_t current_id;
+
+static void deque_push_back(deque* d, task t) {
+    pthread_mutex_lock(&d->lock);
+    if (d->n == d->capacity) {
+        size_t cap = d->capacity ? 2 * d->capacity : 64;
+        task* arr = malloc(cap * sizeof(task));
+        if (!arr) {
+            perror("Could not allocate memory in thread pool");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < d->n; i++) {
+            arr[i] = d->arr[(d->head + i) % d->capacity];
+        }
+        free(d->arr);
+        d->arr = arr;
+        d->head = 0;
+        d->capacity = cap;
+    }
+    d->arr[(d->head + d->n) % d->capacity] = t;
+    d->n++;
+    pthread_mutex_unlock(&d->lock);
+}
+
+static bool deque_pop_back(deque* d, task* t) {
+    pthread_mutex_lock(&d->lock);
+    bool ok = d->n > 0;
+    if (ok) {
+        d->n--;
+        *t = d->arr[(d->head + d->n) % d->capacity];
+    }
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+static bool deque_pop_front(deque* d, task* t) {
+    pthread_mutex_lock(&d->lock);
+    bool ok = d->n > 0;
+    if (ok) {
+        *t = d->arr[d->head];
+        d->head = (d->head + 1) % d->capacity;
+        d->n--;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+/* Takes a task from deque self, or failing that steals one from the others starting at a rotating victim. */
+static bool find_task(tpool* pool, size_t self, task* t) {
+    if (self < pool->nthreads && deque_pop_back(&pool->deques[self], t)) {
+        return true;
+    }
+    size_t start = atomic_fetch_add(&pool->next_deque, 1);
+    for (size_t k = 0; k < pool->nthreads; k++) {
+        size_t victim = (start + k) % pool->nthreads;
+        if (victim != self && deque_pop_front(&pool->deques[victim], t)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void run_task(tpool* pool, task t) {
+    atomic_fetch_sub(&pool->queued, 1);
+    t.fn(t.arg);
+    if (atomic_fetch_sub(&pool->pending, 1) == 1) {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_broadcast(&pool->done_cond);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static void* worker_main(void* arg) {
+    worker* w = arg;
+    tpool* pool = w->pool;
+    current_pool = pool;
+    current_id = w->id;
+
+    task t;
+    for (;;) {
+        if (find_task(pool, w->id, &t)) {
+            run_task(pool, t);
+            continue;
+        }
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->shutdown && !atomic_load(&pool->queued)) {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        }
+        bool stop = pool->shutdown && !atomic_load(&pool->queued);
+        pthread_mutex_unlock(&pool->lock);
+        if (stop) {
+            return 0;
+        }
+    }
+}
+
+tpool* tpool_create(size_t nthreads) {
+    if (!nthreads) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = n > 0 ? (size_t) n : 1;
+    }
+    tpool* pool = malloc(sizeof(tpool));
+    if (!pool) {
+        perror("Could not allocate memory in tpool_create");
+        exit(EXIT_FAILURE);
+    }
+    pool->nthreads = nthreads;
+    pool->deques = calloc(nthreads, sizeof(deque));
+    pool->workers = calloc(nthreads, sizeof(worker));
+    if (!pool->deques || !pool->workers) {
+        perror("Could not allocate memory in tpool_create");
+        exit(EXIT_FAILURE);
+    }
+    atomic_init(&pool->pending, 0);
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->next_deque, 0);
+    pool->shutdown = false;
+    pthread_mutex_init(&pool->lock, 0);
+    pthread_cond_init(&pool->work_cond, 0);
+    pthread_cond_init(&pool->done_cond, 0);
+
+    for (size_t i = 0; i < nthreads; i++) {
+        pthread_mutex_init(&pool->deques[i].lock, 0);
+    }
+    for (size_t i = 0; i < nthreads; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].id = i;
+        if (pthread_create(&pool->workers[i].thread, 0, worker_main, &pool->workers[i])) {
+            perror("Could not start thread in tpool_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return pool;
+}
+
+size_t tpool_size(const tpool* const pool) {
+    return pool->nthreads;
+}
+
+void tpool_submit(tpool* pool, tpool_fn fn, void* arg) {
+    task t = {.fn = fn, .arg = arg};
+    size_t target = current_pool == pool ? current_id : atomic_fetch_add(&pool->next_deque, 1) % pool->nthreads;
+
+    atomic_fetch_add(&pool->pending, 1);
+    atomic_fetch_add(&pool->queued, 1);
+    deque_push_back(&pool->deques[target], t);
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void tpool_wait(tpool* pool) {
+    size_t self = pool->nthreads;
+    task t;
+    while (atomic_load(&pool->pending)) {
+        if (find_task(pool, self, &t)) {
+            run_task(pool, t);
+            continue;
+        }
+        // Everything left is running on other threads. Sleep until it finishes; a task that submits more work
+        // wakes a worker rather than us, so waking only on completion is enough.
+        pthread_mutex_lock(&pool->lock);
+        if (atomic_load(&pool->pending) && !atomic_load(&pool->queued)) {
+            pthread_cond_wait(&pool->done_cond, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+void tpool_free(tpool* pool) {
+    if (!pool) {
+        return;
+    }
+    tpool_wait(pool);
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 0; i < pool->nthreads; i++) {
+        pthread_join(pool->workers[i].thread, 0);
+    }
+    for (size_t i = 0; i < pool->nthreads; i++) {
+        pthread_mutex_destroy(&pool->deques[i].lock);
+        free(pool->deques[i].arr);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    free(pool->deques);
+    free(pool->workers);
+    free(pool);
+}
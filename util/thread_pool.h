@@ -0,0 +1,28 @@
+/** A reusable pool of worker threads with work stealing. Every worker owns a deque of tasks: it pushes and pops at
+ * the back of its own deque, and when that runs dry it steals from the front of another worker's. Tasks submitted
+ * from outside the pool are spread over the deques round-robin. */
+#ifndef _THREAD_POOL_H_INCLUDED_
+#define _THREAD_POOL_H_INCLUDED_
+
+#include <stddef.h>
+
+typedef struct tpool tpool;
+
+typedef void (*tpool_fn)(void* arg);
+
+/* Starts a pool of nthreads workers. With nthreads = 0, uses one worker per online processor. */
+tpool* tpool_create(size_t nthreads);
+
+size_t tpool_size(const tpool* const pool);
+
+/* Queues fn(arg). May be called from inside a task, in which case the task goes to the calling worker's deque. */
+void tpool_submit(tpool* pool, tpool_fn fn, void* arg);
+
+/* Returns once every task submitted so far, including tasks those tasks submitted, has finished. The calling
+ * thread runs queued tasks while it waits. Must not be called from inside a task of the same pool. */
+void tpool_wait(tpool* pool);
+
+/* Waits for outstanding tasks, stops the workers and frees the pool. */
+void tpool_free(tpool* pool);
+
+#endif